@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 
 #define BUFFER_LENGTH 8192
@@ -36,6 +37,11 @@ static constexpr int BUFFER_POOL_SIZE = 65536;                                //
 // static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr bool ENABLE_PAGE_COMPRESSION = false;                        // compress the pages of files created by the server
+static constexpr bool ENABLE_BLOOM_FILTER = false;                            // keep a Bloom filter for B+ tree indexes created by the server
+static constexpr bool ENABLE_CHANGE_BUFFER = false;                           // buffer executor changes to B+ tree indexes created by the server
+static constexpr size_t HASH_JOIN_MEMORY_BUDGET = (64 << 20);                 // memory for a hash join's build side before it spills to disk 64MB
+static constexpr size_t SORT_MEMORY_BUDGET = (64 << 20);                      // memory for a sort before it writes sorted runs to disk 64MB
 
 using frame_id_t = int32_t;  // frame id type, 帧页ID, 页在BufferPool中的存储单元称为帧,一帧对应一页
 using page_id_t = int32_t;   // page id type , 页ID
@@ -0,0 +1,265 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "common/common.h"
+#include "execution_defs.h"
+#include "system/sm_meta.h"
+
+constexpr int BATCH_SIZE = 1024;    // 向量化执行时每批记录的最大行数
+
+/**
+ * @description: 向量化执行中算子之间传递的一批记录，按列存放
+ * columns[i]依次存放各行第i个字段的值，每个值占cols[i].len字节；
+ * sel为选择向量，按顺序记录仍然有效的行号，过滤只修改sel而不移动数据
+ */
+class RecordBatch {
+   public:
+    std::vector<std::vector<char>> columns;
+    std::vector<int> col_lens;
+    std::vector<Rid> rids;          // 来自扫描时各行的记录号
+    std::vector<int> sel;
+    int num_rows = 0;               // 已写入的行数，包括被过滤掉的行
+    int capacity = BATCH_SIZE;
+
+    /* 按字段cols分配各列的空间并清空 */
+    void init(const std::vector<ColMeta> &cols, int capacity_ = BATCH_SIZE) {
+        capacity = capacity_;
+        columns.resize(cols.size());
+        col_lens.resize(cols.size());
+        for (size_t i = 0; i < cols.size(); i++) {
+            col_lens[i] = cols[i].len;
+            columns[i].resize(static_cast<size_t>(capacity) * cols[i].len);
+        }
+        rids.resize(capacity);
+        sel.reserve(capacity);
+        clear();
+    }
+
+    void clear() {
+        num_rows = 0;
+        sel.clear();
+    }
+
+    bool is_full() const { return num_rows == capacity; }
+
+    int num_selected() const { return static_cast<int>(sel.size()); }
+
+    char *value(int col_idx, int row) { return columns[col_idx].data() + static_cast<size_t>(row) * col_lens[col_idx]; }
+
+    const char *value(int col_idx, int row) const {
+        return columns[col_idx].data() + static_cast<size_t>(row) * col_lens[col_idx];
+    }
+
+    /* 把一条按cols中的偏移存放的记录拆分到各列，作为新的有效行 */
+    void append_row(const char *rec, const std::vector<ColMeta> &cols, const Rid &rid = Rid{-1, -1}) {
+        int row = num_rows++;
+        for (size_t i = 0; i < cols.size(); i++) {
+            memcpy(value(i, row), rec + cols[i].offset, cols[i].len);
+        }
+        rids[row] = rid;
+        sel.push_back(row);
+    }
+
+    /* 把第row行按cols中的偏移拼成一条记录写入dst */
+    void gather_row(int row, const std::vector<ColMeta> &cols, char *dst) const {
+        for (size_t i = 0; i < cols.size(); i++) {
+            memcpy(dst + cols[i].offset, value(i, row), cols[i].len);
+        }
+    }
+
+    /* 把有效行依次移到最前面并去掉其余的行，之后sel为0..n-1 */
+    void compact() {
+        int n = num_selected();
+        for (size_t i = 0; i < columns.size(); i++) {
+            int len = col_lens[i];
+            char *base = columns[i].data();
+            for (int k = 0; k < n; k++) {
+                if (sel[k] != k) {
+                    memcpy(base + static_cast<size_t>(k) * len, base + static_cast<size_t>(sel[k]) * len, len);
+                }
+            }
+        }
+        for (int k = 0; k < n; k++) {
+            rids[k] = rids[sel[k]];
+            sel[k] = k;
+        }
+        num_rows = n;
+    }
+
+    /* 把src的第row行的各列依次复制到本批第dst_col列开始的各列，不修改sel和num_rows */
+    void copy_columns(int dst_row, int dst_col, const RecordBatch &src, int row) {
+        for (size_t i = 0; i < src.columns.size(); i++) {
+            memcpy(value(dst_col + i, dst_row), src.value(i, row), src.col_lens[i]);
+        }
+    }
+};
+
+namespace batch_filter {
+
+template <typename T>
+inline T load(const char *p) {
+    T v;
+    memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+/**
+ * @brief 保留sel中满足pred(lhs, rhs)的行；rhs_col < 0 时右侧为常量rhs_val
+ */
+template <typename Pred>
+inline void select_rows(RecordBatch &batch, int lhs_col, int rhs_col, const char *rhs_val, Pred pred) {
+    int n = 0;
+    const char *lhs_base = batch.columns[lhs_col].data();
+    int lhs_len = batch.col_lens[lhs_col];
+    if (rhs_col < 0) {
+        for (int row : batch.sel) {
+            if (pred(lhs_base + static_cast<size_t>(row) * lhs_len, rhs_val)) {
+                batch.sel[n++] = row;
+            }
+        }
+    } else {
+        const char *rhs_base = batch.columns[rhs_col].data();
+        int rhs_len = batch.col_lens[rhs_col];
+        for (int row : batch.sel) {
+            if (pred(lhs_base + static_cast<size_t>(row) * lhs_len, rhs_base + static_cast<size_t>(row) * rhs_len)) {
+                batch.sel[n++] = row;
+            }
+        }
+    }
+    batch.sel.resize(n);
+}
+
+template <typename T>
+inline void select_typed(RecordBatch &batch, CompOp op, int lhs_col, int rhs_col, const char *rhs_val) {
+    switch (op) {
+        case OP_EQ:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [](const char *a, const char *b) { return load<T>(a) == load<T>(b); });
+            break;
+        case OP_NE:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [](const char *a, const char *b) { return load<T>(a) != load<T>(b); });
+            break;
+        case OP_LT:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [](const char *a, const char *b) { return load<T>(a) < load<T>(b); });
+            break;
+        case OP_GT:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [](const char *a, const char *b) { return load<T>(a) > load<T>(b); });
+            break;
+        case OP_LE:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [](const char *a, const char *b) { return load<T>(a) <= load<T>(b); });
+            break;
+        case OP_GE:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [](const char *a, const char *b) { return load<T>(a) >= load<T>(b); });
+            break;
+        default:
+            throw InternalError("Unexpected op type");
+    }
+}
+
+inline void select_string(RecordBatch &batch, CompOp op, int lhs_col, int rhs_col, const char *rhs_val, int len) {
+    switch (op) {
+        case OP_EQ:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [len](const char *a, const char *b) { return memcmp(a, b, len) == 0; });
+            break;
+        case OP_NE:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [len](const char *a, const char *b) { return memcmp(a, b, len) != 0; });
+            break;
+        case OP_LT:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [len](const char *a, const char *b) { return memcmp(a, b, len) < 0; });
+            break;
+        case OP_GT:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [len](const char *a, const char *b) { return memcmp(a, b, len) > 0; });
+            break;
+        case OP_LE:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [len](const char *a, const char *b) { return memcmp(a, b, len) <= 0; });
+            break;
+        case OP_GE:
+            select_rows(batch, lhs_col, rhs_col, rhs_val, [len](const char *a, const char *b) { return memcmp(a, b, len) >= 0; });
+            break;
+        default:
+            throw InternalError("Unexpected op type");
+    }
+}
+
+}  // namespace batch_filter
+
+/**
+ * @description: 批量求值的过滤条件，构造时把条件中的字段解析为batch中的列号
+ * 每个条件对整批的选择向量做一次紧凑的循环，比较方式与AbstractExecutor::eval_cond相同
+ */
+class BatchFilter {
+   public:
+    BatchFilter() = default;
+
+    BatchFilter(const std::vector<ColMeta> &cols, const std::vector<Condition> &conds) {
+        for (auto &cond : conds) {
+            Term term;
+            term.lhs_col = find_col(cols, cond.lhs_col);
+            term.rhs_col = cond.is_rhs_val ? -1 : find_col(cols, cond.rhs_col);
+            term.op = cond.op;
+            term.type = cols[term.lhs_col].type;
+            term.len = cols[term.lhs_col].len;
+            if (cond.is_rhs_val) {
+                term.rhs_val = cond.rhs_val.raw;
+            }
+            terms_.push_back(std::move(term));
+        }
+    }
+
+    bool empty() const { return terms_.empty(); }
+
+    /* 从batch的选择向量中去掉不满足所有条件的行 */
+    void apply(RecordBatch &batch) const {
+        for (auto &term : terms_) {
+            if (batch.sel.empty()) {
+                return;
+            }
+            const char *rhs_val = term.rhs_val == nullptr ? nullptr : term.rhs_val->data;
+            switch (term.type) {
+                case TYPE_INT:
+                    batch_filter::select_typed<int>(batch, term.op, term.lhs_col, term.rhs_col, rhs_val);
+                    break;
+                case TYPE_FLOAT:
+                    batch_filter::select_typed<float>(batch, term.op, term.lhs_col, term.rhs_col, rhs_val);
+                    break;
+                case TYPE_STRING:
+                    batch_filter::select_string(batch, term.op, term.lhs_col, term.rhs_col, rhs_val, term.len);
+                    break;
+                default:
+                    throw InternalError("Unexpected data type");
+            }
+        }
+    }
+
+   private:
+    struct Term {
+        int lhs_col;
+        int rhs_col;                        // 右侧为常量时为-1
+        CompOp op;
+        ColType type;
+        int len;
+        std::shared_ptr<RmRecord> rhs_val;
+    };
+
+    static int find_col(const std::vector<ColMeta> &cols, const TabCol &target) {
+        for (size_t i = 0; i < cols.size(); i++) {
+            if (cols[i].tab_name == target.tab_name && cols[i].name == target.col_name) {
+                return static_cast<int>(i);
+            }
+        }
+        throw ColumnNotFoundError(target.tab_name + '.' + target.col_name);
+    }
+
+    std::vector<Term> terms_;
+};
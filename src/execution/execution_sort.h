@@ -9,41 +9,177 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+#include <algorithm>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
+#include "execution_spill.h"
 #include "executor_abstract.h"
 #include "index/ix.h"
 #include "system/sm.h"
 
-class SortExecutor : public AbstractExecutor {
+/**
+ * @description: 排序，按批执行：读入子节点的批之后，对(批, 行)的引用按排序键做稳定排序，
+ * 再按排好的顺序把各行复制到输出的批中
+ * 给定sm_manager时为外部排序：读入的记录超过内存预算就排好序写到临时文件成为一个有序段，
+ * 最后用堆对各段做多路归并；排序键相同时段号小的先输出，因此结果仍是稳定的
+ */
+class SortExecutor : public BatchExecutor {
    private:
     std::unique_ptr<AbstractExecutor> prev_;
     ColMeta cols_;                              // 框架中只支持一个键排序，需要自行修改数据结构支持多个键排序
+    int key_idx_;                               // 排序键在prev_->cols()中的下标
     size_t tuple_num;
     bool is_desc_;
-    std::vector<size_t> used_tuple;
-    std::unique_ptr<RmRecord> current_tuple;
+
+    SmManager *sm_manager_;                     // 为nullptr时只在内存中排序
+    size_t memory_budget_;                      // 内存中缓存的记录的最大字节数
+
+    std::vector<RecordBatch> input_;            // 子节点的结果，每批只含有效行
+    std::vector<std::pair<int, int>> order_;    // 排好序的(批号, 行号)
+    size_t pos_ = 0;                            // 下一个要输出的元组在order_中的位置
+
+    std::vector<std::unique_ptr<SpillFile>> runs_;  // 已经写出的有序段
+    std::vector<RecordBatch> run_batches_;      // 各段当前读入的批
+    std::vector<int> run_pos_;                  // 各段的当前行在批中的位置
+    std::vector<int> heap_;                     // 还没有读完的各段，按当前行的排序键组成的堆
+    std::vector<char> row_buf_;
 
    public:
-    SortExecutor(std::unique_ptr<AbstractExecutor> prev, TabCol sel_cols, bool is_desc) {
+    SortExecutor(std::unique_ptr<AbstractExecutor> prev, TabCol sel_cols, bool is_desc, SmManager *sm_manager = nullptr,
+                 size_t memory_budget = SORT_MEMORY_BUDGET) {
         prev_ = std::move(prev);
         cols_ = prev_->get_col_offset(sel_cols);
+        key_idx_ = static_cast<int>(prev_->get_col(prev_->cols(), sel_cols) - prev_->cols().begin());
         is_desc_ = is_desc;
         tuple_num = 0;
-        used_tuple.clear();
+        sm_manager_ = sm_manager;
+        memory_budget_ = memory_budget;
+        row_buf_.resize(prev_->tupleLen());
+    }
+
+    void beginBatch() override {
+        input_.clear();
+        order_.clear();
+        pos_ = 0;
+        runs_.clear();
+        run_batches_.clear();
+        run_pos_.clear();
+        heap_.clear();
+        tuple_num = 0;
+
+        prev_->beginBatch();
+        RecordBatch batch;
+        size_t bytes = 0;
+        while (prev_->nextBatch(batch)) {
+            batch.compact();
+            for (int row = 0; row < batch.num_rows; row++) {
+                order_.emplace_back(static_cast<int>(input_.size()), row);
+            }
+            tuple_num += batch.num_rows;
+            bytes += batch.num_rows * (prev_->tupleLen() + sizeof(std::pair<int, int>));
+            input_.push_back(std::move(batch));
+            if (sm_manager_ != nullptr && bytes > memory_budget_) {
+                sort_input();
+                spill_run();
+                bytes = 0;
+            }
+        }
+        sort_input();
+        if (!runs_.empty()) {
+            if (!order_.empty()) {
+                spill_run();
+            }
+            start_merge();
+        }
+    }
+
+    bool nextBatch(RecordBatch &batch) override {
+        batch.init(prev_->cols());
+        if (!runs_.empty()) {
+            return merge_batch(batch);
+        }
+        for (; pos_ < order_.size() && !batch.is_full(); pos_++) {
+            const RecordBatch &src = input_[order_[pos_].first];
+            int row = batch.num_rows++;
+            batch.copy_columns(row, 0, src, order_[pos_].second);
+            batch.rids[row] = src.rids[order_[pos_].second];
+            batch.sel.push_back(row);
+        }
+        return batch.num_rows > 0;
     }
 
-    void beginTuple() override { 
-        
+    size_t tupleLen() const override { return prev_->tupleLen(); }
+
+    const std::vector<ColMeta> &cols() const override { return prev_->cols(); }
+
+    std::string getType() override { return "SortExecutor"; }
+
+    /* 最近一次执行时写出的有序段数，0表示只在内存中排序 */
+    size_t num_runs() const { return runs_.size(); }
+
+   private:
+    /* a应排在b之前时返回负数，之后时返回正数 */
+    int compare(const char *a, const char *b) const {
+        int cmp = ix_compare(a, b, cols_.type, cols_.len);
+        return is_desc_ ? -cmp : cmp;
     }
 
-    void nextTuple() override {
-        
+    void sort_input() {
+        std::stable_sort(order_.begin(), order_.end(), [this](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+            return compare(input_[a.first].value(key_idx_, a.second), input_[b.first].value(key_idx_, b.second)) < 0;
+        });
     }
 
-    std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+    /* 把内存中排好序的记录写成一个有序段 */
+    void spill_run() {
+        auto run = std::make_unique<SpillFile>(sm_manager_->get_disk_manager(), prev_->tupleLen());
+        for (auto &[batch_idx, row] : order_) {
+            input_[batch_idx].gather_row(row, prev_->cols(), row_buf_.data());
+            run->append(row_buf_.data());
+        }
+        run->finish();
+        runs_.push_back(std::move(run));
+        input_.clear();
+        order_.clear();
     }
 
-    Rid &rid() override { return _abstract_rid; }
-};
\ No newline at end of file
+    /* 堆顶为当前行最先输出的段；std::push_heap建立的是大根堆，因此比较函数在a应排在b之后时返回true */
+    bool run_after(int a, int b) const {
+        int cmp = compare(run_batches_[a].value(key_idx_, run_pos_[a]), run_batches_[b].value(key_idx_, run_pos_[b]));
+        return cmp > 0 || (cmp == 0 && a > b);
+    }
+
+    void start_merge() {
+        run_batches_.resize(runs_.size());
+        run_pos_.assign(runs_.size(), 0);
+        auto after = [this](int a, int b) { return run_after(a, b); };
+        for (size_t i = 0; i < runs_.size(); i++) {
+            runs_[i]->rewind();
+            if (runs_[i]->read_batch(run_batches_[i], prev_->cols())) {
+                heap_.push_back(static_cast<int>(i));
+                std::push_heap(heap_.begin(), heap_.end(), after);
+            }
+        }
+    }
+
+    bool merge_batch(RecordBatch &batch) {
+        auto after = [this](int a, int b) { return run_after(a, b); };
+        while (!heap_.empty() && !batch.is_full()) {
+            std::pop_heap(heap_.begin(), heap_.end(), after);
+            int run = heap_.back();
+            int row = batch.num_rows++;
+            batch.copy_columns(row, 0, run_batches_[run], run_pos_[run]);
+            batch.sel.push_back(row);
+            if (++run_pos_[run] == run_batches_[run].num_rows) {
+                run_pos_[run] = 0;
+                if (!runs_[run]->read_batch(run_batches_[run], prev_->cols())) {
+                    heap_.pop_back();
+                    continue;
+                }
+            }
+            std::push_heap(heap_.begin(), heap_.end(), after);
+        }
+        return batch.num_rows > 0;
+    }
+};
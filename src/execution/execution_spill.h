@@ -0,0 +1,122 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+#include <dirent.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "execution_batch.h"
+#include "storage/disk_manager.h"
+
+/**
+ * @description: 执行时溢出到磁盘的临时文件，依次存放定长的记录，用于哈希连接的分区和外部排序的有序段
+ * 通过DiskManager按页写入和读取，每页存放PAGE_SIZE / row_len条记录；对象析构时删除文件
+ */
+class SpillFile {
+   public:
+    SpillFile(DiskManager *disk_manager, int row_len) : disk_manager_(disk_manager), row_len_(row_len) {
+        rows_per_page_ = PAGE_SIZE / row_len_;
+        if (rows_per_page_ == 0) {
+            throw InternalError("SpillFile: record is larger than a page");
+        }
+        // 文件名带上进程号，同一目录下的多个进程不会互相覆盖临时文件
+        static std::atomic<int> next_id{0};
+        do {
+            path_ = SPILL_FILE_PREFIX + std::to_string(getpid()) + "_" + std::to_string(next_id++) + SPILL_FILE_SUFFIX;
+        } while (disk_manager_->is_file(path_));
+        disk_manager_->create_file(path_);
+        fd_ = disk_manager_->open_file(path_);
+        page_.resize(PAGE_SIZE);
+    }
+
+    ~SpillFile() {
+        disk_manager_->close_file(fd_);
+        disk_manager_->destroy_file(path_);
+    }
+
+    void append(const char *row) {
+        size_t pos = num_rows_ % rows_per_page_;
+        memcpy(page_.data() + pos * row_len_, row, row_len_);
+        if (++num_rows_ % rows_per_page_ == 0) {
+            flush();
+        }
+    }
+
+    /* 写出最后一页，之后只能读取 */
+    void finish() {
+        if (num_rows_ % rows_per_page_ != 0) {
+            flush();
+        }
+    }
+
+    /* 之后的read_batch从第start_row条记录开始读取 */
+    void rewind(size_t start_row = 0) { read_row_ = start_row; }
+
+    /* 按cols把之后的记录拆分到batch中，直到batch写满或读完文件；没有读到记录时返回false */
+    bool read_batch(RecordBatch &batch, const std::vector<ColMeta> &cols) {
+        batch.init(cols);
+        while (!batch.is_full() && read_row_ < num_rows_) {
+            page_id_t page_no = static_cast<page_id_t>(read_row_ / rows_per_page_);
+            if (page_no != loaded_page_no_) {
+                disk_manager_->read_page(fd_, page_no, page_.data(), PAGE_SIZE);
+                loaded_page_no_ = page_no;
+            }
+            batch.append_row(page_.data() + (read_row_ % rows_per_page_) * row_len_, cols);
+            read_row_++;
+        }
+        return batch.num_rows > 0;
+    }
+
+    size_t num_rows() const { return num_rows_; }
+
+    /* 删除当前目录下之前的进程异常退出时遗留的临时文件，启动时在开始执行查询之前调用 */
+    static void remove_leftover_files(DiskManager *disk_manager) {
+        DIR *dir = opendir(".");
+        if (dir == nullptr) {
+            return;
+        }
+        std::vector<std::string> leftovers;
+        std::string prefix = SPILL_FILE_PREFIX, suffix = SPILL_FILE_SUFFIX;
+        while (struct dirent *entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > prefix.size() + suffix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+                name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                leftovers.push_back(name);
+            }
+        }
+        closedir(dir);
+        for (auto &name : leftovers) {
+            disk_manager->destroy_file(name);  // 同时删除页面映射文件
+        }
+    }
+
+    static constexpr const char *SPILL_FILE_PREFIX = "spill_";
+    static constexpr const char *SPILL_FILE_SUFFIX = ".tmp";
+
+   private:
+    void flush() {
+        disk_manager_->write_page(fd_, num_pages_++, page_.data(), PAGE_SIZE);
+    }
+
+    DiskManager *disk_manager_;
+    std::string path_;
+    int fd_;
+    size_t row_len_;
+    size_t rows_per_page_;
+    std::vector<char> page_;                // 写入时为正在填充的最后一页，读取时为最近读入的页
+    size_t num_rows_ = 0;
+    page_id_t num_pages_ = 0;               // 已经写出的页数
+    size_t read_row_ = 0;                   // 下一条要读取的记录
+    page_id_t loaded_page_no_ = INVALID_PAGE_ID;
+};
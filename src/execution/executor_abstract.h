@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "execution_batch.h"
 #include "execution_defs.h"
 #include "common/common.h"
 #include "index/ix.h"
@@ -42,7 +43,22 @@ class AbstractExecutor {
 
     virtual std::unique_ptr<RmRecord> Next() = 0;
 
-    virtual ColMeta get_col_offset(const TabCol &target) { return ColMeta();};
+    /**
+     * @brief 向量化执行接口：beginBatch之后反复调用nextBatch，每次向batch中写入一批记录，返回false表示没有更多的记录
+     * 返回true时batch中至少有一行有效；默认实现逐条调用元组接口，原生支持批量执行的算子重写这两个函数
+     */
+    virtual void beginBatch() { beginTuple(); }
+
+    virtual bool nextBatch(RecordBatch &batch) {
+        batch.init(cols());
+        for (; !is_end() && !batch.is_full(); nextTuple()) {
+            auto rec = Next();
+            batch.append_row(rec->data, cols(), rid());
+        }
+        return batch.num_rows > 0;
+    }
+
+    virtual ColMeta get_col_offset(const TabCol &target) { return *get_col(cols(), target); };
 
     std::vector<ColMeta>::const_iterator get_col(const std::vector<ColMeta> &rec_cols, const TabCol &target) {
         auto pos = std::find_if(rec_cols.begin(), rec_cols.end(), [&](const ColMeta &col) {
@@ -53,4 +69,80 @@ class AbstractExecutor {
         }
         return pos;
     }
-};
\ No newline at end of file
+
+    /**
+     * @brief 判断记录rec是否满足条件cond，条件左侧为rec_cols中的字段，右侧为常量或rec_cols中的字段
+     */
+    bool eval_cond(const std::vector<ColMeta> &rec_cols, const Condition &cond, const RmRecord *rec) {
+        auto lhs_col = get_col(rec_cols, cond.lhs_col);
+        const char *lhs = rec->data + lhs_col->offset;
+        const char *rhs;
+        if (cond.is_rhs_val) {
+            rhs = cond.rhs_val.raw->data;
+        } else {
+            rhs = rec->data + get_col(rec_cols, cond.rhs_col)->offset;
+        }
+        int cmp = ix_compare(lhs, rhs, lhs_col->type, lhs_col->len);
+        switch (cond.op) {
+            case OP_EQ: return cmp == 0;
+            case OP_NE: return cmp != 0;
+            case OP_LT: return cmp < 0;
+            case OP_GT: return cmp > 0;
+            case OP_LE: return cmp <= 0;
+            case OP_GE: return cmp >= 0;
+            default:
+                throw InternalError("Unexpected op type");
+        }
+    }
+
+    bool eval_conds(const std::vector<ColMeta> &rec_cols, const std::vector<Condition> &conds, const RmRecord *rec) {
+        return std::all_of(conds.begin(), conds.end(),
+                           [&](const Condition &cond) { return eval_cond(rec_cols, cond, rec); });
+    }
+};
+
+/**
+ * @description: 原生按批执行的算子的基类，元组接口作为适配器实现：每次取出一批，再逐行拼成记录
+ * 子类实现beginBatch、nextBatch、cols和tupleLen
+ */
+class BatchExecutor : public AbstractExecutor {
+   public:
+    void beginTuple() override {
+        beginBatch();
+        tuple_end_ = false;
+        tuple_pos_ = 0;
+        tuple_batch_.clear();
+        fetch_tuple_batch();
+    }
+
+    void nextTuple() override {
+        assert(!is_end());
+        if (++tuple_pos_ == tuple_batch_.num_selected()) {
+            fetch_tuple_batch();
+        }
+    }
+
+    bool is_end() const override { return tuple_end_; }
+
+    std::unique_ptr<RmRecord> Next() override {
+        auto rec = std::make_unique<RmRecord>(tupleLen());
+        tuple_batch_.gather_row(tuple_batch_.sel[tuple_pos_], cols(), rec->data);
+        return rec;
+    }
+
+    Rid &rid() override {
+        tuple_rid_ = tuple_batch_.rids[tuple_batch_.sel[tuple_pos_]];
+        return tuple_rid_;
+    }
+
+   private:
+    void fetch_tuple_batch() {
+        tuple_pos_ = 0;
+        tuple_end_ = !nextBatch(tuple_batch_);
+    }
+
+    RecordBatch tuple_batch_;   // 元组接口当前所在的批
+    int tuple_pos_ = 0;         // 当前元组在tuple_batch_的选择向量中的位置
+    bool tuple_end_ = true;
+    Rid tuple_rid_;
+};
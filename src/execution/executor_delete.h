@@ -36,7 +36,30 @@ class DeleteExecutor : public AbstractExecutor {
         context_ = context;
     }
 
+    /**
+     * @brief 删除所有待删除的记录，以及它们在各个索引中的键值对
+     * B+树索引启用了change buffer时，索引上的删除只是暂存起来，之后批量合并到叶子结点中
+     * @note 先删除记录再维护索引：在线重建索引时，开始记录side log之前已完成的索引修改必须已经反映在表中
+     */
     std::unique_ptr<RmRecord> Next() override {
+        for (auto &rid : rids_) {
+            auto rec = fh_->get_record(rid, context_);
+            fh_->delete_record(rid, context_);
+            for (auto &index : tab_.indexes) {
+                auto index_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
+                std::vector<char> key(index.col_tot_len);
+                int offset = 0;
+                for (auto &col : index.cols) {
+                    memcpy(key.data() + offset, rec->data + col.offset, col.len);
+                    offset += col.len;
+                }
+                if (index.type == INDEX_HASH) {
+                    sm_manager_->hihs_.at(index_name)->delete_entry(key.data(), context_->txn_);
+                } else {
+                    sm_manager_->get_index_handle(index_name)->defer_delete(key.data(), context_->txn_);
+                }
+            }
+        }
         return nullptr;
     }
 
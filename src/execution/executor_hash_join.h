@@ -0,0 +1,527 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+#include <deque>
+
+#include "execution_defs.h"
+#include "execution_spill.h"
+#include "execution_manager.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * @description: 哈希连接使用的开放寻址哈希表，建立在build侧各行的连接键拼接成的定长key上
+ * 槽中只存放key的哈希值和第一行的编号，key相同的行通过next_串成链表；
+ * 所有key连续存放在keys_中，探测时线性地访问相邻的槽，先比较哈希值再比较key
+ */
+class JoinHashTable {
+   public:
+    static constexpr int NONE = -1;
+
+    /* keys中依次存放着编号为0, 1, ...的各行的key，每个key长度为key_len */
+    void build(std::vector<char> keys, int key_len) {
+        key_len_ = key_len;
+        keys_ = std::move(keys);
+        int num_rows = static_cast<int>(keys_.size() / key_len_);
+        size_t num_slots = 16;
+        while (num_slots < 2 * static_cast<size_t>(num_rows)) {
+            num_slots <<= 1;
+        }
+        mask_ = num_slots - 1;
+        slots_.assign(num_slots, Slot{0, NONE});
+        next_.assign(num_rows, NONE);
+        // 倒序插入到链表头部，使得同一个key的各行按编号顺序输出
+        for (int row = num_rows - 1; row >= 0; row--) {
+            const char *key = key_at(row);
+            uint64_t hash = hash_key(key, key_len_);
+            for (size_t pos = hash & mask_;; pos = (pos + 1) & mask_) {
+                Slot &slot = slots_[pos];
+                if (slot.head == NONE) {
+                    slot = Slot{hash, row};
+                    break;
+                }
+                if (slot.hash == hash && memcmp(key_at(slot.head), key, key_len_) == 0) {
+                    next_[row] = slot.head;
+                    slot.head = row;
+                    break;
+                }
+            }
+        }
+    }
+
+    /* 返回key相同的第一行的编号，没有时返回NONE */
+    int find(const char *key) const {
+        uint64_t hash = hash_key(key, key_len_);
+        for (size_t pos = hash & mask_;; pos = (pos + 1) & mask_) {
+            const Slot &slot = slots_[pos];
+            if (slot.head == NONE) {
+                return NONE;
+            }
+            if (slot.hash == hash && memcmp(key_at(slot.head), key, key_len_) == 0) {
+                return slot.head;
+            }
+        }
+    }
+
+    /* 返回与row的key相同的下一行的编号，没有时返回NONE */
+    int next(int row) const { return next_[row]; }
+
+    size_t size() const { return next_.size(); }
+
+    /* 每次处理8个字节的乘法哈希，低位用于定位槽，因此最后把高位混合到低位 */
+    static uint64_t hash_key(const char *key, int len) {
+        uint64_t hash = 0x9e3779b97f4a7c15ULL ^ static_cast<uint64_t>(len);
+        int i = 0;
+        for (; i + 8 <= len; i += 8) {
+            uint64_t word;
+            memcpy(&word, key + i, 8);
+            hash = (hash ^ word) * 0xff51afd7ed558ccdULL;
+            hash ^= hash >> 32;
+        }
+        if (i < len) {
+            uint64_t word = 0;
+            memcpy(&word, key + i, len - i);
+            hash = (hash ^ word) * 0xc4ceb9fe1a85ec53ULL;
+        }
+        return hash ^ (hash >> 29);
+    }
+
+   private:
+    struct Slot {
+        uint64_t hash;
+        int head;       // 该key的第一行的编号，NONE表示空槽
+    };
+
+    const char *key_at(int row) const { return keys_.data() + static_cast<size_t>(row) * key_len_; }
+
+    int key_len_ = 0;
+    std::vector<char> keys_;
+    std::vector<Slot> slots_;
+    std::vector<int> next_;
+    size_t mask_ = 0;
+};
+
+/**
+ * @description: 等值连接的哈希连接，按批执行：在较小的一侧上建立哈希表，用另一侧逐批探测
+ * 两个儿子的大小事先未知，因此交替地从两边读取，先读完的一侧即为较小的一侧；
+ * 连接条件中类型相同的列之间的等值条件作为哈希的key，其余条件对输出的批整批求值
+ * 输出的字段总是左儿子的字段在前、右儿子的字段在后，与NestedLoopJoinExecutor相同
+ *
+ * 两边都超过内存预算时改为grace hash join：按key的哈希值把两边分别分成FANOUT个分区写到临时文件，
+ * 再逐对连接分区；某个分区的build侧仍然超过预算时用哈希值中更低的几位再次分区，
+ * 到MAX_SPILL_LEVEL层仍然超过预算（大量重复的key）时，把build侧按预算分段，每段都扫描一遍probe侧
+ */
+class HashJoinExecutor : public BatchExecutor {
+   public:
+    static constexpr int FANOUT_BITS = 4;
+    static constexpr int FANOUT = 1 << FANOUT_BITS;    // 每次分区的分区数
+    static constexpr int MAX_SPILL_LEVEL = 4;           // 最多再分区的次数，每次使用哈希值中的FANOUT_BITS位
+
+   private:
+    /* 溢出到磁盘的一对分区，level为分区的层数，build侧中build_start之前的记录已经连接过 */
+    struct SpillTask {
+        std::unique_ptr<SpillFile> left;
+        std::unique_ptr<SpillFile> right;
+        int level = 0;
+        size_t build_start = 0;
+    };
+
+    std::unique_ptr<AbstractExecutor> left_;    // 左儿子节点（需要join的表）
+    std::unique_ptr<AbstractExecutor> right_;   // 右儿子节点（需要join的表）
+    size_t len_;                                // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;                 // join后获得的记录的字段
+
+    std::vector<Condition> fed_conds_;          // join条件
+    BatchFilter filter_;                        // 不作为key的其余join条件
+    std::vector<int> left_keys_;                // 各个key在左儿子cols()中的下标
+    std::vector<int> right_keys_;               // 各个key在右儿子cols()中的下标
+    int key_len_ = 0;                           // 各个key的总长度
+    bool isend;
+
+    SmManager *sm_manager_;
+    size_t memory_budget_;                      // build侧可以使用的内存，按字节计
+
+    bool build_left_ = false;                   // build侧是否为左儿子
+    std::vector<RecordBatch> build_batches_;    // build侧的全部结果，每批只含有效行
+    std::vector<std::pair<int, int>> build_rows_;   // 哈希表中各行的编号对应的(批号, 行号)
+    JoinHashTable table_;
+
+    std::deque<RecordBatch> pending_;           // 确定build侧之前已经从probe侧读出的批
+    bool probe_end_ = false;                    // probe侧的儿子是否已经读完
+    RecordBatch probe_batch_;                   // probe侧当前的批
+    int probe_pos_ = 0;                         // 当前probe行在probe_batch_的选择向量中的位置
+    int match_ = JoinHashTable::NONE;           // 当前probe行下一个要输出的build行的编号
+    std::vector<char> key_buf_;
+    std::vector<char> row_buf_;                 // 写入临时文件的记录
+
+    std::vector<SpillTask> tasks_;              // 还没有连接的分区
+    SpillTask cur_task_;                        // 正在连接的分区
+    SpillFile *probe_file_ = nullptr;           // 正在连接的分区的probe侧，没有溢出时为nullptr
+    int spill_level_ = -1;                      // 分区达到的最大层数，-1表示没有溢出
+
+   public:
+    HashJoinExecutor(SmManager *sm_manager, std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right,
+                     std::vector<Condition> conds, size_t memory_budget = HASH_JOIN_MEMORY_BUDGET) {
+        sm_manager_ = sm_manager;
+        memory_budget_ = memory_budget;
+        left_ = std::move(left);
+        right_ = std::move(right);
+        len_ = left_->tupleLen() + right_->tupleLen();
+        cols_ = left_->cols();
+        auto right_cols = right_->cols();
+        for (auto &col : right_cols) {
+            col.offset += left_->tupleLen();
+        }
+        cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+        isend = false;
+        fed_conds_ = std::move(conds);
+
+        std::vector<Condition> rest_conds;
+        for (auto &cond : fed_conds_) {
+            if (!add_key(cond)) {
+                rest_conds.push_back(cond);
+            }
+        }
+        if (left_keys_.empty()) {
+            throw InternalError("HashJoinExecutor: no equality condition between the two inputs");
+        }
+        filter_ = BatchFilter(cols_, rest_conds);
+        key_buf_.resize(key_len_);
+        row_buf_.resize(std::max(left_->tupleLen(), right_->tupleLen()));
+    }
+
+    void beginBatch() override {
+        left_->beginBatch();
+        right_->beginBatch();
+        build_batches_.clear();
+        build_rows_.clear();
+        pending_.clear();
+        probe_batch_.clear();
+        probe_pos_ = 0;
+        match_ = JoinHashTable::NONE;
+        probe_end_ = false;
+        tasks_.clear();
+        cur_task_ = SpillTask();
+        probe_file_ = nullptr;
+        spill_level_ = -1;
+
+        // 交替读取两边，先读完的一侧较小，另一侧已经读出的批留待探测；两边都超过预算时不再继续读取
+        std::vector<RecordBatch> left_batches;
+        std::vector<RecordBatch> right_batches;
+        size_t left_bytes = 0;
+        size_t right_bytes = 0;
+        bool left_done = false;
+        bool right_done = false;
+        RecordBatch batch;
+        while (left_bytes <= memory_budget_ || right_bytes <= memory_budget_) {
+            if (!left_->nextBatch(batch)) {
+                left_done = true;
+                break;
+            }
+            batch.compact();
+            left_bytes += batch.num_rows * row_cost(true);
+            left_batches.push_back(std::move(batch));
+            if (!right_->nextBatch(batch)) {
+                right_done = true;
+                break;
+            }
+            batch.compact();
+            right_bytes += batch.num_rows * row_cost(false);
+            right_batches.push_back(std::move(batch));
+        }
+        if ((left_done && left_bytes <= memory_budget_) || (right_done && right_bytes <= memory_budget_)) {
+            build_left_ = left_done;
+            build_batches_ = std::move(build_left_ ? left_batches : right_batches);
+            auto &probe_batches = build_left_ ? right_batches : left_batches;
+            pending_.assign(std::make_move_iterator(probe_batches.begin()), std::make_move_iterator(probe_batches.end()));
+            isend = build_batches_.empty();
+            build_table();
+            return;
+        }
+        spill(left_batches, left_done, right_batches, right_done);
+        isend = !start_next_task();
+    }
+
+    /**
+     * @brief 用probe侧的行依次查找哈希表，把每一对key相同的行拼接到batch中，
+     * batch写满时记住当前的probe行和build行，下次从这里继续；最后整批求值其余的join条件
+     */
+    bool nextBatch(RecordBatch &batch) override {
+        batch.init(cols_);
+        int num_left_cols = static_cast<int>(left_->cols().size());
+        while (!isend) {
+            batch.clear();
+            while (!batch.is_full()) {
+                if (match_ == JoinHashTable::NONE) {
+                    if (probe_pos_ == probe_batch_.num_selected()) {
+                        if (!next_probe_batch()) {
+                            // 溢出时继续连接下一对分区
+                            if (spill_level_ < 0 || !start_next_task()) {
+                                isend = true;
+                                break;
+                            }
+                            continue;
+                        }
+                        probe_pos_ = 0;
+                    }
+                    const std::vector<int> &probe_keys = build_left_ ? right_keys_ : left_keys_;
+                    make_key(probe_batch_, probe_batch_.sel[probe_pos_], probe_keys, key_buf_.data());
+                    match_ = table_.find(key_buf_.data());
+                    if (match_ == JoinHashTable::NONE) {
+                        probe_pos_++;
+                        continue;
+                    }
+                }
+                int row = batch.num_rows++;
+                int probe_row = probe_batch_.sel[probe_pos_];
+                const RecordBatch &build_batch = build_batches_[build_rows_[match_].first];
+                int build_row = build_rows_[match_].second;
+                if (build_left_) {
+                    batch.copy_columns(row, 0, build_batch, build_row);
+                    batch.copy_columns(row, num_left_cols, probe_batch_, probe_row);
+                } else {
+                    batch.copy_columns(row, 0, probe_batch_, probe_row);
+                    batch.copy_columns(row, num_left_cols, build_batch, build_row);
+                }
+                batch.sel.push_back(row);
+                match_ = table_.next(match_);
+                if (match_ == JoinHashTable::NONE) {
+                    probe_pos_++;
+                }
+            }
+            filter_.apply(batch);
+            if (batch.num_selected() > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "HashJoinExecutor"; }
+
+    /* 最近一次执行时分区达到的最大层数，-1表示没有溢出到磁盘 */
+    int spill_level() const { return spill_level_; }
+
+   private:
+    static int find_col(const std::vector<ColMeta> &cols, const TabCol &target) {
+        for (size_t i = 0; i < cols.size(); i++) {
+            if (cols[i].tab_name == target.tab_name && cols[i].name == target.col_name) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    /* cond是左右两边类型和长度相同的列之间的等值条件时，把它作为key，返回是否成功 */
+    bool add_key(const Condition &cond) {
+        if (cond.is_rhs_val || cond.op != OP_EQ) {
+            return false;
+        }
+        auto &left_cols = left_->cols();
+        auto &right_cols = right_->cols();
+        int left_idx = find_col(left_cols, cond.lhs_col);
+        int right_idx = find_col(right_cols, cond.rhs_col);
+        if (left_idx < 0 || right_idx < 0) {
+            left_idx = find_col(left_cols, cond.rhs_col);
+            right_idx = find_col(right_cols, cond.lhs_col);
+        }
+        if (left_idx < 0 || right_idx < 0 || left_cols[left_idx].type != right_cols[right_idx].type ||
+            left_cols[left_idx].len != right_cols[right_idx].len) {
+            return false;
+        }
+        left_keys_.push_back(left_idx);
+        right_keys_.push_back(right_idx);
+        key_len_ += left_cols[left_idx].len;
+        return true;
+    }
+
+    /* 把batch中第row行的各个key拼接到dst；浮点数的-0.0与0.0相等，统一写为0.0 */
+    void make_key(const RecordBatch &batch, int row, const std::vector<int> &keys, char *dst) const {
+        for (size_t i = 0; i < keys.size(); i++) {
+            int len = batch.col_lens[keys[i]];
+            memcpy(dst, batch.value(keys[i], row), len);
+            if (left_->cols()[left_keys_[i]].type == TYPE_FLOAT && batch_filter::load<float>(dst) == 0.0f) {
+                float zero = 0.0f;
+                memcpy(dst, &zero, sizeof(float));
+            }
+            dst += len;
+        }
+    }
+
+    /* build侧的一行在内存中占用的字节数：记录本身、key、编号和链表指针 */
+    size_t row_cost(bool is_left) const {
+        return (is_left ? left_->tupleLen() : right_->tupleLen()) + key_len_ + 3 * sizeof(int);
+    }
+
+    /* 在build_batches_上建立哈希表 */
+    void build_table() {
+        const std::vector<int> &build_keys = build_left_ ? left_keys_ : right_keys_;
+        std::vector<char> keys;
+        build_rows_.clear();
+        for (size_t i = 0; i < build_batches_.size(); i++) {
+            const RecordBatch &build_batch = build_batches_[i];
+            keys.resize(keys.size() + static_cast<size_t>(build_batch.num_rows) * key_len_);
+            char *dst = keys.data() + build_rows_.size() * key_len_;
+            for (int row = 0; row < build_batch.num_rows; row++, dst += key_len_) {
+                make_key(build_batch, row, build_keys, dst);
+                build_rows_.emplace_back(static_cast<int>(i), row);
+            }
+        }
+        table_.build(std::move(keys), key_len_);
+    }
+
+    /* 先取确定build侧之前读出的批，再从probe侧的儿子或者当前分区的临时文件继续读取 */
+    bool next_probe_batch() {
+        if (!pending_.empty()) {
+            probe_batch_ = std::move(pending_.front());
+            pending_.pop_front();
+            return true;
+        }
+        if (probe_file_ != nullptr) {
+            return probe_file_->read_batch(probe_batch_, build_left_ ? right_->cols() : left_->cols());
+        }
+        if (probe_end_) {
+            return false;
+        }
+        AbstractExecutor *probe = build_left_ ? right_.get() : left_.get();
+        probe_end_ = !probe->nextBatch(probe_batch_);
+        return !probe_end_;
+    }
+
+    std::vector<std::unique_ptr<SpillFile>> make_partitions(size_t row_len) {
+        std::vector<std::unique_ptr<SpillFile>> parts;
+        for (int i = 0; i < FANOUT; i++) {
+            parts.push_back(std::make_unique<SpillFile>(sm_manager_->get_disk_manager(), row_len));
+        }
+        return parts;
+    }
+
+    /* 第level层分区使用key的哈希值从高位开始的第level组FANOUT_BITS位，哈希表使用低位，二者互不相关 */
+    void partition_batch(const RecordBatch &batch, const std::vector<ColMeta> &cols, const std::vector<int> &keys, int level,
+                         std::vector<std::unique_ptr<SpillFile>> &parts) {
+        int shift = 64 - FANOUT_BITS * (level + 1);
+        for (int row : batch.sel) {
+            make_key(batch, row, keys, key_buf_.data());
+            uint64_t hash = JoinHashTable::hash_key(key_buf_.data(), key_len_);
+            batch.gather_row(row, cols, row_buf_.data());
+            parts[(hash >> shift) & (FANOUT - 1)]->append(row_buf_.data());
+        }
+    }
+
+    /* 把已经读出的批和两个儿子余下的结果按key分区写到临时文件，每对分区成为一个SpillTask */
+    void spill(std::vector<RecordBatch> &left_batches, bool left_done, std::vector<RecordBatch> &right_batches,
+               bool right_done) {
+        spill_level_ = 0;
+        auto left_parts = make_partitions(left_->tupleLen());
+        auto right_parts = make_partitions(right_->tupleLen());
+        auto spill_side = [&](AbstractExecutor *child, std::vector<RecordBatch> &batches, bool done,
+                              const std::vector<int> &keys, std::vector<std::unique_ptr<SpillFile>> &parts) {
+            for (auto &batch : batches) {
+                partition_batch(batch, child->cols(), keys, 0, parts);
+            }
+            batches.clear();
+            RecordBatch batch;
+            while (!done && child->nextBatch(batch)) {
+                partition_batch(batch, child->cols(), keys, 0, parts);
+            }
+            for (auto &part : parts) {
+                part->finish();
+            }
+        };
+        spill_side(left_.get(), left_batches, left_done, left_keys_, left_parts);
+        spill_side(right_.get(), right_batches, right_done, right_keys_, right_parts);
+        for (int i = 0; i < FANOUT; i++) {
+            tasks_.push_back(SpillTask{std::move(left_parts[i]), std::move(right_parts[i]), 0, 0});
+        }
+    }
+
+    /* 把cur_task_中的两个分区用下一层的哈希位再分区 */
+    void repartition() {
+        int level = cur_task_.level + 1;
+        spill_level_ = std::max(spill_level_, level);
+        auto left_parts = make_partitions(left_->tupleLen());
+        auto right_parts = make_partitions(right_->tupleLen());
+        auto split = [&](SpillFile &file, const std::vector<ColMeta> &cols, const std::vector<int> &keys,
+                         std::vector<std::unique_ptr<SpillFile>> &parts) {
+            RecordBatch batch;
+            file.rewind();
+            while (file.read_batch(batch, cols)) {
+                partition_batch(batch, cols, keys, level, parts);
+            }
+            for (auto &part : parts) {
+                part->finish();
+            }
+        };
+        split(*cur_task_.left, left_->cols(), left_keys_, left_parts);
+        split(*cur_task_.right, right_->cols(), right_keys_, right_parts);
+        for (int i = 0; i < FANOUT; i++) {
+            tasks_.push_back(SpillTask{std::move(left_parts[i]), std::move(right_parts[i]), level, 0});
+        }
+    }
+
+    /**
+     * @brief 准备连接下一对分区：在两边中较小的一侧上建立哈希表，另一侧的临时文件作为probe侧；
+     * build侧超过预算时再分区，已经到最深一层时只读入预算以内的一段，当前分区余下的部分之后再连接
+     * @return 是否还有要连接的分区
+     */
+    bool start_next_task() {
+        build_batches_.clear();
+        probe_file_ = nullptr;
+        probe_batch_.clear();
+        probe_pos_ = 0;
+        match_ = JoinHashTable::NONE;
+        while (true) {
+            SpillFile *build_file = nullptr;
+            if (cur_task_.left != nullptr) {
+                build_file = build_left_ ? cur_task_.left.get() : cur_task_.right.get();
+            }
+            if (build_file == nullptr || cur_task_.build_start == build_file->num_rows()) {
+                if (tasks_.empty()) {
+                    cur_task_ = SpillTask();
+                    return false;
+                }
+                cur_task_ = std::move(tasks_.back());
+                tasks_.pop_back();
+                size_t left_cost = cur_task_.left->num_rows() * row_cost(true);
+                size_t right_cost = cur_task_.right->num_rows() * row_cost(false);
+                if (left_cost == 0 || right_cost == 0) {
+                    cur_task_ = SpillTask();
+                    continue;
+                }
+                build_left_ = left_cost <= right_cost;
+                if (std::min(left_cost, right_cost) > memory_budget_ && cur_task_.level < MAX_SPILL_LEVEL) {
+                    repartition();
+                    cur_task_ = SpillTask();
+                    continue;
+                }
+                build_file = build_left_ ? cur_task_.left.get() : cur_task_.right.get();
+            }
+
+            size_t bytes = 0;
+            RecordBatch batch;
+            build_file->rewind(cur_task_.build_start);
+            while (bytes < memory_budget_ && build_file->read_batch(batch, build_left_ ? left_->cols() : right_->cols())) {
+                bytes += batch.num_rows * row_cost(build_left_);
+                cur_task_.build_start += batch.num_rows;
+                build_batches_.push_back(std::move(batch));
+            }
+            build_table();
+            probe_file_ = build_left_ ? cur_task_.right.get() : cur_task_.left.get();
+            probe_file_->rewind();
+            return true;
+        }
+    }
+};
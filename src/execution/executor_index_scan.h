@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <limits>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -25,18 +27,26 @@ class IndexScanExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;                 // 需要读取的字段
     size_t len_;                                // 选取出来的一条记录的长度
     std::vector<Condition> fed_conds_;          // 扫描条件，和conds_字段相同
+    BatchFilter filter_;                        // fed_conds_的批量求值形式
 
     std::vector<std::string> index_col_names_;  // index scan涉及到的索引包含的字段
     IndexMeta index_meta_;                      // index scan涉及到的索引元数据
+    bool index_only_;                           // 索引覆盖查询所需的字段时，直接由叶子结点中的key构造元组，不回表
+    std::unique_ptr<RmRecord> key_rec_;         // index-only时当前元组，即当前索引槽中的key
+    bool reverse_;                              // 按key降序扫描B+树索引，用于ORDER BY ... DESC
 
     Rid rid_;
-    std::unique_ptr<RecScan> scan_;
+    std::unique_ptr<IxScan> scan_;
+    std::vector<Rid> hash_rids_;                // 哈希索引等值查找的结果
+    std::vector<char> hash_key_;                // 哈希索引等值查找的key
+    size_t hash_pos_ = 0;
+    std::vector<char> key_buf_;                 // index-only按批读取时存放当前key
 
     SmManager *sm_manager_;
 
    public:
     IndexScanExecutor(SmManager *sm_manager, std::string tab_name, std::vector<Condition> conds, std::vector<std::string> index_col_names,
-                    Context *context) {
+                    Context *context, bool index_only = false, bool reverse = false) {
         sm_manager_ = sm_manager;
         context_ = context;
         tab_name_ = std::move(tab_name);
@@ -46,8 +56,21 @@ class IndexScanExecutor : public AbstractExecutor {
         index_col_names_ = index_col_names; 
         index_meta_ = *(tab_.get_index_meta(index_col_names_));
         fh_ = sm_manager_->fhs_.at(tab_name_).get();
-        cols_ = tab_.cols;
-        len_ = cols_.back().offset + cols_.back().len;
+        index_only_ = index_only;
+        reverse_ = reverse;
+        if (index_only_) {
+            // 输出的元组即key，各字段依次存放
+            int offset = 0;
+            for (auto col : index_meta_.cols) {
+                col.offset = offset;
+                offset += col.len;
+                cols_.push_back(col);
+            }
+            len_ = index_meta_.col_tot_len;
+        } else {
+            cols_ = tab_.cols;
+            len_ = cols_.back().offset + cols_.back().len;
+        }
         std::map<CompOp, CompOp> swap_op = {
             {OP_EQ, OP_EQ}, {OP_NE, OP_NE}, {OP_LT, OP_GT}, {OP_GT, OP_LT}, {OP_LE, OP_GE}, {OP_GE, OP_LE},
         };
@@ -62,19 +85,248 @@ class IndexScanExecutor : public AbstractExecutor {
             }
         }
         fed_conds_ = conds_;
+        filter_ = BatchFilter(cols_, fed_conds_);
     }
 
     void beginTuple() override {
-        
+        open_scan();
+        find_next_valid();
+    }
+
+    void beginBatch() override { open_scan(); }
+
+    /**
+     * @brief 从当前位置依次取出区间内的元组直到batch写满，再对整批求值扫描条件；
+     * index-only时直接复制叶子结点中的key，否则从数据页中复制记录，不为每条记录单独分配RmRecord
+     */
+    bool nextBatch(RecordBatch &batch) override {
+        batch.init(cols_);
+        key_buf_.resize(len_);
+        while (!is_end()) {
+            batch.clear();
+            for (; !is_end() && !batch.is_full(); advance()) {
+                bool is_hash = index_meta_.type == INDEX_HASH;
+                Rid rid = is_hash ? hash_rids_[hash_pos_] : scan_->rid();
+                if (index_only_) {
+                    if (is_hash) {
+                        batch.append_row(hash_key_.data(), cols_, rid);
+                    } else {
+                        scan_->key(key_buf_.data());
+                        batch.append_row(key_buf_.data(), cols_, rid);
+                    }
+                    continue;
+                }
+                RmPageHandle page_handle = fh_->fetch_page_handle(rid.page_no);
+                bool exists = Bitmap::is_set(page_handle.bitmap, rid.slot_no);
+                if (exists) {
+                    batch.append_row(page_handle.get_slot(rid.slot_no), cols_, rid);
+                }
+                sm_manager_->get_bpm()->unpin_page(page_handle.page->get_page_id(), false);
+                if (!exists) {
+                    throw RecordNotFoundError(rid.page_no, rid.slot_no);
+                }
+            }
+            filter_.apply(batch);
+            if (batch.num_selected() > 0) {
+                return true;
+            }
+        }
+        return false;
     }
 
+   private:
+    /**
+     * @brief 根据扫描条件确定索引上的扫描区间，并定位到区间的开头
+     * 等值条件匹配索引字段的最长前缀，其后的一个字段可以再匹配范围条件；
+     * 其余字段在下界中填最小值、在上界中填最大值，于是区间内恰好是满足这些条件的键值对
+     */
+    void open_scan() {
+        if (index_meta_.type == INDEX_HASH) {
+            begin_hash_lookup();
+            return;
+        }
+        auto ix_manager = sm_manager_->get_ix_manager();
+        IxIndexHandle *ih = sm_manager_->get_index_handle(ix_manager->get_index_name(tab_name_, index_col_names_));
+
+        std::vector<char> lower_key(index_meta_.col_tot_len);
+        std::vector<char> upper_key(index_meta_.col_tot_len);
+        bool lower_strict = false;  // 下界是否为 >
+        bool upper_strict = false;  // 上界是否为 <
+        int offset = 0;
+        size_t i = 0;
+        for (; i < index_meta_.cols.size(); ++i) {
+            const Condition *cond = find_eq_cond(index_meta_.cols[i]);
+            if (cond == nullptr) {
+                break;
+            }
+            memcpy(lower_key.data() + offset, cond->rhs_val.raw->data, index_meta_.cols[i].len);
+            memcpy(upper_key.data() + offset, cond->rhs_val.raw->data, index_meta_.cols[i].len);
+            offset += index_meta_.cols[i].len;
+        }
+        Transaction *txn = context_ == nullptr ? nullptr : context_->txn_;
+        if (i == index_meta_.cols.size()) {
+            // 所有字段都是等值条件：先合并该key上暂存的修改，Bloom过滤器表明key不存在时不必查找B+树
+            ih->merge_changes(lower_key.data(), lower_key.data(), txn);
+            if (!ih->may_contain(lower_key.data())) {
+                Iid end = ih->leaf_begin();
+                scan_ = std::make_unique<IxScan>(ih, end, end, sm_manager_->get_bpm(), reverse_);
+                return;
+            }
+        }
+        fill_bound(lower_key.data(), i, offset, false);
+        fill_bound(upper_key.data(), i, offset, true);
+        if (i < index_meta_.cols.size()) {
+            // 等值前缀之后的字段：取最紧的范围条件
+            const ColMeta &col = index_meta_.cols[i];
+            for (auto &cond : fed_conds_) {
+                if (!cond.is_rhs_val || cond.lhs_col.col_name != col.name) {
+                    continue;
+                }
+                const char *val = cond.rhs_val.raw->data;
+                if (cond.op == OP_GT || cond.op == OP_GE) {
+                    int cmp = ix_compare(val, lower_key.data() + offset, col.type, col.len);
+                    if (cmp > 0 || (cmp == 0 && cond.op == OP_GT)) {
+                        memcpy(lower_key.data() + offset, val, col.len);
+                        lower_strict = cond.op == OP_GT;
+                    }
+                } else if (cond.op == OP_LT || cond.op == OP_LE) {
+                    int cmp = ix_compare(val, upper_key.data() + offset, col.type, col.len);
+                    if (cmp < 0 || (cmp == 0 && cond.op == OP_LT)) {
+                        memcpy(upper_key.data() + offset, val, col.len);
+                        upper_strict = cond.op == OP_LT;
+                    }
+                }
+            }
+            // > v 跳过所有以v开头的key，因此之后的字段取最大值；< v 同理取最小值
+            fill_bound(lower_key.data(), i + 1, offset + col.len, lower_strict);
+            fill_bound(upper_key.data(), i + 1, offset + col.len, !upper_strict);
+        }
+
+        if (i < index_meta_.cols.size()) {
+            // 扫描之前合并区间内暂存的修改；所有字段都是等值条件时已经合并过
+            ih->merge_changes(lower_key.data(), upper_key.data(), txn);
+        }
+        Iid lower = lower_strict ? ih->upper_bound(lower_key.data()) : ih->lower_bound(lower_key.data());
+        Iid upper = upper_strict ? ih->lower_bound(upper_key.data()) : ih->upper_bound(upper_key.data());
+        std::vector<ColType> col_types;
+        std::vector<int> col_lens;
+        for (auto &col : index_meta_.cols) {
+            col_types.push_back(col.type);
+            col_lens.push_back(col.len);
+        }
+        int cmp = ix_compare(lower_key.data(), upper_key.data(), col_types, col_lens);
+        if (cmp > 0 || (cmp == 0 && (lower_strict || upper_strict))) {
+            // 区间为空，此时lower可能位于upper之后
+            lower = upper;
+        }
+        scan_ = std::make_unique<IxScan>(ih, lower, upper, sm_manager_->get_bpm(), reverse_);
+    }
+
+   public:
     void nextTuple() override {
-        
+        assert(!is_end());
+        advance();
+        find_next_valid();
     }
 
     std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+        if (index_only_) {
+            return std::make_unique<RmRecord>(*key_rec_);
+        }
+        return fh_->get_record(rid_, context_);
     }
 
+    bool is_end() const override {
+        return index_meta_.type == INDEX_HASH ? hash_pos_ == hash_rids_.size() : scan_->is_end();
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return index_only_ ? "IndexOnlyScanExecutor" : "IndexScanExecutor"; }
+
     Rid &rid() override { return rid_; }
+
+   private:
+    /* 返回col上的等值条件，没有时返回nullptr */
+    const Condition *find_eq_cond(const ColMeta &col) const {
+        for (auto &cond : fed_conds_) {
+            if (cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.col_name == col.name) {
+                return &cond;
+            }
+        }
+        return nullptr;
+    }
+
+    /* 将key中从第col_idx个字段（位于offset处）开始的各字段填为该类型的最大值（is_max）或最小值 */
+    void fill_bound(char *key, size_t col_idx, int offset, bool is_max) const {
+        for (; col_idx < index_meta_.cols.size(); ++col_idx) {
+            const ColMeta &col = index_meta_.cols[col_idx];
+            if (col.type == TYPE_INT) {
+                int val = is_max ? std::numeric_limits<int>::max() : std::numeric_limits<int>::min();
+                memcpy(key + offset, &val, sizeof(int));
+            } else if (col.type == TYPE_FLOAT) {
+                float val = is_max ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity();
+                memcpy(key + offset, &val, sizeof(float));
+            } else {
+                memset(key + offset, is_max ? 0xff : 0, col.len);
+            }
+            offset += col.len;
+        }
+    }
+
+    /**
+     * @brief 哈希索引只能用于所有字段都有等值条件的查询，查找结果至多一个rid
+     */
+    void begin_hash_lookup() {
+        auto ix_manager = sm_manager_->get_ix_manager();
+        IxHashIndexHandle *ih = sm_manager_->hihs_.at(ix_manager->get_index_name(tab_name_, index_col_names_)).get();
+        hash_key_.resize(index_meta_.col_tot_len);
+        int offset = 0;
+        for (auto &col : index_meta_.cols) {
+            const Condition *cond = find_eq_cond(col);
+            if (cond == nullptr) {
+                throw InternalError("IndexScanExecutor: hash index requires equality conditions on all columns");
+            }
+            memcpy(hash_key_.data() + offset, cond->rhs_val.raw->data, col.len);
+            offset += col.len;
+        }
+        hash_rids_.clear();
+        hash_pos_ = 0;
+        ih->get_value(hash_key_.data(), &hash_rids_, context_ == nullptr ? nullptr : context_->txn_);
+    }
+
+    void advance() {
+        if (index_meta_.type == INDEX_HASH) {
+            hash_pos_++;
+        } else {
+            scan_->next();
+        }
+    }
+
+    /* 从当前位置开始，跳过不满足扫描条件的元组 */
+    void find_next_valid() {
+        while (!is_end()) {
+            bool is_hash = index_meta_.type == INDEX_HASH;
+            rid_ = is_hash ? hash_rids_[hash_pos_] : scan_->rid();
+            if (index_only_) {
+                key_rec_ = std::make_unique<RmRecord>(len_);
+                if (is_hash) {
+                    memcpy(key_rec_->data, hash_key_.data(), len_);
+                } else {
+                    scan_->key(key_rec_->data);
+                }
+                if (eval_conds(cols_, fed_conds_, key_rec_.get())) {
+                    break;
+                }
+            } else {
+                auto rec = fh_->get_record(rid_, context_);
+                if (eval_conds(cols_, fed_conds_, rec.get())) {
+                    break;
+                }
+            }
+            advance();
+        }
+    }
 };
\ No newline at end of file
@@ -49,20 +49,39 @@ class InsertExecutor : public AbstractExecutor {
             val.init_raw(col.len);
             memcpy(rec.data + col.offset, val.raw->data, col.len);
         }
+        // 索引都是唯一索引，key已存在时在插入记录之前报错；检查不合并change buffer中暂存的修改
+        std::vector<std::vector<char>> keys;
+        for(size_t i = 0; i < tab_.indexes.size(); ++i) {
+            auto& index = tab_.indexes[i];
+            auto index_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
+            std::vector<char> key(index.col_tot_len);
+            int offset = 0;
+            for(size_t i = 0; i < index.col_num; ++i) {
+                memcpy(key.data() + offset, rec.data + index.cols[i].offset, index.cols[i].len);
+                offset += index.cols[i].len;
+            }
+            std::vector<Rid> result;
+            bool exists = index.type == INDEX_HASH
+                              ? sm_manager_->hihs_.at(index_name)->get_value(key.data(), &result, context_->txn_)
+                              : sm_manager_->get_index_handle(index_name)->probe_value(key.data(), &result, context_->txn_);
+            if (exists) {
+                throw IndexEntryExistsError();
+            }
+            keys.push_back(std::move(key));
+        }
+
         // Insert into record file
         rid_ = fh_->insert_record(rec.data, context_);
         
         // Insert into index
         for(size_t i = 0; i < tab_.indexes.size(); ++i) {
             auto& index = tab_.indexes[i];
-            auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            char* key = new char[index.col_tot_len];
-            int offset = 0;
-            for(size_t i = 0; i < index.col_num; ++i) {
-                memcpy(key + offset, rec.data + index.cols[i].offset, index.cols[i].len);
-                offset += index.cols[i].len;
+            auto index_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
+            if (index.type == INDEX_HASH) {
+                sm_manager_->hihs_.at(index_name)->insert_entry(keys[i].data(), rid_, context_->txn_);
+            } else {
+                sm_manager_->get_index_handle(index_name)->defer_insert(keys[i].data(), rid_, context_->txn_);
             }
-            ih->insert_entry(key, rid_, context_->txn_);
         }
         return nullptr;
     }
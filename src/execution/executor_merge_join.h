@@ -0,0 +1,229 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+#include "execution_defs.h"
+#include "execution_manager.h"
+#include "execution_sort.h"
+#include "executor_abstract.h"
+#include "index/ix.h"
+#include "system/sm.h"
+
+/**
+ * @description: 等值连接的排序归并连接，按批执行：两边都按连接键升序时各读一遍即可完成连接
+ * 第一个左右两边类型相同的列之间的等值条件作为归并的key，其余条件对输出的批整批求值；
+ * 右边key相同的一段记录缓存在内存中，与左边key相同的每一行依次拼接，因此两边都可以有重复的key
+ * 儿子的结果不按key有序时，先用SortExecutor（外部排序）排序
+ */
+class MergeJoinExecutor : public BatchExecutor {
+   private:
+    /* 一个儿子的结果上的游标，指向当前批中的一个有效行 */
+    struct Cursor {
+        AbstractExecutor *child;
+        RecordBatch batch;
+        int pos = 0;
+        bool end = true;
+
+        void begin() {
+            child->beginBatch();
+            pos = 0;
+            end = !child->nextBatch(batch);
+        }
+
+        int row() const { return batch.sel[pos]; }
+
+        void advance() {
+            if (++pos == batch.num_selected()) {
+                pos = 0;
+                end = !child->nextBatch(batch);
+            }
+        }
+    };
+
+    std::unique_ptr<AbstractExecutor> left_;    // 左儿子节点（需要join的表）
+    std::unique_ptr<AbstractExecutor> right_;   // 右儿子节点（需要join的表）
+    size_t len_;                                // join后获得的每条记录的长度
+    std::vector<ColMeta> cols_;                 // join后获得的记录的字段
+
+    std::vector<Condition> fed_conds_;          // join条件
+    BatchFilter filter_;                        // 不作为key的其余join条件
+    int left_key_ = -1;                         // key在左儿子cols()中的下标
+    int right_key_ = -1;                        // key在右儿子cols()中的下标
+    ColMeta key_col_;                           // key的类型和长度
+    bool isend;
+
+    Cursor left_cursor_;
+    Cursor right_cursor_;
+    std::vector<RecordBatch> run_;              // 右边key相同的一段记录，除最后一批外每批都是满的
+    int run_size_ = 0;
+    std::vector<char> run_key_;                 // run_中记录的key
+    int run_pos_ = 0;                           // 当前左边行下一个要拼接的run_中的记录
+    bool in_run_ = false;                       // 当前左边行的key是否等于run_key_
+
+   public:
+    MergeJoinExecutor(SmManager *sm_manager, std::unique_ptr<AbstractExecutor> left,
+                      std::unique_ptr<AbstractExecutor> right, std::vector<Condition> conds, bool left_sorted = true,
+                      bool right_sorted = true) {
+        left_ = std::move(left);
+        right_ = std::move(right);
+        len_ = left_->tupleLen() + right_->tupleLen();
+        cols_ = left_->cols();
+        auto right_cols = right_->cols();
+        for (auto &col : right_cols) {
+            col.offset += left_->tupleLen();
+        }
+        cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
+        isend = false;
+        fed_conds_ = std::move(conds);
+
+        std::vector<Condition> rest_conds;
+        for (auto &cond : fed_conds_) {
+            if (left_key_ >= 0 || !set_key(cond)) {
+                rest_conds.push_back(cond);
+            }
+        }
+        if (left_key_ < 0) {
+            throw InternalError("MergeJoinExecutor: no equality condition between the two inputs");
+        }
+        filter_ = BatchFilter(cols_, rest_conds);
+        key_col_ = left_->cols()[left_key_];
+        run_key_.resize(key_col_.len);
+
+        if (!left_sorted) {
+            TabCol key = {left_->cols()[left_key_].tab_name, left_->cols()[left_key_].name};
+            left_ = std::make_unique<SortExecutor>(std::move(left_), key, false, sm_manager);
+        }
+        if (!right_sorted) {
+            TabCol key = {right_->cols()[right_key_].tab_name, right_->cols()[right_key_].name};
+            right_ = std::make_unique<SortExecutor>(std::move(right_), key, false, sm_manager);
+        }
+        left_cursor_.child = left_.get();
+        right_cursor_.child = right_.get();
+    }
+
+    void beginBatch() override {
+        left_cursor_.begin();
+        right_cursor_.begin();
+        run_.clear();
+        run_size_ = 0;
+        run_pos_ = 0;
+        in_run_ = false;
+        isend = false;
+    }
+
+    /**
+     * @brief 比较两边当前行的key，较小的一侧前进；相等时读入右边key相同的一段记录，
+     * 再把左边key相同的每一行与这段记录逐一拼接，batch写满时记住拼接到的位置，下次从这里继续
+     */
+    bool nextBatch(RecordBatch &batch) override {
+        batch.init(cols_);
+        int num_left_cols = static_cast<int>(left_->cols().size());
+        while (!isend) {
+            batch.clear();
+            while (!batch.is_full()) {
+                if (in_run_) {
+                    int row = batch.num_rows++;
+                    batch.copy_columns(row, 0, left_cursor_.batch, left_cursor_.row());
+                    batch.copy_columns(row, num_left_cols, run_[run_pos_ / BATCH_SIZE], run_pos_ % BATCH_SIZE);
+                    batch.sel.push_back(row);
+                    if (++run_pos_ == run_size_) {
+                        run_pos_ = 0;
+                        left_cursor_.advance();
+                        in_run_ = !left_cursor_.end && compare(left_key(), run_key_.data()) == 0;
+                    }
+                    continue;
+                }
+                if (left_cursor_.end || right_cursor_.end) {
+                    isend = true;
+                    break;
+                }
+                int cmp = compare(left_key(), right_key());
+                if (cmp < 0) {
+                    left_cursor_.advance();
+                } else if (cmp > 0) {
+                    right_cursor_.advance();
+                } else {
+                    read_run();
+                    in_run_ = true;
+                }
+            }
+            filter_.apply(batch);
+            if (batch.num_selected() > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "MergeJoinExecutor"; }
+
+   private:
+    static int find_col(const std::vector<ColMeta> &cols, const TabCol &target) {
+        for (size_t i = 0; i < cols.size(); i++) {
+            if (cols[i].tab_name == target.tab_name && cols[i].name == target.col_name) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    /* cond是左右两边类型和长度相同的列之间的等值条件时，把它作为key，返回是否成功 */
+    bool set_key(const Condition &cond) {
+        if (cond.is_rhs_val || cond.op != OP_EQ) {
+            return false;
+        }
+        auto &left_cols = left_->cols();
+        auto &right_cols = right_->cols();
+        int left_idx = find_col(left_cols, cond.lhs_col);
+        int right_idx = find_col(right_cols, cond.rhs_col);
+        if (left_idx < 0 || right_idx < 0) {
+            left_idx = find_col(left_cols, cond.rhs_col);
+            right_idx = find_col(right_cols, cond.lhs_col);
+        }
+        if (left_idx < 0 || right_idx < 0 || left_cols[left_idx].type != right_cols[right_idx].type ||
+            left_cols[left_idx].len != right_cols[right_idx].len) {
+            return false;
+        }
+        left_key_ = left_idx;
+        right_key_ = right_idx;
+        return true;
+    }
+
+    int compare(const char *a, const char *b) const { return ix_compare(a, b, key_col_.type, key_col_.len); }
+
+    const char *left_key() const { return left_cursor_.batch.value(left_key_, left_cursor_.row()); }
+
+    const char *right_key() const { return right_cursor_.batch.value(right_key_, right_cursor_.row()); }
+
+    /* 把右边从当前行开始key相同的记录复制到run_，之后右边的游标指向下一个key */
+    void read_run() {
+        memcpy(run_key_.data(), right_key(), key_col_.len);
+        run_size_ = 0;
+        run_pos_ = 0;
+        size_t num_batches = 0;
+        do {
+            if (run_size_ % BATCH_SIZE == 0) {
+                if (num_batches == run_.size()) {
+                    run_.emplace_back();
+                }
+                run_[num_batches++].init(right_->cols());
+            }
+            RecordBatch &dst = run_[num_batches - 1];
+            int row = dst.num_rows++;
+            dst.copy_columns(row, 0, right_cursor_.batch, right_cursor_.row());
+            run_size_++;
+            right_cursor_.advance();
+        } while (!right_cursor_.end && compare(right_key(), run_key_.data()) == 0);
+    }
+};
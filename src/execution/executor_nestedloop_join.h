@@ -15,7 +15,11 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "system/sm.h"
 
-class NestedLoopJoinExecutor : public AbstractExecutor {
+/**
+ * @description: 块嵌套循环连接，按批执行：右儿子的结果只读取一次并缓存为若干批，
+ * 左边每一行与右边的一整批拼接后，对拼接结果整批求值连接条件
+ */
+class NestedLoopJoinExecutor : public BatchExecutor {
    private:
     std::unique_ptr<AbstractExecutor> left_;    // 左儿子节点（需要join的表）
     std::unique_ptr<AbstractExecutor> right_;   // 右儿子节点（需要join的表）
@@ -23,8 +27,14 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;                 // join后获得的记录的字段
 
     std::vector<Condition> fed_conds_;          // join条件
+    BatchFilter filter_;                        // fed_conds_的批量求值形式
     bool isend;
 
+    std::vector<RecordBatch> right_batches_;    // 右儿子的全部结果，每批只含有效行
+    RecordBatch left_batch_;                    // 左儿子当前的批
+    int left_pos_ = 0;                          // 当前左边行在left_batch_的选择向量中的位置
+    size_t right_idx_ = 0;                      // 当前左边行下一个要拼接的右边的批
+
    public:
     NestedLoopJoinExecutor(std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right, 
                             std::vector<Condition> conds) {
@@ -40,20 +50,65 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
         cols_.insert(cols_.end(), right_cols.begin(), right_cols.end());
         isend = false;
         fed_conds_ = std::move(conds);
-
+        filter_ = BatchFilter(cols_, fed_conds_);
     }
 
-    void beginTuple() override {
-
+    void beginBatch() override {
+        right_batches_.clear();
+        right_->beginBatch();
+        RecordBatch batch;
+        while (right_->nextBatch(batch)) {
+            batch.compact();
+            right_batches_.push_back(std::move(batch));
+        }
+        left_->beginBatch();
+        left_batch_.clear();
+        left_pos_ = 0;
+        right_idx_ = 0;
+        isend = right_batches_.empty();
     }
 
-    void nextTuple() override {
-        
+    bool nextBatch(RecordBatch &batch) override {
+        batch.init(cols_);
+        int num_left_cols = static_cast<int>(left_->cols().size());
+        while (!isend) {
+            batch.clear();
+            while (!batch.is_full()) {
+                if (left_pos_ == left_batch_.num_selected()) {
+                    if (!left_->nextBatch(left_batch_)) {
+                        isend = true;
+                        break;
+                    }
+                    left_pos_ = 0;
+                    right_idx_ = 0;
+                }
+                const RecordBatch &right_batch = right_batches_[right_idx_];
+                if (batch.num_rows + right_batch.num_rows > batch.capacity) {
+                    break;
+                }
+                int left_row = left_batch_.sel[left_pos_];
+                for (int r = 0; r < right_batch.num_rows; r++) {
+                    int row = batch.num_rows++;
+                    batch.copy_columns(row, 0, left_batch_, left_row);
+                    batch.copy_columns(row, num_left_cols, right_batch, r);
+                    batch.sel.push_back(row);
+                }
+                if (++right_idx_ == right_batches_.size()) {
+                    right_idx_ = 0;
+                    left_pos_++;
+                }
+            }
+            filter_.apply(batch);
+            if (batch.num_selected() > 0) {
+                return true;
+            }
+        }
+        return false;
     }
 
-    std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
-    }
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
 
-    Rid &rid() override { return _abstract_rid; }
-};
\ No newline at end of file
+    std::string getType() override { return "NestedLoopJoinExecutor"; }
+};
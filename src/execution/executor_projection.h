@@ -15,12 +15,16 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "system/sm.h"
 
-class ProjectionExecutor : public AbstractExecutor {
+/**
+ * @description: 投影，按批执行：输出批的各列直接取自输入批的相应列，选择向量和记录号原样保留
+ */
+class ProjectionExecutor : public BatchExecutor {
    private:
     std::unique_ptr<AbstractExecutor> prev_;        // 投影节点的儿子节点
     std::vector<ColMeta> cols_;                     // 需要投影的字段
     size_t len_;                                    // 字段总长度
     std::vector<size_t> sel_idxs_;                  
+    RecordBatch input_;                             // 儿子节点产生的批
 
    public:
     ProjectionExecutor(std::unique_ptr<AbstractExecutor> prev, const std::vector<TabCol> &sel_cols) {
@@ -39,13 +43,26 @@ class ProjectionExecutor : public AbstractExecutor {
         len_ = curr_offset;
     }
 
-    void beginTuple() override {}
+    void beginBatch() override { prev_->beginBatch(); }
 
-    void nextTuple() override {}
-
-    std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
+    bool nextBatch(RecordBatch &batch) override {
+        if (!prev_->nextBatch(input_)) {
+            return false;
+        }
+        batch.init(cols_, input_.capacity);
+        for (size_t i = 0; i < sel_idxs_.size(); i++) {
+            size_t bytes = static_cast<size_t>(input_.num_rows) * cols_[i].len;
+            memcpy(batch.columns[i].data(), input_.columns[sel_idxs_[i]].data(), bytes);
+        }
+        std::copy(input_.rids.begin(), input_.rids.begin() + input_.num_rows, batch.rids.begin());
+        batch.sel = input_.sel;
+        batch.num_rows = input_.num_rows;
+        return true;
     }
 
-    Rid &rid() override { return _abstract_rid; }
-};
\ No newline at end of file
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
+
+    std::string getType() override { return "ProjectionExecutor"; }
+};
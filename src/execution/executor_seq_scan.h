@@ -16,7 +16,10 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "system/sm.h"
 
-class SeqScanExecutor : public AbstractExecutor {
+/**
+ * @description: 顺序扫描，按批执行：逐页读取记录，拆分到各列之后对整批求值扫描条件
+ */
+class SeqScanExecutor : public BatchExecutor {
    private:
     std::string tab_name_;              // 表的名称
     std::vector<Condition> conds_;      // scan的条件
@@ -24,9 +27,9 @@ class SeqScanExecutor : public AbstractExecutor {
     std::vector<ColMeta> cols_;         // scan后生成的记录的字段
     size_t len_;                        // scan后生成的每条记录的长度
     std::vector<Condition> fed_conds_;  // 同conds_，两个字段相同
+    BatchFilter filter_;                // fed_conds_的批量求值形式
 
-    Rid rid_;
-    std::unique_ptr<RecScan> scan_;     // table_iterator
+    Rid rid_;                           // 下一批从rid_之后的slot开始读取
 
     SmManager *sm_manager_;
 
@@ -43,32 +46,48 @@ class SeqScanExecutor : public AbstractExecutor {
         context_ = context;
 
         fed_conds_ = conds_;
+        filter_ = BatchFilter(cols_, fed_conds_);
     }
 
-    /**
-     * @brief 构建表迭代器scan_,并开始迭代扫描,直到扫描到第一个满足谓词条件的元组停止,并赋值给rid_
-     *
-     */
-    void beginTuple() override {
-        
-    }
+    void beginBatch() override { rid_ = {.page_no = RM_FIRST_RECORD_PAGE, .slot_no = -1}; }
 
     /**
-     * @brief 从当前scan_指向的记录开始迭代扫描,直到扫描到第一个满足谓词条件的元组停止,并赋值给rid_
-     *
+     * @brief 从rid_之后继续逐页读取记录，直到batch写满或读完整个文件，再用扫描条件过滤；
+     * 整批都不满足条件时继续读下一批，使得返回的batch中总有有效行
      */
-    void nextTuple() override {
-        
+    bool nextBatch(RecordBatch &batch) override {
+        batch.init(cols_);
+        RmFileHdr file_hdr = fh_->get_file_hdr();
+        while (rid_.page_no < file_hdr.num_pages) {
+            batch.clear();
+            while (rid_.page_no < file_hdr.num_pages && !batch.is_full()) {
+                RmPageHandle page_handle = fh_->fetch_page_handle(rid_.page_no);
+                int slot_no = rid_.slot_no;
+                while (!batch.is_full()) {
+                    slot_no = Bitmap::next_bit(true, page_handle.bitmap, file_hdr.num_records_per_page, slot_no);
+                    if (slot_no == file_hdr.num_records_per_page) {
+                        break;
+                    }
+                    batch.append_row(page_handle.get_slot(slot_no), cols_, Rid{rid_.page_no, slot_no});
+                }
+                sm_manager_->get_bpm()->unpin_page(page_handle.page->get_page_id(), false);
+                if (slot_no == file_hdr.num_records_per_page) {
+                    rid_ = {.page_no = rid_.page_no + 1, .slot_no = -1};
+                } else {
+                    rid_.slot_no = slot_no;
+                }
+            }
+            filter_.apply(batch);
+            if (batch.num_selected() > 0) {
+                return true;
+            }
+        }
+        return false;
     }
 
-    /**
-     * @brief 返回下一个满足扫描条件的记录
-     *
-     * @return std::unique_ptr<RmRecord>
-     */
-    std::unique_ptr<RmRecord> Next() override {
-        return nullptr;
-    }
+    size_t tupleLen() const override { return len_; }
+
+    const std::vector<ColMeta> &cols() const override { return cols_; }
 
-    Rid &rid() override { return rid_; }
-};
\ No newline at end of file
+    std::string getType() override { return "SeqScanExecutor"; }
+};
@@ -9,6 +9,8 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #pragma once
+#include <set>
+
 #include "execution_defs.h"
 #include "execution_manager.h"
 #include "executor_abstract.h"
@@ -17,12 +19,14 @@ See the Mulan PSL v2 for more details. */
 
 class UpdateExecutor : public AbstractExecutor {
    private:
-    TabMeta tab_;
-    std::vector<Condition> conds_;
-    RmFileHandle *fh_;
-    std::vector<Rid> rids_;
-    std::string tab_name_;
-    std::vector<SetClause> set_clauses_;
+    TabMeta tab_;                           // 表的元数据
+    std::vector<Condition> conds_;          // update的条件
+    RmFileHandle *fh_;                      // 表的数据文件句柄
+    std::vector<Rid> rids_;                 // 需要更新的记录的位置
+    std::string tab_name_;                  // 表名称
+    std::vector<SetClause> set_clauses_;    // 需要更新的字段和新值
+    std::vector<ColMeta> set_cols_;         // set_clauses_[i]对应的字段
+    std::vector<bool> index_affected_;      // tab_.indexes[i]是否包含被更新的字段
     SmManager *sm_manager_;
 
    public:
@@ -36,11 +40,123 @@ class UpdateExecutor : public AbstractExecutor {
         conds_ = conds;
         rids_ = rids;
         context_ = context;
+
+        for (auto &set_clause : set_clauses_) {
+            auto &col = *tab_.get_col(set_clause.lhs.col_name);
+            auto &val = set_clause.rhs;
+            if (col.type != val.type) {
+                throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
+            }
+            if (val.raw == nullptr) {
+                val.init_raw(col.len);
+            }
+            set_cols_.push_back(col);
+        }
+        // 不包含任何被更新字段的索引，其key一定不变，不需要维护
+        for (auto &index : tab_.indexes) {
+            bool affected = false;
+            for (auto &col : index.cols) {
+                for (auto &set_col : set_cols_) {
+                    affected = affected || set_col.name == col.name;
+                }
+            }
+            index_affected_.push_back(affected);
+        }
     }
+
+    /**
+     * @brief 更新所有待更新的记录
+     * 记录是定长的，新版本总能写回原来的slot，rid不变，因此key不变的索引都不需要修改；
+     * 只有key的字节确实发生变化的索引才删除旧的键值对并插入新的键值对
+     * @note 索引都是唯一索引，先检查所有记录的新key不会与其他记录重复，再开始修改记录；
+     * 先更新记录再维护索引，原因同DeleteExecutor::Next
+     */
     std::unique_ptr<RmRecord> Next() override {
-        
+        std::vector<std::unique_ptr<RmRecord>> old_recs;
+        std::vector<RmRecord> new_recs;
+        for (auto &rid : rids_) {
+            old_recs.push_back(fh_->get_record(rid, context_));
+            new_recs.emplace_back(*old_recs.back());
+            for (size_t i = 0; i < set_clauses_.size(); i++) {
+                memcpy(new_recs.back().data + set_cols_[i].offset, set_clauses_[i].rhs.raw->data, set_cols_[i].len);
+            }
+        }
+        check_unique(old_recs, new_recs);
+
+        for (size_t r = 0; r < rids_.size(); r++) {
+            auto &rid = rids_[r];
+            fh_->update_record(rid, new_recs[r].data, context_);
+            for (size_t i = 0; i < tab_.indexes.size(); i++) {
+                if (!index_affected_[i]) {
+                    continue;
+                }
+                auto &index = tab_.indexes[i];
+                std::string old_key = make_key(index, old_recs[r]->data);
+                std::string new_key = make_key(index, new_recs[r].data);
+                if (old_key == new_key) {
+                    continue;
+                }
+                auto index_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
+                if (index.type == INDEX_HASH) {
+                    auto ih = sm_manager_->hihs_.at(index_name).get();
+                    ih->delete_entry(old_key.data(), context_->txn_);
+                    ih->insert_entry(new_key.data(), rid, context_->txn_);
+                } else {
+                    auto ih = sm_manager_->get_index_handle(index_name);
+                    ih->defer_delete(old_key.data(), context_->txn_);
+                    ih->defer_insert(new_key.data(), rid, context_->txn_);
+                }
+            }
+        }
         return nullptr;
     }
 
     Rid &rid() override { return _abstract_rid; }
+
+   private:
+    static std::string make_key(const IndexMeta &index, const char *data) {
+        std::string key;
+        for (auto &col : index.cols) {
+            key.append(data + col.offset, col.len);
+        }
+        return key;
+    }
+
+    /**
+     * @brief 检查更新之后每个被影响的索引中没有重复的key，否则抛出IndexEntryExistsError
+     * 被更新的记录的新key之间不能相同；key发生变化的记录，其新key已在索引中时，
+     * 只有占用它的也是一条被更新的记录（它的key会变成别的值）才不冲突；检查不合并change buffer中暂存的修改
+     */
+    void check_unique(const std::vector<std::unique_ptr<RmRecord>> &old_recs, const std::vector<RmRecord> &new_recs) {
+        std::set<std::pair<int, int>> updated;
+        for (auto &rid : rids_) {
+            updated.emplace(rid.page_no, rid.slot_no);
+        }
+        for (size_t i = 0; i < tab_.indexes.size(); i++) {
+            if (!index_affected_[i]) {
+                continue;
+            }
+            auto &index = tab_.indexes[i];
+            auto index_name = sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols);
+            std::set<std::string> new_keys;
+            for (size_t r = 0; r < rids_.size(); r++) {
+                std::string new_key = make_key(index, new_recs[r].data);
+                if (!new_keys.insert(new_key).second) {
+                    throw IndexEntryExistsError();
+                }
+                if (new_key == make_key(index, old_recs[r]->data)) {
+                    continue;
+                }
+                std::vector<Rid> result;
+                if (index.type == INDEX_HASH) {
+                    sm_manager_->hihs_.at(index_name)->get_value(new_key.data(), &result, context_->txn_);
+                } else {
+                    sm_manager_->get_index_handle(index_name)->probe_value(new_key.data(), &result, context_->txn_);
+                }
+                if (!result.empty() && updated.count({result[0].page_no, result[0].slot_no}) == 0) {
+                    throw IndexEntryExistsError();
+                }
+            }
+        }
+    }
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_adaptive_hash.h"
+
+#include <mutex>
+
+bool IxAdaptiveHash::lookup(const char *key, int len, Entry *entry) const {
+    if (size() == 0) {
+        return false;
+    }
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    auto it = entries_.find(std::string(key, len));
+    if (it == entries_.end()) {
+        return false;
+    }
+    *entry = it->second;
+    return true;
+}
+
+bool IxAdaptiveHash::record_access(page_id_t page_no) {
+    auto &counter = hits_[static_cast<uint32_t>(page_no) % NUM_COUNTERS];
+    if (counter.fetch_add(1, std::memory_order_relaxed) + 1 < IX_AHI_HOT_THRESHOLD) {
+        return false;
+    }
+    counter.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @note 哈希项超过IX_AHI_MAX_ENTRIES时清空所有哈希项，由仍然热的叶子重新建立
+ */
+void IxAdaptiveHash::build(page_id_t page_no, uint32_t version, const char *keys, int len, int n) {
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    erase_page(page_no);
+    if (entries_.size() + n > IX_AHI_MAX_ENTRIES) {
+        entries_.clear();
+        page_keys_.clear();
+    }
+    auto &page_keys = page_keys_[page_no];
+    for (int i = 0; i < n; i++) {
+        std::string key(keys + static_cast<size_t>(i) * len, len);
+        entries_[key] = {page_no, i, version};
+        page_keys.push_back(std::move(key));
+    }
+    num_entries_.store(entries_.size(), std::memory_order_relaxed);
+}
+
+void IxAdaptiveHash::invalidate_page(page_id_t page_no) {
+    if (size() == 0) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    erase_page(page_no);
+    num_entries_.store(entries_.size(), std::memory_order_relaxed);
+}
+
+void IxAdaptiveHash::clear() {
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    entries_.clear();
+    page_keys_.clear();
+    num_entries_.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 删除叶子结点page_no的哈希项；key可能已经由其他叶子重新建立，只删除仍指向page_no的项
+ */
+void IxAdaptiveHash::erase_page(page_id_t page_no) {
+    auto pos = page_keys_.find(page_no);
+    if (pos == page_keys_.end()) {
+        return;
+    }
+    for (auto &key : pos->second) {
+        auto it = entries_.find(key);
+        if (it != entries_.end() && it->second.page_no == page_no) {
+            entries_.erase(it);
+        }
+    }
+    page_keys_.erase(pos);
+}
@@ -0,0 +1,62 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ix_defs.h"
+
+/**
+ * @description: 自适应哈希索引，只保存在内存中，把热点叶子结点中的完整key直接映射到它所在的叶子和slot
+ * 点查找每次下降到叶子结点时记录一次访问，同一个叶子被访问IX_AHI_HOT_THRESHOLD次后为其中所有的key建立哈希项，
+ * 之后查找这些key只需一次哈希探测和一次页面访问。
+ * 哈希项记录建立时叶子结点的版本号（IxPageHdr::version），使用前在叶子的读锁下核对版本号，
+ * 版本号不同说明键值对的位置已经改变，该项作废；分裂、合并、重分配和删除时也主动作废整个叶子的哈希项
+ * @note 所有接口都可以并发调用；没有哈希项时lookup和invalidate_page不加锁
+ */
+class IxAdaptiveHash {
+   public:
+    struct Entry {
+        page_id_t page_no;
+        int slot_no;
+        uint32_t version;
+    };
+
+    static constexpr int NUM_COUNTERS = 1024;  // 访问计数按页面号散列到固定数量的计数器上，冲突只会使叶子提前变热
+
+    bool lookup(const char *key, int len, Entry *entry) const;
+
+    /* 记录一次对叶子结点page_no的访问，返回true表示该叶子刚刚变热，调用者应当为它建立哈希项 */
+    bool record_access(page_id_t page_no);
+
+    /* 为叶子结点page_no中的n个完整key建立哈希项，keys[i]位于第i个slot */
+    void build(page_id_t page_no, uint32_t version, const char *keys, int len, int n);
+
+    void invalidate_page(page_id_t page_no);
+
+    void clear();
+
+    size_t size() const { return num_entries_.load(std::memory_order_relaxed); }
+
+   private:
+    void erase_page(page_id_t page_no);
+
+    mutable std::shared_mutex latch_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::unordered_map<page_id_t, std::vector<std::string>> page_keys_;  // 每个叶子结点建立了哈希项的key
+    std::atomic<size_t> num_entries_{0};
+    std::array<std::atomic<uint16_t>, NUM_COUNTERS> hits_{};
+};
@@ -0,0 +1,111 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_bloom_filter.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace {
+
+constexpr int IX_BLOOM_NUM_PROBES = 8;              // 每个key在块内设置的位数
+constexpr uint64_t IX_BLOOM_MAGIC = 0x4d4f4f4c42584952ull;  // 保存的文件以此开头
+
+/* 块内的位置由另一个哈希值经双重哈希得到，与选择块的高位无关 */
+inline uint64_t probe_hash(uint64_t hash) { return hash * 0x9e3779b97f4a7c15ull; }
+
+}  // namespace
+
+IxBloomFilter::IxBloomFilter(size_t capacity, int bits_per_key)
+    : capacity_(capacity),
+      bits_per_key_(bits_per_key),
+      num_blocks_(std::max<size_t>(1, (capacity * bits_per_key + BLOCK_WORDS * 64 - 1) / (BLOCK_WORDS * 64))),
+      words_(num_blocks_ * BLOCK_WORDS) {
+    for (auto &word : words_) {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief 用哈希值的高32位选择块，相当于 hash / 2^32 * num_blocks_，不需要取模
+ */
+size_t IxBloomFilter::block_of(uint64_t hash) const {
+    return static_cast<size_t>(((hash >> 32) * static_cast<uint64_t>(num_blocks_)) >> 32);
+}
+
+void IxBloomFilter::add(const char *key, int len) {
+    uint64_t hash = ix_hash_bytes(key, len);
+    std::atomic<uint64_t> *block = &words_[block_of(hash) * BLOCK_WORDS];
+    uint64_t h = probe_hash(hash);
+    uint32_t a = static_cast<uint32_t>(h);
+    uint32_t b = static_cast<uint32_t>(h >> 32) | 1;
+    for (int i = 0; i < IX_BLOOM_NUM_PROBES; i++) {
+        uint32_t bit = (a + i * b) % (BLOCK_WORDS * 64);
+        block[bit / 64].fetch_or(1ull << (bit % 64), std::memory_order_relaxed);
+    }
+    num_keys_.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief key是否可能存在；返回false时key一定不在索引中
+ */
+bool IxBloomFilter::may_contain(const char *key, int len) const {
+    uint64_t hash = ix_hash_bytes(key, len);
+    const std::atomic<uint64_t> *block = &words_[block_of(hash) * BLOCK_WORDS];
+    uint64_t h = probe_hash(hash);
+    uint32_t a = static_cast<uint32_t>(h);
+    uint32_t b = static_cast<uint32_t>(h >> 32) | 1;
+    for (int i = 0; i < IX_BLOOM_NUM_PROBES; i++) {
+        uint32_t bit = (a + i * b) % (BLOCK_WORDS * 64);
+        if ((block[bit / 64].load(std::memory_order_relaxed) & (1ull << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 写入文件：| magic | capacity | bits_per_key | num_keys | words |
+ */
+void IxBloomFilter::save(const std::string &path) const {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    uint64_t header[4] = {IX_BLOOM_MAGIC, capacity_, static_cast<uint64_t>(bits_per_key_), get_num_keys()};
+    ofs.write(reinterpret_cast<const char *>(header), sizeof(header));
+    std::vector<uint64_t> words(words_.size());
+    for (size_t i = 0; i < words.size(); i++) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+    }
+    ofs.write(reinterpret_cast<const char *>(words.data()), words.size() * sizeof(uint64_t));
+    if (!ofs) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @brief 读入save写出的文件
+ * @return 文件不存在或内容不完整时返回nullptr，调用者需要重建
+ */
+std::unique_ptr<IxBloomFilter> IxBloomFilter::load(const std::string &path) {
+    std::ifstream ifs(path, std::ios::binary);
+    uint64_t header[4];
+    if (!ifs.read(reinterpret_cast<char *>(header), sizeof(header)) || header[0] != IX_BLOOM_MAGIC) {
+        return nullptr;
+    }
+    auto filter = std::make_unique<IxBloomFilter>(header[1], static_cast<int>(header[2]));
+    std::vector<uint64_t> words(filter->words_.size());
+    if (!ifs.read(reinterpret_cast<char *>(words.data()), words.size() * sizeof(uint64_t))) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < words.size(); i++) {
+        filter->words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    filter->num_keys_.store(header[3], std::memory_order_relaxed);
+    return filter;
+}
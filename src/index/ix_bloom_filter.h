@@ -0,0 +1,59 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ix_defs.h"
+
+/**
+ * @description: 分块的Bloom过滤器，只保存在内存中，关闭索引时写入索引文件旁边的文件
+ * 每个key只落在一个64字节（一条cache line）的块中，在块内设置IX_BLOOM_NUM_PROBES个位，因此每次查找只访问一条cache line。
+ * 只支持加入key，删除索引中的key后过滤器仍认为它可能存在，只会多一次查找，不影响正确性
+ * @note add和may_contain可以并发调用，各个位用原子操作设置
+ */
+class IxBloomFilter {
+   public:
+    static constexpr int BLOCK_WORDS = 8;  // 每块8个64位字，共512位
+
+    /**
+     * @param capacity 预计加入的key数量，加入的key超过该数量后误判率上升，需要重建
+     * @param bits_per_key 每个key占用的位数
+     */
+    IxBloomFilter(size_t capacity, int bits_per_key);
+
+    void add(const char *key, int len);
+
+    bool may_contain(const char *key, int len) const;
+
+    size_t get_capacity() const { return capacity_; }
+
+    size_t get_num_keys() const { return num_keys_.load(std::memory_order_relaxed); }
+
+    /* 加入的key超过了预计数量 */
+    bool is_overloaded() const { return get_num_keys() > capacity_; }
+
+    void save(const std::string &path) const;
+
+    static std::unique_ptr<IxBloomFilter> load(const std::string &path);
+
+   private:
+    size_t block_of(uint64_t hash) const;
+
+    size_t capacity_;
+    int bits_per_key_;
+    size_t num_blocks_;
+    std::vector<std::atomic<uint64_t>> words_;
+    std::atomic<size_t> num_keys_{0};
+};
@@ -0,0 +1,484 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_bulk_loader.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+/**
+ * @description: 顺序读取一个有序归并段，每次从文件中读入一整块
+ */
+class IxBulkLoader::RunReader {
+   public:
+    static constexpr int BLOCK_SIZE = 16 * PAGE_SIZE;
+
+    RunReader(const std::string &path, int entry_len) : entry_len_(entry_len) {
+        fd_ = open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            throw UnixError();
+        }
+        // 块大小取entry_len的整数倍，保证键值对不会跨块
+        block_.resize(std::max(1, BLOCK_SIZE / entry_len) * entry_len);
+        refill();
+    }
+
+    ~RunReader() { close(fd_); }
+
+    bool is_end() const { return pos_ >= len_; }
+
+    const char *key() const { return block_.data() + pos_; }
+
+    void next() {
+        pos_ += entry_len_;
+        if (pos_ >= len_) {
+            refill();
+        }
+    }
+
+   private:
+    void refill() {
+        ssize_t n = read(fd_, block_.data(), block_.size());
+        if (n < 0) {
+            throw UnixError();
+        }
+        len_ = static_cast<int>(n);
+        pos_ = 0;
+    }
+
+    int fd_;
+    int entry_len_;
+    std::vector<char> block_;
+    int len_ = 0;
+    int pos_ = 0;
+};
+
+IxBulkLoader::IxBulkLoader(IxIndexHandle *ih, double fill_factor, size_t sort_buffer_size)
+    : ih_(ih), file_hdr_(ih->file_hdr_), fill_factor_(fill_factor) {
+    if (file_hdr_->root_page_ != IX_INIT_ROOT_PAGE || file_hdr_->num_pages_ != IX_INIT_NUM_PAGES) {
+        throw InternalError("IxBulkLoader: index is not empty");
+    }
+    entry_len_ = file_hdr_->col_tot_len_ + sizeof(Rid);
+    max_buffered_ = std::max<size_t>(1, sort_buffer_size / entry_len_);
+    buffer_.resize(std::min<size_t>(max_buffered_, 1024) * entry_len_);
+}
+
+IxBulkLoader::~IxBulkLoader() {
+    for (auto &path : run_files_) {
+        unlink(path.c_str());
+    }
+}
+
+/**
+ * @description: 加入一个待插入的键值对，排序缓冲区满时排序并写出一个归并段
+ * key为各字段原始值拼接而成，放入缓冲区时编码为规范化的key，之后的排序和归并都直接比较字节
+ */
+void IxBulkLoader::add(const char *key, const Rid &rid) {
+    if (num_buffered_ == max_buffered_) {
+        spill_run();
+    }
+    if ((num_buffered_ + 1) * entry_len_ > buffer_.size()) {
+        buffer_.resize(std::min(buffer_.size() * 2, max_buffered_ * entry_len_));
+    }
+    char *entry = buffer_.data() + num_buffered_ * entry_len_;
+    file_hdr_->encode_key(key, entry);
+    memcpy(entry + file_hdr_->col_tot_len_, &rid, sizeof(Rid));
+    num_buffered_++;
+}
+
+/**
+ * @description: 对排序缓冲区中的键值对排序，有重复的key时抛出IndexEntryExistsError
+ * @return {vector<size_t>} 键值对在缓冲区中的下标，按key升序排列
+ */
+std::vector<size_t> IxBulkLoader::sort_buffer() {
+    std::vector<size_t> order(num_buffered_);
+    for (size_t i = 0; i < num_buffered_; i++) {
+        order[i] = i;
+    }
+    const char *base = buffer_.data();
+    auto key_less = [&](size_t a, size_t b) {
+        return memcmp(base + a * entry_len_, base + b * entry_len_, file_hdr_->col_tot_len_) < 0;
+    };
+    std::sort(order.begin(), order.end(), key_less);
+    if (std::adjacent_find(order.begin(), order.end(), [&](size_t a, size_t b) { return !key_less(a, b); }) !=
+        order.end()) {
+        throw IndexEntryExistsError();
+    }
+    return order;
+}
+
+/**
+ * @description: 将排序缓冲区排序后写出为一个归并段文件
+ */
+void IxBulkLoader::spill_run() {
+    std::vector<size_t> order = sort_buffer();
+    std::string path = ih_->disk_manager_->get_file_name(ih_->fd_) + ".sort" + std::to_string(run_files_.size());
+    int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        throw UnixError();
+    }
+    run_files_.push_back(path);
+
+    std::vector<char> block(std::max(1, RunReader::BLOCK_SIZE / entry_len_) * entry_len_);
+    size_t block_len = 0;
+    for (size_t idx : order) {
+        memcpy(block.data() + block_len, buffer_.data() + idx * entry_len_, entry_len_);
+        block_len += entry_len_;
+        if (block_len == block.size()) {
+            if (write(fd, block.data(), block_len) != static_cast<ssize_t>(block_len)) {
+                close(fd);
+                throw UnixError();
+            }
+            block_len = 0;
+        }
+    }
+    if (block_len > 0 && write(fd, block.data(), block_len) != static_cast<ssize_t>(block_len)) {
+        close(fd);
+        throw UnixError();
+    }
+    close(fd);
+    num_buffered_ = 0;
+}
+
+/**
+ * @description: 按key升序依次访问所有键值对
+ * 数据全部在排序缓冲区中时直接访问缓冲区，否则对所有归并段进行多路归并；
+ * 每个归并段内部没有重复的key，不同归并段之间的重复在归并时发现，抛出IndexEntryExistsError
+ * @param {Visitor} visit 形如 void(const char *entry) 的回调，entry为 key | rid
+ */
+template <typename Visitor>
+void IxBulkLoader::merge_runs(Visitor &&visit) {
+    if (run_files_.empty()) {
+        for (size_t idx : sorted_) {
+            visit(buffer_.data() + idx * entry_len_);
+        }
+        return;
+    }
+
+    std::vector<std::unique_ptr<RunReader>> readers;
+    for (auto &path : run_files_) {
+        readers.push_back(std::make_unique<RunReader>(path, entry_len_));
+    }
+    // 小根堆
+    auto greater = [&](int a, int b) {
+        return memcmp(readers[a]->key(), readers[b]->key(), file_hdr_->col_tot_len_) > 0;
+    };
+    std::priority_queue<int, std::vector<int>, decltype(greater)> heap(greater);
+    for (int i = 0; i < static_cast<int>(readers.size()); i++) {
+        if (!readers[i]->is_end()) {
+            heap.push(i);
+        }
+    }
+    std::vector<char> prev_key(file_hdr_->col_tot_len_);
+    bool has_prev = false;
+    while (!heap.empty()) {
+        int i = heap.top();
+        heap.pop();
+        const char *entry = readers[i]->key();
+        if (has_prev && memcmp(prev_key.data(), entry, file_hdr_->col_tot_len_) == 0) {
+            throw IndexEntryExistsError();
+        }
+        visit(entry);
+        memcpy(prev_key.data(), entry, file_hdr_->col_tot_len_);
+        has_prev = true;
+        readers[i]->next();
+        if (!readers[i]->is_end()) {
+            heap.push(i);
+        }
+    }
+}
+
+/**
+ * @description: 所有键值对加入完毕，完成排序并构建B+树
+ */
+void IxBulkLoader::finish() {
+    if (run_files_.empty()) {
+        sorted_ = sort_buffer();
+    } else if (num_buffered_ > 0) {
+        spill_run();
+    }
+    build();
+    if (file_hdr_->bloom_bits_per_key_ > 0) {
+        ih_->build_bloom_filter(true);
+    }
+}
+
+/**
+ * @description: 未压缩时每个结点按填充因子应存放的键值对数量
+ */
+int IxBulkLoader::node_fill(double fill_factor) const {
+    int max_fill = file_hdr_->btree_order_;           // 结点达到btree_order_+1时会分裂
+    int min_fill = (file_hdr_->btree_order_ + 1) / 2;  // 即IxNodeHandle::get_min_size()
+    int fill = static_cast<int>(std::floor(max_fill * fill_factor));
+    return std::max(std::min(fill, max_fill), std::max(min_fill, 2));
+}
+
+namespace {
+
+/**
+ * @description: 压缩时按占用的字节数划分结点：依次加入有序的key，加入后超过目标字节数时开始一个新结点
+ */
+class NodePacker {
+   public:
+    NodePacker(int len, bool is_leaf, int target_bytes, int max_keys)
+        : len_(len), first_(is_leaf ? 0 : 1), target_bytes_(target_bytes), max_keys_(max_keys), lo_key_(len) {}
+
+    /** 加入下一个key，返回是否为它开始了一个新结点 */
+    bool add(const char *key) {
+        int lcp = lcp_;
+        int max_len = max_len_;
+        if (n_ == first_) {
+            memcpy(lo_key_.data(), key, len_);
+            lcp = len_;
+        } else if (n_ > first_) {
+            lcp = std::min(lcp, ix_common_prefix(lo_key_.data(), key, len_));
+        }
+        if (n_ >= first_) {
+            max_len = std::max(max_len, ix_significant_len(key, len_));
+        }
+        int prefix_len = std::min(lcp, max_len);
+        int bytes = prefix_len + (n_ + 1) * (max_len - prefix_len + static_cast<int>(sizeof(Rid)));
+        if (n_ > 0 && (bytes > target_bytes_ || n_ + 1 > max_keys_)) {
+            sizes_.push_back(n_);
+            n_ = lcp_ = max_len_ = 0;
+            add(key);
+            return true;
+        }
+        lcp_ = lcp;
+        max_len_ = max_len;
+        n_++;
+        return false;
+    }
+
+    std::vector<int64_t> finish() {
+        if (n_ > 0) {
+            sizes_.push_back(n_);
+        }
+        return std::move(sizes_);
+    }
+
+   private:
+    int len_;
+    int first_;                     // 内部结点的第0个key不参与压缩
+    int target_bytes_;
+    int max_keys_;
+    std::vector<char> lo_key_;      // 当前结点中第一个参与压缩的key
+    int n_ = 0;                     // 当前结点中的key数量
+    int lcp_ = 0;
+    int max_len_ = 0;
+    std::vector<int64_t> sizes_;
+};
+
+}  // namespace
+
+/**
+ * @brief 自底向上构建B+树
+ * 第一遍归并确定每个叶子结点存放的键值对数量：未压缩时每层的键值对平均分配到该层的各个结点中；
+ * 压缩时按压缩后占用的字节数贪心地装满每个结点，并同时得到各叶子之间的最短分隔key，用于划分上层结点。
+ * 确定所有层的结点之后，第二遍归并写出叶子结点，再逐层写出内部结点。每个结点的high key是其右边结点的分隔key，
+ * 同一层的结点通过next_leaf连接。叶子结点从IX_INIT_ROOT_PAGE开始连续存放，之后依次是各层内部结点，根结点位于最后一页
+ * @note 写出的页面直接落盘，并从缓冲池中移除该文件原有的页面，避免读到旧的根结点和叶子头结点
+ */
+void IxBulkLoader::build() {
+    int len = file_hdr_->col_tot_len_;
+    bool compressed = file_hdr_->key_compress_;
+    int target_bytes = static_cast<int>(IxNodeHandle::usable_bytes(file_hdr_) * fill_factor_);
+    int fill = node_fill(fill_factor_);
+    auto even_sizes = [&](int64_t count) {
+        int64_t num_nodes = (count + fill - 1) / fill;
+        std::vector<int64_t> sizes;
+        for (int64_t i = 0; i < num_nodes; i++) {
+            sizes.push_back((i + 1) * count / num_nodes - i * count / num_nodes);
+        }
+        return sizes;
+    };
+
+    // sizes[k][i] = 第k层第i个结点的键值对数量，第0层为叶子
+    std::vector<std::vector<int64_t>> sizes;
+    num_entries_ = 0;
+    if (compressed) {
+        NodePacker packer(len, true, target_bytes, file_hdr_->btree_order_);
+        std::vector<char> prev_key(len);
+        std::vector<char> seps;  // 每个结点的分隔key
+        merge_runs([&](const char *entry) {
+            bool new_node = packer.add(entry);
+            if (num_entries_ == 0 || new_node) {
+                seps.resize(seps.size() + len);
+                if (num_entries_ == 0) {
+                    memcpy(seps.data(), entry, len);
+                } else {
+                    ix_make_separator(prev_key.data(), entry, len, seps.data() + seps.size() - len);
+                }
+            }
+            memcpy(prev_key.data(), entry, len);
+            num_entries_++;
+        });
+        if (num_entries_ == 0) {
+            return;
+        }
+        sizes.push_back(packer.finish());
+        while (sizes.back().size() > 1) {
+            NodePacker inner_packer(len, false, target_bytes, file_hdr_->btree_order_);
+            std::vector<char> next_seps;
+            for (size_t i = 0; i < sizes.back().size(); i++) {
+                const char *sep = seps.data() + i * len;
+                bool new_node = inner_packer.add(sep);
+                if (i == 0 || new_node) {
+                    next_seps.insert(next_seps.end(), sep, sep + len);
+                }
+            }
+            sizes.push_back(inner_packer.finish());
+            seps.swap(next_seps);
+        }
+    } else {
+        merge_runs([&](const char *) { num_entries_++; });
+        if (num_entries_ == 0) {
+            return;
+        }
+        sizes.push_back(even_sizes(num_entries_));
+        while (sizes.back().size() > 1) {
+            sizes.push_back(even_sizes(sizes.back().size()));
+        }
+    }
+
+    // levels[k] = 第k层第一个结点的页面号
+    std::vector<page_id_t> levels;
+    page_id_t next_page_no = IX_INIT_ROOT_PAGE;
+    for (auto &level_sizes : sizes) {
+        levels.push_back(next_page_no);
+        next_page_no += static_cast<page_id_t>(level_sizes.size());
+    }
+
+    auto disk_manager = ih_->disk_manager_;
+    int fd = ih_->fd_;
+    // 整个文件重写，原有的页面（包括常驻结点和空闲页面）都不再有效
+    ih_->unpin_all_pinned_pages();
+    ih_->buffer_pool_manager_->remove_all_pages(fd);
+
+    Page page;
+    IxNodeHandle node(file_hdr_, &page);
+    auto init_page = [&](page_id_t parent, bool is_leaf, page_id_t prev_leaf, page_id_t next_leaf) {
+        memset(page.get_data(), 0, PAGE_SIZE);
+        *node.page_hdr = {
+            .next_free_page_no = IX_NO_PAGE,
+            .parent = parent,
+            .num_key = 0,
+            .is_leaf = is_leaf,
+            .prev_leaf = prev_leaf,
+            .next_leaf = next_leaf,
+            .prefix_len = 0,
+            .key_len = 0,
+        };
+    };
+
+    // 当前层第node_idx个结点的父结点页面号，parent_idx和parent_end为调用者保存的游标
+    auto parent_of = [&](size_t level, int64_t node_idx, int64_t *parent_idx, int64_t *parent_end) -> page_id_t {
+        if (level + 1 == sizes.size()) {
+            return IX_NO_PAGE;
+        }
+        while (*parent_end <= node_idx) {
+            *parent_end += sizes[level + 1][++*parent_idx];
+        }
+        return levels[level + 1] + static_cast<page_id_t>(*parent_idx);
+    };
+
+    // 写出叶子结点，同时记录每个叶子的分隔key作为上一层的key；
+    // 叶子结点的high key即下一个叶子的分隔key，因此每个叶子在遇到下一个叶子的第一个键值对时才写出
+    int64_t num_leaves = sizes[0].size();
+    std::vector<char> seps(num_leaves * len);
+    {
+        int64_t leaf_idx = 0;
+        int64_t parent_idx = 0;
+        int64_t parent_end = sizes.size() > 1 ? sizes[1][0] : 0;
+        std::vector<char> keys;
+        std::vector<Rid> rids;
+        std::vector<char> prev_key(len);
+        auto write_leaf = [&](const char *high_key) {
+            node.set_high_key(high_key);
+            disk_manager->write_page(fd, levels[0] + static_cast<page_id_t>(leaf_idx - 1), page.get_data(), PAGE_SIZE);
+        };
+        merge_runs([&](const char *entry) {
+            if (rids.empty()) {
+                char *sep = seps.data() + leaf_idx * len;
+                if (compressed && leaf_idx > 0) {
+                    ix_make_separator(prev_key.data(), entry, len, sep);
+                } else {
+                    memcpy(sep, entry, len);
+                }
+                if (leaf_idx > 0) {
+                    write_leaf(sep);
+                }
+            }
+            keys.insert(keys.end(), entry, entry + len);
+            rids.push_back(*reinterpret_cast<const Rid *>(entry + len));
+            memcpy(prev_key.data(), entry, len);
+            if (static_cast<int64_t>(rids.size()) == sizes[0][leaf_idx]) {
+                page_id_t page_no = levels[0] + static_cast<page_id_t>(leaf_idx);
+                init_page(parent_of(0, leaf_idx, &parent_idx, &parent_end), true,
+                          leaf_idx == 0 ? IX_LEAF_HEADER_PAGE : page_no - 1,
+                          leaf_idx == num_leaves - 1 ? IX_LEAF_HEADER_PAGE : page_no + 1);
+                node.assign(keys.data(), rids.data(), static_cast<int>(rids.size()));
+                keys.clear();
+                rids.clear();
+                leaf_idx++;
+            }
+        });
+        assert(leaf_idx == num_leaves);
+        write_leaf(nullptr);
+    }
+
+    // 逐层写出内部结点，内部结点的分隔key即为其第一个孩子的分隔key
+    for (size_t level = 1; level < sizes.size(); level++) {
+        int64_t num_nodes = sizes[level].size();
+        std::vector<char> next_seps(num_nodes * len);
+        int64_t parent_idx = 0;
+        int64_t parent_end = level + 1 < sizes.size() ? sizes[level + 1][0] : 0;
+        int64_t child = 0;
+        for (int64_t node_idx = 0; node_idx < num_nodes; node_idx++) {
+            int n = static_cast<int>(sizes[level][node_idx]);
+            std::vector<Rid> rids(n);
+            for (int i = 0; i < n; i++) {
+                rids[i] = Rid{levels[level - 1] + static_cast<page_id_t>(child + i), -1};
+            }
+            bool is_last = node_idx + 1 == num_nodes;
+            page_id_t page_no = levels[level] + static_cast<page_id_t>(node_idx);
+            init_page(parent_of(level, node_idx, &parent_idx, &parent_end), false, IX_NO_PAGE,
+                      is_last ? IX_NO_PAGE : page_no + 1);
+            node.assign(seps.data() + child * len, rids.data(), n);
+            node.set_high_key(is_last ? nullptr : seps.data() + (child + n) * len);
+            memcpy(next_seps.data() + node_idx * len, seps.data() + child * len, len);
+            disk_manager->write_page(fd, page_no, page.get_data(), PAGE_SIZE);
+            child += n;
+        }
+        seps.swap(next_seps);
+    }
+
+    // 叶子头结点
+    page_id_t first_leaf = levels[0];
+    page_id_t last_leaf = levels[0] + static_cast<page_id_t>(num_leaves - 1);
+    init_page(IX_NO_PAGE, true, last_leaf, first_leaf);
+    disk_manager->write_page(fd, IX_LEAF_HEADER_PAGE, page.get_data(), PAGE_SIZE);
+
+    // 更新并写回文件头
+    IxFileHdr *file_hdr = ih_->file_hdr_;
+    file_hdr->num_pages_ = next_page_no;
+    file_hdr->first_free_page_no_ = IX_NO_PAGE;
+    file_hdr->first_leaf_ = first_leaf;
+    file_hdr->last_leaf_ = last_leaf;
+    ih_->update_root_page_no(levels.back());
+    disk_manager->set_fd2pageno(fd, file_hdr->num_pages_);
+    std::vector<char> hdr_buf(file_hdr->tot_len_);
+    file_hdr->serialize(hdr_buf.data());
+    disk_manager->write_page(fd, IX_FILE_HDR_PAGE, hdr_buf.data(), file_hdr->tot_len_);
+}
@@ -0,0 +1,66 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ix_index_handle.h"
+
+/**
+ * @description: 自底向上批量构建B+树
+ * 调用者逐条add()待插入的(key, rid)，finish()时对其进行外部排序，
+ * 然后按填充因子依次写出叶子结点和各层内部结点，所有页面按页号顺序直接写入磁盘，不经过缓冲池；
+ * key压缩时填充因子按结点占用的字节数计算
+ * @note 只能用于刚创建的空索引；索引是唯一索引，加入的key重复时finish()抛出IndexEntryExistsError，
+ * 而不是丢弃其中的一部分键值对，否则索引会缺少表中的记录
+ */
+class IxBulkLoader {
+   public:
+    IxBulkLoader(IxIndexHandle *ih, double fill_factor = IX_BULK_LOAD_FILL_FACTOR,
+                 size_t sort_buffer_size = IX_SORT_BUFFER_SIZE);
+
+    ~IxBulkLoader();
+
+    void add(const char *key, const Rid &rid);
+
+    void finish();
+
+    size_t get_num_entries() const { return num_entries_; }
+
+    int get_num_runs() const { return static_cast<int>(run_files_.size()); }
+
+   private:
+    class RunReader;
+
+    std::vector<size_t> sort_buffer();
+
+    void spill_run();
+
+    template <typename Visitor>
+    void merge_runs(Visitor &&visit);
+
+    void build();
+
+    int node_fill(double fill_factor) const;
+
+    IxIndexHandle *ih_;
+    const IxFileHdr *file_hdr_;
+    double fill_factor_;
+    int entry_len_;                         // 每个键值对在排序缓冲区和归并段中占用的字节数
+    size_t max_buffered_;                   // 排序缓冲区最多容纳的键值对数量
+    std::vector<char> buffer_;              // 排序缓冲区，依次存放 key | rid
+    size_t num_buffered_ = 0;
+    std::vector<size_t> sorted_;            // 没有写出归并段时，排序缓冲区中的有序下标
+    std::vector<std::string> run_files_;    // 已写出的有序归并段文件
+    size_t num_entries_ = 0;                // 键值对数量，finish()之后有效
+};
@@ -0,0 +1,119 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#include "ix_change_buffer.h"
+
+#include <unistd.h>
+
+/**
+ * @brief 日志中的每条记录为 | is_insert (1字节) | key (key_len字节) | rid |
+ */
+IxChangeBuffer::IxChangeBuffer(const std::string &log_path, int key_len) : log_path_(log_path), key_len_(key_len) {
+    std::ifstream ifs(log_path_, std::ios::binary);
+    std::string key(key_len_, '\0');
+    char is_insert;
+    Rid rid;
+    off_t valid_len = 0;
+    while (ifs.read(&is_insert, 1) && ifs.read(&key[0], key_len_) &&
+           ifs.read(reinterpret_cast<char *>(&rid), sizeof(Rid))) {
+        apply(key, is_insert, rid);
+        valid_len += 1 + key_len_ + sizeof(Rid);
+    }
+    if (ifs.is_open()) {
+        // 末尾不完整的记录是写入时崩溃留下的，对应的修改没有生效，截掉之后再追加
+        ifs.close();
+        if (truncate(log_path_.c_str(), valid_len) < 0) {
+            throw UnixError();
+        }
+    }
+    log_.open(log_path_, std::ios::binary | std::ios::app);
+    if (!log_) {
+        throw UnixError();
+    }
+}
+
+void IxChangeBuffer::apply(const std::string &key, bool is_insert, const Rid &rid) {
+    auto [it, inserted] = changes_.emplace(key, Change{false, false, Rid{IX_NO_PAGE, -1}});
+    Change &change = it->second;
+    if (!is_insert) {
+        // 删除之后B+树中一定没有该key，之前暂存的修改都被覆盖
+        change = {true, false, Rid{IX_NO_PAGE, -1}};
+    } else if (!change.has_insert) {
+        change.has_insert = true;
+        change.rid = rid;
+    }
+    // 已经暂存了插入时，再次插入同一个key与直接插入B+树一样被忽略
+}
+
+void IxChangeBuffer::append_log(const char *key, bool is_insert, const Rid &rid) {
+    char flag = is_insert;
+    log_.write(&flag, 1);
+    log_.write(key, key_len_);
+    log_.write(reinterpret_cast<const char *>(&rid), sizeof(Rid));
+}
+
+void IxChangeBuffer::add_insert(const char *key, const Rid &rid) {
+    append_log(key, true, rid);
+    log_.flush();
+    apply(std::string(key, key_len_), true, rid);
+}
+
+void IxChangeBuffer::add_delete(const char *key) {
+    Rid rid = {IX_NO_PAGE, -1};
+    append_log(key, false, rid);
+    log_.flush();
+    apply(std::string(key, key_len_), false, rid);
+}
+
+/**
+ * @brief 是否有key位于[lower, upper]中的暂存修改
+ */
+bool IxChangeBuffer::contains(const char *lower, const char *upper) const {
+    auto it = changes_.lower_bound(std::string(lower, key_len_));
+    return it != changes_.end() && memcmp(it->first.data(), upper, key_len_) <= 0;
+}
+
+/**
+ * @brief 查找key上暂存的修改，没有时返回nullptr
+ */
+const IxChangeBuffer::Change *IxChangeBuffer::find(const char *key) const {
+    auto it = changes_.find(std::string(key, key_len_));
+    return it == changes_.end() ? nullptr : &it->second;
+}
+
+/**
+ * @brief 取出key位于[lower, upper]中的暂存修改，按key的顺序返回
+ */
+std::vector<std::pair<std::string, IxChangeBuffer::Change>> IxChangeBuffer::take(const char *lower, const char *upper) {
+    auto first = changes_.lower_bound(std::string(lower, key_len_));
+    auto last = changes_.upper_bound(std::string(upper, key_len_));
+    std::vector<std::pair<std::string, Change>> taken(first, last);
+    changes_.erase(first, last);
+    return taken;
+}
+
+std::vector<std::pair<std::string, IxChangeBuffer::Change>> IxChangeBuffer::take_all() {
+    std::vector<std::pair<std::string, Change>> taken(changes_.begin(), changes_.end());
+    changes_.clear();
+    return taken;
+}
+
+/**
+ * @brief 所有修改都已合并到B+树之后清空日志
+ */
+void IxChangeBuffer::clear_log() {
+    assert(changes_.empty());
+    log_.close();
+    log_.open(log_path_, std::ios::binary | std::ios::trunc);
+    if (!log_) {
+        throw UnixError();
+    }
+}
@@ -0,0 +1,70 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#pragma once
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ix_defs.h"
+
+/**
+ * @description: 二级索引的change buffer，暂存尚未合并到B+树叶子结点中的插入和删除
+ * 同一个key上的多次修改折叠为一项：先删除B+树中已有的键值对（可选），再插入新的键值对（可选），
+ * 效果与依次执行这些修改相同。key为规范化的key，按key的顺序合并，使得对叶子结点的访问是顺序的。
+ * 每次修改同时追加到日志文件中，重新打开索引时重放日志即可恢复未合并的修改；
+ * 已经合并的修改重放之后再合并一次，结果不变，因此只有全部合并之后才清空日志
+ * @note 不加锁，由IxIndexHandle::change_latch_保护
+ */
+class IxChangeBuffer {
+   public:
+    struct Change {
+        bool delete_first;  // 先删除B+树中该key已有的键值对
+        bool has_insert;    // 再插入(key, rid)
+        Rid rid;
+    };
+
+    /**
+     * @param log_path 日志文件，已存在时重放其中的修改
+     * @param key_len 规范化的key的长度
+     */
+    IxChangeBuffer(const std::string &log_path, int key_len);
+
+    void add_insert(const char *key, const Rid &rid);
+
+    void add_delete(const char *key);
+
+    size_t size() const { return changes_.size(); }
+
+    bool empty() const { return changes_.empty(); }
+
+    bool contains(const char *lower, const char *upper) const;
+
+    const Change *find(const char *key) const;
+
+    std::vector<std::pair<std::string, Change>> take(const char *lower, const char *upper);
+
+    std::vector<std::pair<std::string, Change>> take_all();
+
+    void clear_log();
+
+   private:
+    void apply(const std::string &key, bool is_insert, const Rid &rid);
+
+    void append_log(const char *key, bool is_insert, const Rid &rid);
+
+    std::string log_path_;
+    int key_len_;
+    std::map<std::string, Change> changes_;  // std::string按无符号字节比较，与规范化的key的顺序一致
+    std::ofstream log_;
+};
@@ -21,6 +21,36 @@ constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
+constexpr double IX_BULK_LOAD_FILL_FACTOR = 0.9;           // 批量构建索引时结点的默认填充因子
+constexpr size_t IX_SORT_BUFFER_SIZE = 64 * 1024 * 1024;  // 批量构建索引时外部排序使用的内存大小
+
+constexpr int IX_BLOOM_BITS_PER_KEY = 10;                  // 启用Bloom过滤器时每个key默认占用的位数
+constexpr int IX_APPEND_SPLIT_FILL = 90;                   // 在最右结点末尾追加引起拆分时，左边结点保留的键值对百分比
+constexpr size_t IX_CHANGE_BUFFER_MAX_ENTRIES = 4096;      // change buffer中暂存的key达到该数量时全部合并到B+树
+constexpr int IX_AHI_HOT_THRESHOLD = 16;                   // 叶子结点被点查找访问这么多次后为其中的key建立自适应哈希项
+constexpr size_t IX_AHI_MAX_ENTRIES = 1 << 16;             // 每个索引的自适应哈希项数量上限
+constexpr int IX_PINNED_NODES = 32;                       // 每个打开的索引常驻缓冲池的上层结点数量上限
+constexpr int IX_OP_EPOCHS = 64;                          // 分别统计活跃操作数量的最近的纪元个数，见IxIndexHandle::enter_op
+constexpr size_t IX_REINDEX_FREEZE_ENTRIES = 1024;       // 在线重建索引时side log中剩余的修改少于该数量才冻结写操作并切换
+
+/**
+ * @brief 对key的所有字节做FNV-1a哈希，再做一次混合，使低位和高位都分布均匀
+ */
+inline uint64_t ix_hash_bytes(const char *key, int len) {
+    uint64_t h = 14695981039346656037ull;
+    for (int i = 0; i < len; i++) {
+        h ^= static_cast<unsigned char>(key[i]);
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+// 未压缩结点中key的比较方式，打开索引时由索引字段推导得到，不持久化
+// UINT32：单列INT或FLOAT；UINT64：两列数值（如INT+INT）；GENERIC：其他定长的key，逐字节memcmp
+enum IxKeySearch { IX_SEARCH_GENERIC = 0, IX_SEARCH_UINT32, IX_SEARCH_UINT64 };
 
 class IxFileHdr {
 public: 
@@ -36,7 +66,11 @@ public:
     // first_leaf初始化之后没有进行修改，只不过是在测试文件中遍历叶子结点的时候用了
     page_id_t first_leaf_;              // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_;               // 尾叶节点对应的页号
+    int bloom_bits_per_key_ = 0;        // Bloom过滤器中每个key占用的位数，0表示不使用Bloom过滤器
+    bool change_buffer_ = false;        // 是否用change buffer暂存执行器对B+树的修改，之后批量合并
     int tot_len_;                       // 记录结构体的整体长度
+    IxKeySearch key_search_ = IX_SEARCH_GENERIC;  // 规范化的key可按大端无符号整数比较时使用特化的查找，不参与序列化
+    bool key_compress_ = false;                   // 结点内的key是否做前缀压缩和后缀截断，不参与序列化
 
     IxFileHdr() {
         tot_len_ = col_num_ = 0;
@@ -49,9 +83,100 @@ public:
                     tot_len_ = 0;
                 } 
 
+    /**
+     * @brief 是否对结点内的key做前缀压缩和后缀截断
+     * 规范化之后所有key都按字节比较，都可以压缩；纯数值的key定长且很短，压缩的收益有限，
+     * 因此只压缩包含字符串字段的key，纯数值的key保持定长存放，单列时还可以使用SIMD查找
+     */
+    static bool use_key_compression(const std::vector<ColType> &col_types) {
+        for (auto type : col_types) {
+            if (type == TYPE_STRING) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 根据索引字段选择结点内key的比较方式，在deserialize即IxManager::open_index时调用一次
+     * 规范化的数值key按大端存放，总长度为4或8字节时可以整体读成一个无符号整数比较
+     */
+    void update_key_search() {
+        key_compress_ = use_key_compression(col_types_);
+        key_search_ = IX_SEARCH_GENERIC;
+        if (!key_compress_ && col_tot_len_ == 4) {
+            key_search_ = IX_SEARCH_UINT32;
+        } else if (!key_compress_ && col_tot_len_ == 8) {
+            key_search_ = IX_SEARCH_UINT64;
+        }
+    }
+
+    /**
+     * @brief 将各字段原始值拼接成的key编码为规范化的key，规范化的key之间直接用memcmp比较，结果与逐字段比较原始值一致
+     * INT：符号位取反后按大端存放；FLOAT：非负数符号位取反、负数所有位取反后按大端存放；字符串：定长且末尾补0，原样存放
+     * @return dst
+     */
+    char *encode_key(const char *raw, char *dst) const {
+        int offset = 0;
+        for (int i = 0; i < col_num_; ++i) {
+            if (col_types_[i] == TYPE_STRING) {
+                memcpy(dst + offset, raw + offset, col_lens_[i]);
+            } else {
+                uint32_t bits;
+                memcpy(&bits, raw + offset, sizeof(bits));
+                if (col_types_[i] == TYPE_FLOAT && (bits & 0x80000000u)) {
+                    bits = ~bits;
+                } else {
+                    bits ^= 0x80000000u;
+                }
+                store_big_endian(bits, dst + offset);
+            }
+            offset += col_lens_[i];
+        }
+        return dst;
+    }
+
+    /**
+     * @brief encode_key的逆过程，只在需要字段原始值的地方使用
+     * @return dst
+     */
+    char *decode_key(const char *key, char *dst) const {
+        int offset = 0;
+        for (int i = 0; i < col_num_; ++i) {
+            if (col_types_[i] == TYPE_STRING) {
+                memcpy(dst + offset, key + offset, col_lens_[i]);
+            } else {
+                uint32_t bits = load_big_endian(key + offset);
+                if (col_types_[i] == TYPE_FLOAT && !(bits & 0x80000000u)) {
+                    bits = ~bits;
+                } else {
+                    bits ^= 0x80000000u;
+                }
+                memcpy(dst + offset, &bits, sizeof(bits));
+            }
+            offset += col_lens_[i];
+        }
+        return dst;
+    }
+
+    static void store_big_endian(uint32_t bits, char *dst) {
+        for (int i = 3; i >= 0; --i) {
+            dst[i] = static_cast<char>(bits & 0xff);
+            bits >>= 8;
+        }
+    }
+
+    static uint32_t load_big_endian(const char *src) {
+        uint32_t bits = 0;
+        for (int i = 0; i < 4; ++i) {
+            bits = (bits << 8) | static_cast<unsigned char>(src[i]);
+        }
+        return bits;
+    }
+
     void update_tot_len() {
         tot_len_ = 0;
-        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
+        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 7 + sizeof(bool);
         tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
     }
 
@@ -85,6 +210,10 @@ public:
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
+        memcpy(dest + offset, &bloom_bits_per_key_, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, &change_buffer_, sizeof(bool));
+        offset += sizeof(bool);
         assert(offset == tot_len_);
     }
 
@@ -123,18 +252,28 @@ public:
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t*>(src + offset);
         offset += sizeof(page_id_t);
+        bloom_bits_per_key_ = *reinterpret_cast<const int*>(src + offset);
+        offset += sizeof(int);
+        change_buffer_ = *reinterpret_cast<const bool*>(src + offset);
+        offset += sizeof(bool);
         assert(offset == tot_len_);
+        update_key_search();
     }
 };
 
 class IxPageHdr {
 public:
-    page_id_t next_free_page_no;    // unused
+    page_id_t next_free_page_no;    // 结点被回收后，空闲页面链表中的下一个页面；链表头为IxFileHdr::first_free_page_no_
     page_id_t parent;               // 父亲节点所在页面的叶号
     int num_key;                    // # current keys (always equals to #child - 1) 已插入的keys数量，key_idx∈[0,num_key)
     bool is_leaf;                   // 是否为叶节点
+    bool has_high_key;              // 是否有high key，每一层最右边的结点没有上界
+    bool is_deleted;                // 结点已被合并掉或根结点已下移，读到该结点的查找需要从根结点重新开始
     page_id_t prev_leaf;            // previous leaf node's page_no, effective only when is_leaf is true
-    page_id_t next_leaf;            // next leaf node's page_no, effective only when is_leaf is true
+    page_id_t next_leaf;            // 右兄弟的page_no，叶子结点中即为后继叶子；内部结点的最右兄弟为IX_NO_PAGE
+    int16_t prefix_len;             // 结点内所有key的公共前缀长度，只在key_compress_时有效
+    int16_t key_len;                // 去掉公共前缀并截断末尾的0之后，每个key存放的字节数，只在key_compress_时有效
+    uint32_t version;               // 结点中键值对的数量或位置每次改变时加一，自适应哈希索引据此判断记录的slot是否仍然有效
 };
 
 class Iid {
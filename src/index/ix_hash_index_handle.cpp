@@ -0,0 +1,284 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_hash_index_handle.h"
+
+#include <mutex>
+
+IxHashIndexHandle::IxHashIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
+    : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
+    char buf[PAGE_SIZE];
+    disk_manager_->read_page(fd, IX_HASH_FILE_HDR_PAGE, buf, PAGE_SIZE);
+    file_hdr_.deserialize(buf);
+    // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
+    disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages_);
+}
+
+/**
+ * @brief key的哈希值，目录使用其低位
+ */
+uint64_t IxHashIndexHandle::hash_key(const char *key) const { return ix_hash_bytes(key, file_hdr_.col_tot_len_); }
+
+/**
+ * @brief 返回哈希值hash对应的目录项中的桶页号
+ * @note 调用者需要持有dir_latch_
+ */
+page_id_t IxHashIndexHandle::get_bucket_page_no(uint64_t hash) {
+    int dir_idx = static_cast<int>(hash & ((1ull << file_hdr_.global_depth_) - 1));
+    PageId page_id = {.fd = fd_, .page_no = file_hdr_.dir_pages_[dir_idx / IX_HASH_DIR_ENTRIES_PER_PAGE]};
+    Page *page = buffer_pool_manager_->fetch_page(page_id);
+    if (page == nullptr) {
+        throw InternalError("IxHashIndexHandle::get_bucket_page_no: buffer pool is full");
+    }
+    page_id_t bucket_page_no = reinterpret_cast<page_id_t *>(page->get_data())[dir_idx % IX_HASH_DIR_ENTRIES_PER_PAGE];
+    buffer_pool_manager_->unpin_page(page_id, false);
+    return bucket_page_no;
+}
+
+/**
+ * @note 调用者需要持有dir_latch_的写锁
+ */
+void IxHashIndexHandle::set_dir_entry(int dir_idx, page_id_t bucket_page_no) {
+    PageId page_id = {.fd = fd_, .page_no = file_hdr_.dir_pages_[dir_idx / IX_HASH_DIR_ENTRIES_PER_PAGE]};
+    Page *page = buffer_pool_manager_->fetch_page(page_id);
+    if (page == nullptr) {
+        throw InternalError("IxHashIndexHandle::set_dir_entry: buffer pool is full");
+    }
+    reinterpret_cast<page_id_t *>(page->get_data())[dir_idx % IX_HASH_DIR_ENTRIES_PER_PAGE] = bucket_page_no;
+    buffer_pool_manager_->unpin_page(page_id, true);
+}
+
+/**
+ * @brief 分配一个新页面
+ * @note pin the page, remember to unpin it outside!
+ */
+Page *IxHashIndexHandle::create_page() {
+    PageId page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
+    Page *page = buffer_pool_manager_->new_page(&page_id);
+    if (page == nullptr) {
+        throw InternalError("IxHashIndexHandle::create_page: buffer pool is full");
+    }
+    file_hdr_.num_pages_++;
+    memset(page->get_data(), 0, PAGE_SIZE);
+    return page;
+}
+
+/**
+ * @brief 返回key在桶中的位置，不存在时返回-1
+ */
+int IxHashIndexHandle::find_in_bucket(const char *bucket, const char *key) const {
+    auto hdr = reinterpret_cast<const IxHashBucketHdr *>(bucket);
+    for (int i = 0; i < hdr->num_entries; i++) {
+        if (memcmp(get_entry(const_cast<char *>(bucket), i), key, file_hdr_.col_tot_len_) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 用于查找指定键在哈希索引中的对应的值result
+ *
+ * @return key是否存在
+ */
+bool IxHashIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
+    std::shared_lock<std::shared_mutex> lock(dir_latch_);
+    PageId page_id = {.fd = fd_, .page_no = get_bucket_page_no(hash_key(key))};
+    Page *page = buffer_pool_manager_->fetch_page(page_id);
+    if (page == nullptr) {
+        throw InternalError("IxHashIndexHandle::get_value: buffer pool is full");
+    }
+    page->rlatch();
+    int pos = find_in_bucket(page->get_data(), key);
+    if (pos != -1) {
+        result->push_back(*reinterpret_cast<Rid *>(get_entry(page->get_data(), pos) + file_hdr_.col_tot_len_));
+    }
+    page->runlatch();
+    buffer_pool_manager_->unpin_page(page_id, false);
+    return pos != -1;
+}
+
+/**
+ * @brief 将指定键值对插入到哈希索引中
+ * 先只持有目录的读锁，桶未满时直接插入；桶已满时改为持有目录的写锁，分裂桶直到能够插入
+ *
+ * @return page_id_t 插入到的桶页号，key已存在时返回IX_NO_PAGE
+ */
+page_id_t IxHashIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
+    uint64_t hash = hash_key(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(dir_latch_);
+        PageId page_id = {.fd = fd_, .page_no = get_bucket_page_no(hash)};
+        Page *page = buffer_pool_manager_->fetch_page(page_id);
+        if (page == nullptr) {
+            throw InternalError("IxHashIndexHandle::insert_entry: buffer pool is full");
+        }
+        page->wlatch();
+        char *bucket = page->get_data();
+        auto hdr = reinterpret_cast<IxHashBucketHdr *>(bucket);
+        bool exists = find_in_bucket(bucket, key) != -1;
+        bool inserted = !exists && hdr->num_entries < file_hdr_.bucket_capacity_;
+        if (inserted) {
+            char *entry = get_entry(bucket, hdr->num_entries);
+            memcpy(entry, key, file_hdr_.col_tot_len_);
+            memcpy(entry + file_hdr_.col_tot_len_, &value, sizeof(Rid));
+            hdr->num_entries++;
+        }
+        page->wunlatch();
+        buffer_pool_manager_->unpin_page(page_id, inserted);
+        if (exists) {
+            return IX_NO_PAGE;
+        }
+        if (inserted) {
+            return page_id.page_no;
+        }
+    }
+
+    // 桶已满：持有写锁期间没有其他线程访问目录和桶页，不需要再对桶页加latch
+    std::unique_lock<std::shared_mutex> lock(dir_latch_);
+    while (true) {
+        PageId page_id = {.fd = fd_, .page_no = get_bucket_page_no(hash)};
+        Page *page = buffer_pool_manager_->fetch_page(page_id);
+        if (page == nullptr) {
+            throw InternalError("IxHashIndexHandle::insert_entry: buffer pool is full");
+        }
+        char *bucket = page->get_data();
+        auto hdr = reinterpret_cast<IxHashBucketHdr *>(bucket);
+        if (find_in_bucket(bucket, key) != -1) {
+            buffer_pool_manager_->unpin_page(page_id, false);
+            return IX_NO_PAGE;
+        }
+        if (hdr->num_entries < file_hdr_.bucket_capacity_) {
+            char *entry = get_entry(bucket, hdr->num_entries);
+            memcpy(entry, key, file_hdr_.col_tot_len_);
+            memcpy(entry + file_hdr_.col_tot_len_, &value, sizeof(Rid));
+            hdr->num_entries++;
+            buffer_pool_manager_->unpin_page(page_id, true);
+            return page_id.page_no;
+        }
+        buffer_pool_manager_->unpin_page(page_id, false);
+        // 分裂之后键值对可能仍全部落在同一个桶中，此时继续分裂
+        split_bucket(hash);
+    }
+}
+
+/**
+ * @brief 目录加倍：新的一半目录项与原来的一半相同
+ * @note 调用者需要持有dir_latch_的写锁
+ */
+void IxHashIndexHandle::grow_directory() {
+    int size = 1 << file_hdr_.global_depth_;
+    if (size < IX_HASH_DIR_ENTRIES_PER_PAGE) {
+        // 目录只占一个页面
+        PageId page_id = {.fd = fd_, .page_no = file_hdr_.dir_pages_[0]};
+        Page *page = buffer_pool_manager_->fetch_page(page_id);
+        if (page == nullptr) {
+            throw InternalError("IxHashIndexHandle::grow_directory: buffer pool is full");
+        }
+        auto entries = reinterpret_cast<page_id_t *>(page->get_data());
+        memcpy(entries + size, entries, size * sizeof(page_id_t));
+        buffer_pool_manager_->unpin_page(page_id, true);
+    } else {
+        // 每个目录页都是满的，复制出同样数量的目录页
+        size_t num_dir_pages = file_hdr_.dir_pages_.size();
+        for (size_t i = 0; i < num_dir_pages; i++) {
+            PageId src_id = {.fd = fd_, .page_no = file_hdr_.dir_pages_[i]};
+            Page *src = buffer_pool_manager_->fetch_page(src_id);
+            if (src == nullptr) {
+                throw InternalError("IxHashIndexHandle::grow_directory: buffer pool is full");
+            }
+            Page *dst = create_page();
+            memcpy(dst->get_data(), src->get_data(), PAGE_SIZE);
+            file_hdr_.dir_pages_.push_back(dst->get_page_id().page_no);
+            buffer_pool_manager_->unpin_page(dst->get_page_id(), true);
+            buffer_pool_manager_->unpin_page(src_id, false);
+        }
+    }
+    file_hdr_.global_depth_++;
+}
+
+/**
+ * @brief 分裂哈希值hash所在的桶：局部深度加一，按哈希值的第local_depth位把键值对分到原桶和新桶
+ * 原桶的局部深度等于全局深度时先把目录加倍
+ * @note 调用者需要持有dir_latch_的写锁
+ */
+void IxHashIndexHandle::split_bucket(uint64_t hash) {
+    PageId old_id = {.fd = fd_, .page_no = get_bucket_page_no(hash)};
+    Page *old_page = buffer_pool_manager_->fetch_page(old_id);
+    if (old_page == nullptr) {
+        throw InternalError("IxHashIndexHandle::split_bucket: buffer pool is full");
+    }
+    auto old_hdr = reinterpret_cast<IxHashBucketHdr *>(old_page->get_data());
+    int local_depth = old_hdr->local_depth;
+    if (local_depth == file_hdr_.global_depth_) {
+        if (file_hdr_.global_depth_ == IX_HASH_MAX_GLOBAL_DEPTH) {
+            buffer_pool_manager_->unpin_page(old_id, false);
+            throw InternalError("IxHashIndexHandle::split_bucket: hash directory is full");
+        }
+        grow_directory();
+    }
+
+    Page *new_page = create_page();
+    auto new_hdr = reinterpret_cast<IxHashBucketHdr *>(new_page->get_data());
+    old_hdr->local_depth = local_depth + 1;
+    new_hdr->local_depth = local_depth + 1;
+    new_hdr->num_entries = 0;
+    int entry_len = file_hdr_.col_tot_len_ + sizeof(Rid);
+    int num_kept = 0;
+    for (int i = 0; i < old_hdr->num_entries; i++) {
+        char *entry = get_entry(old_page->get_data(), i);
+        if ((hash_key(entry) >> local_depth) & 1) {
+            memcpy(get_entry(new_page->get_data(), new_hdr->num_entries++), entry, entry_len);
+        } else {
+            if (num_kept != i) {
+                memcpy(get_entry(old_page->get_data(), num_kept), entry, entry_len);
+            }
+            num_kept++;
+        }
+    }
+    old_hdr->num_entries = num_kept;
+
+    // 原来指向旧桶的目录项的低local_depth位都相同，其中第local_depth位为1的改为指向新桶
+    uint64_t step = 1ull << (local_depth + 1);
+    uint64_t first = (hash & ((1ull << local_depth) - 1)) | (1ull << local_depth);
+    for (uint64_t dir_idx = first; dir_idx < (1ull << file_hdr_.global_depth_); dir_idx += step) {
+        set_dir_entry(static_cast<int>(dir_idx), new_page->get_page_id().page_no);
+    }
+    buffer_pool_manager_->unpin_page(new_page->get_page_id(), true);
+    buffer_pool_manager_->unpin_page(old_id, true);
+}
+
+/**
+ * @brief 用于删除哈希索引中含有指定key的键值对
+ *
+ * @return 是否删除成功
+ */
+bool IxHashIndexHandle::delete_entry(const char *key, Transaction *transaction) {
+    std::shared_lock<std::shared_mutex> lock(dir_latch_);
+    PageId page_id = {.fd = fd_, .page_no = get_bucket_page_no(hash_key(key))};
+    Page *page = buffer_pool_manager_->fetch_page(page_id);
+    if (page == nullptr) {
+        throw InternalError("IxHashIndexHandle::delete_entry: buffer pool is full");
+    }
+    page->wlatch();
+    char *bucket = page->get_data();
+    auto hdr = reinterpret_cast<IxHashBucketHdr *>(bucket);
+    int pos = find_in_bucket(bucket, key);
+    if (pos != -1) {
+        // 桶内键值对无序，用最后一个键值对填补空位
+        hdr->num_entries--;
+        if (pos != hdr->num_entries) {
+            memcpy(get_entry(bucket, pos), get_entry(bucket, hdr->num_entries), file_hdr_.col_tot_len_ + sizeof(Rid));
+        }
+    }
+    page->wunlatch();
+    buffer_pool_manager_->unpin_page(page_id, pos != -1);
+    return pos != -1;
+}
@@ -0,0 +1,138 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <shared_mutex>
+#include <vector>
+
+#include "ix_defs.h"
+#include "transaction/transaction.h"
+
+// 可扩展哈希索引的文件布局：第0页为文件头，其后是目录页和桶页
+constexpr int IX_HASH_FILE_HDR_PAGE = 0;
+constexpr int IX_HASH_INIT_DIR_PAGE = 1;
+constexpr int IX_HASH_INIT_BUCKET_PAGE = 2;
+constexpr int IX_HASH_INIT_NUM_PAGES = 3;
+constexpr int IX_HASH_DIR_ENTRIES_PER_PAGE = PAGE_SIZE / sizeof(page_id_t);  // 每个目录页存放的桶页号数量
+constexpr int IX_HASH_MAX_GLOBAL_DEPTH = 19;                                 // 目录最多 2^19 项，即512个目录页
+
+/**
+ * @brief 哈希索引的文件头，打开索引时读入内存，关闭索引时写回第0页
+ * 目录的每一项是一个桶页号，目录按顺序存放在dir_pages_中的各个目录页里
+ */
+class IxHashFileHdr {
+   public:
+    int num_pages_;                     // 磁盘文件中页面的数量
+    int global_depth_;                  // 目录大小为 2^global_depth
+    int col_num_;                       // 索引包含的字段数量
+    std::vector<ColType> col_types_;    // 字段的类型
+    std::vector<int> col_lens_;         // 字段的长度
+    int col_tot_len_;                   // 索引包含的字段的总长度
+    int bucket_capacity_;               // 每个桶最多存放的键值对数量
+    std::vector<page_id_t> dir_pages_;  // 目录页的页号
+
+    int get_tot_len() const {
+        return sizeof(int) * 6 + (sizeof(ColType) + sizeof(int)) * col_num_ + sizeof(page_id_t) * dir_pages_.size();
+    }
+
+    void serialize(char *dest) const {
+        int offset = 0;
+        auto put = [&](const void *src, size_t len) {
+            memcpy(dest + offset, src, len);
+            offset += len;
+        };
+        int num_dir_pages = static_cast<int>(dir_pages_.size());
+        put(&num_pages_, sizeof(int));
+        put(&global_depth_, sizeof(int));
+        put(&col_num_, sizeof(int));
+        put(col_types_.data(), sizeof(ColType) * col_num_);
+        put(col_lens_.data(), sizeof(int) * col_num_);
+        put(&col_tot_len_, sizeof(int));
+        put(&bucket_capacity_, sizeof(int));
+        put(&num_dir_pages, sizeof(int));
+        put(dir_pages_.data(), sizeof(page_id_t) * num_dir_pages);
+        assert(offset == get_tot_len());
+    }
+
+    void deserialize(const char *src) {
+        int offset = 0;
+        auto get = [&](void *dst, size_t len) {
+            memcpy(dst, src + offset, len);
+            offset += len;
+        };
+        int num_dir_pages;
+        get(&num_pages_, sizeof(int));
+        get(&global_depth_, sizeof(int));
+        get(&col_num_, sizeof(int));
+        col_types_.resize(col_num_);
+        col_lens_.resize(col_num_);
+        get(col_types_.data(), sizeof(ColType) * col_num_);
+        get(col_lens_.data(), sizeof(int) * col_num_);
+        get(&col_tot_len_, sizeof(int));
+        get(&bucket_capacity_, sizeof(int));
+        get(&num_dir_pages, sizeof(int));
+        dir_pages_.resize(num_dir_pages);
+        get(dir_pages_.data(), sizeof(page_id_t) * num_dir_pages);
+    }
+};
+
+/* 桶页的页头，其后依次存放 num_entries 个 key | rid */
+struct IxHashBucketHdr {
+    int local_depth;  // 指向该桶的目录项的哈希值低local_depth位相同
+    int num_entries;
+};
+
+/**
+ * @description: 磁盘上的可扩展哈希索引，只支持等值查找
+ * 目录页和桶页都通过缓冲池访问；桶满时只分裂这一个桶，必要时目录加倍
+ * key不允许重复，与IxIndexHandle的行为一致；删除不合并桶
+ */
+class IxHashIndexHandle {
+    friend class IxManager;
+
+   private:
+    DiskManager *disk_manager_;
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;
+    IxHashFileHdr file_hdr_;
+    // 查找、不引起分裂的插入和删除持有读锁，只对桶页加latch；分裂桶和扩展目录时持有写锁
+    std::shared_mutex dir_latch_;
+
+   public:
+    IxHashIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
+
+    bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
+
+    page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
+
+    bool delete_entry(const char *key, Transaction *transaction);
+
+    int get_global_depth() const { return file_hdr_.global_depth_; }
+
+   private:
+    uint64_t hash_key(const char *key) const;
+
+    page_id_t get_bucket_page_no(uint64_t hash);
+
+    void set_dir_entry(int dir_idx, page_id_t bucket_page_no);
+
+    Page *create_page();
+
+    void grow_directory();
+
+    void split_bucket(uint64_t hash);
+
+    int find_in_bucket(const char *bucket, const char *key) const;
+
+    char *get_entry(char *bucket, int idx) const {
+        return bucket + sizeof(IxHashBucketHdr) + idx * (file_hdr_.col_tot_len_ + sizeof(Rid));
+    }
+};
@@ -10,8 +10,191 @@ See the Mulan PSL v2 for more details. */
 
 #include "ix_index_handle.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 #include "ix_scan.h"
 
+namespace {
+
+constexpr int IX_SIMD_WINDOW = 64;  // 二分查找把区间缩小到该长度后，改为对区间内的key直接计数
+
+/**
+ * @brief 读取按大端存放的规范化key，转换为本机字节序的无符号整数，其大小关系与key的memcmp结果一致
+ * 单列4字节（INT、FLOAT）和两列数值（如INT+INT）的key分别按uint32_t、uint64_t读取
+ */
+template <typename Word>
+inline Word load_key(const char *key) {
+    Word word;
+    memcpy(&word, key, sizeof(Word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if constexpr (sizeof(Word) == 4) {
+        word = __builtin_bswap32(word);
+    } else {
+        word = __builtin_bswap64(word);
+    }
+#endif
+    return word;
+}
+
+/**
+ * @brief 统计keys[0,n)中小于target（upper为true时为小于等于）的key的数量，无分支，便于编译器向量化
+ */
+template <typename Word>
+int count_bound_scalar(const char *keys, int n, Word target, bool upper) {
+    int cnt = 0;
+    if (upper) {
+        for (int i = 0; i < n; i++) cnt += load_key<Word>(keys + i * sizeof(Word)) <= target;
+    } else {
+        for (int i = 0; i < n; i++) cnt += load_key<Word>(keys + i * sizeof(Word)) < target;
+    }
+    return cnt;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+bool cpu_has_avx2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+
+__attribute__((target("avx2"))) int count_bound_avx2(const char *keys, int n, uint32_t target, bool upper) {
+    // 每个32位lane内翻转字节序，再把符号位取反，使无符号比较可以用有符号的cmpgt完成
+    const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+    __m256i t = _mm256_set1_epi32(static_cast<int>(target ^ 0x80000000u));
+    int cnt = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i * 4));
+        k = _mm256_xor_si256(_mm256_shuffle_epi8(k, bswap), sign);
+        // lower: key < target 即 target > key；upper: key <= target 即 !(key > target)
+        __m256i gt = upper ? _mm256_cmpgt_epi32(k, t) : _mm256_cmpgt_epi32(t, k);
+        int bits = __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(gt)));
+        cnt += upper ? 8 - bits : bits;
+    }
+    return cnt + count_bound_scalar<uint32_t>(keys + i * 4, n - i, target, upper);
+}
+#endif
+
+template <typename Word>
+int count_bound(const char *keys, int n, Word target, bool upper) {
+#if defined(__x86_64__) || defined(__i386__)
+    if constexpr (sizeof(Word) == 4) {
+        if (cpu_has_avx2()) {
+            return count_bound_avx2(keys, n, target, upper);
+        }
+    }
+#endif
+    return count_bound_scalar<Word>(keys, n, target, upper);
+}
+
+/**
+ * @brief 在有序的定长整数key数组keys[lo,hi)中查找第一个>=target（upper为true时为>target）的位置
+ * 先二分查找把区间缩小到IX_SIMD_WINDOW以内，再对剩余区间计数
+ */
+template <typename Word>
+int search_bound(const char *keys, int lo, int hi, const char *target_key, bool upper) {
+    Word target = load_key<Word>(target_key);
+    while (hi - lo > IX_SIMD_WINDOW) {
+        int mid = lo + (hi - lo) / 2;
+        Word key = load_key<Word>(keys + mid * sizeof(Word));
+        bool go_right = upper ? key <= target : key < target;
+        if (go_right) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo + count_bound<Word>(keys + lo * sizeof(Word), hi - lo, target, upper);
+}
+
+/**
+ * @brief 其他定长的key：逐个memcmp，key_len为完整key的长度
+ */
+int search_bound_generic(const char *keys, int key_len, int lo, int hi, const char *target, bool upper) {
+    if (!binary_search) {
+        while (lo < hi) {
+            int cmp = memcmp(keys + lo * key_len, target, key_len);
+            if (upper ? cmp > 0 : cmp >= 0) {
+                break;
+            }
+            lo++;
+        }
+        return lo;
+    }
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = memcmp(keys + mid * key_len, target, key_len);
+        if (upper ? cmp <= 0 : cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+template <typename Word>
+int compare_words(const char *a, const char *b) {
+    Word x = load_key<Word>(a);
+    Word y = load_key<Word>(b);
+    return (x > y) - (x < y);
+}
+
+}  // namespace
+
+/**
+ * @brief 未压缩结点的结点内查找，按IxFileHdr::key_search_分派到针对该key形状特化的实现，
+ * 每次查找只分派一次，查找过程中的比较都是内联的整数比较
+ *
+ * @param lo, hi 查找区间[lo,hi)
+ * @param upper 为true时查找第一个>target的位置，否则查找第一个>=target的位置
+ */
+int IxNodeHandle::typed_bound(const char *target, int lo, int hi, bool upper) const {
+    switch (file_hdr->key_search_) {
+        case IX_SEARCH_UINT32:
+            return search_bound<uint32_t>(get_key(0), lo, hi, target, upper);
+        case IX_SEARCH_UINT64:
+            return search_bound<uint64_t>(get_key(0), lo, hi, target, upper);
+        default:
+            return search_bound_generic(get_key(0), file_hdr->col_tot_len_, lo, hi, target, upper);
+    }
+}
+
+/**
+ * @brief 压缩结点的结点内查找：先用公共前缀与target比较一次，再在[lo,hi)中只比较各key存放的部分
+ *
+ * @param upper 为true时查找第一个>target的位置，否则查找第一个>=target的位置
+ */
+int IxNodeHandle::compressed_bound(const char *target, int lo, int hi, bool upper) const {
+    int prefix_len = get_prefix_len();
+    int key_len = get_key_len();
+    int res = memcmp(get_prefix(), target, prefix_len);
+    if (res != 0) {
+        // 区间内所有key与target的大小关系都相同
+        return res < 0 ? hi : lo;
+    }
+    const char *suffix = target + prefix_len;
+    // 各key省略的末尾部分都是0，target在这部分中有非0字节时，存放部分相同的key也小于target
+    int tail_len = file_hdr->col_tot_len_ - prefix_len - key_len;
+    bool tail_nonzero = ix_significant_len(suffix + key_len, tail_len) > 0;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = memcmp(get_key(mid), suffix, key_len);
+        if (cmp == 0 && tail_nonzero) {
+            cmp = -1;
+        }
+        if (upper ? cmp <= 0 : cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
 /**
  * @brief 在当前node中查找第一个>=target的key_idx
  *
@@ -19,25 +202,259 @@ See the Mulan PSL v2 for more details. */
  * @note 返回key index（同时也是rid index），作为slot no
  */
 int IxNodeHandle::lower_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于等于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式，如顺序遍历、二分查找等；使用ix_compare()函数进行比较
-
-    return -1;
+    int lo = 0;
+    int hi = page_hdr->num_key;
+    if (is_compressed()) {
+        // 压缩的内部结点中第0个key无意义
+        return compressed_bound(target, is_leaf_page() ? 0 : std::min(1, hi), hi, false);
+    }
+    return typed_bound(target, lo, hi, false);
 }
 
 /**
  * @brief 在当前node中查找第一个>target的key_idx
  *
- * @return key_idx，范围为[1,num_key)，如果返回的key_idx=num_key，则表示target大于等于最后一个key
- * @note 注意此处的范围从1开始
+ * @return key_idx，内部结点的范围为[1,num_key)，如果返回的key_idx=num_key，则表示target大于等于最后一个key
+ * @note 内部结点的范围从1开始，因为第0个key是第0棵子树中最小的key，target小于它时也应进入第0棵子树；
+ * 叶子结点的范围从0开始
  */
 int IxNodeHandle::upper_bound(const char *target) const {
-    // Todo:
-    // 查找当前节点中第一个大于target的key，并返回key的位置给上层
-    // 提示: 可以采用多种查找方式：顺序遍历、二分查找等；使用ix_compare()函数进行比较
+    int lo = page_hdr->is_leaf ? 0 : 1;
+    int hi = page_hdr->num_key;
+    if (lo >= hi) {
+        return hi;
+    }
+    if (is_compressed()) {
+        return compressed_bound(target, lo, hi, true);
+    }
+    return typed_bound(target, lo, hi, true);
+}
+
+/**
+ * @brief 将第key_idx个完整的key（补齐公共前缀和末尾的0）写入dst
+ */
+void IxNodeHandle::get_full_key(int key_idx, char *dst) const {
+    int prefix_len = get_prefix_len();
+    int key_len = get_key_len();
+    memcpy(dst, get_prefix(), prefix_len);
+    memcpy(dst + prefix_len, get_key(key_idx), key_len);
+    memset(dst + prefix_len + key_len, 0, file_hdr->col_tot_len_ - prefix_len - key_len);
+}
+
+/**
+ * @brief 比较第key_idx个key与完整的key target
+ * @return 小于、等于、大于时分别返回负数、0、正数
+ */
+int IxNodeHandle::compare_key(int key_idx, const char *target) const {
+    if (!is_compressed()) {
+        switch (file_hdr->key_search_) {
+            case IX_SEARCH_UINT32:
+                return compare_words<uint32_t>(get_key(key_idx), target);
+            case IX_SEARCH_UINT64:
+                return compare_words<uint64_t>(get_key(key_idx), target);
+            default:
+                return memcmp(get_key(key_idx), target, file_hdr->col_tot_len_);
+        }
+    }
+    int prefix_len = get_prefix_len();
+    int key_len = get_key_len();
+    int res = memcmp(get_prefix(), target, prefix_len);
+    if (res == 0) {
+        res = memcmp(get_key(key_idx), target + prefix_len, key_len);
+    }
+    if (res == 0) {
+        int offset = prefix_len + key_len;
+        res = ix_significant_len(target + offset, file_hdr->col_tot_len_ - offset) > 0 ? -1 : 0;
+    }
+    return res;
+}
+
+/**
+ * @brief 将结点中所有的键值对解码为完整的key和rid，追加到keys和rids的末尾
+ */
+void IxNodeHandle::get_entries(std::vector<char> *keys, std::vector<Rid> *rids) const {
+    int len = file_hdr->col_tot_len_;
+    int size = get_size();
+    size_t offset = keys->size();
+    keys->resize(offset + static_cast<size_t>(size) * len);
+    for (int i = 0; i < size; i++) {
+        get_full_key(i, keys->data() + offset + static_cast<size_t>(i) * len);
+        rids->push_back(*get_rid(i));
+    }
+}
+
+namespace {
+
+/**
+ * @brief 计算有序的完整key数组keys[0,n)压缩之后的公共前缀长度和每个key存放的字节数
+ * @param first 从第first个key开始参与计算（压缩的内部结点为1）
+ */
+void compute_layout(const char *keys, int n, int first, int len, int *prefix_len, int *key_len) {
+    if (first >= n) {
+        *prefix_len = *key_len = 0;
+        return;
+    }
+    // keys有序，因此首尾两个key的公共前缀就是所有key的公共前缀
+    int lcp = ix_common_prefix(keys + first * len, keys + (n - 1) * len, len);
+    int max_len = 0;
+    for (int i = first; i < n; i++) {
+        max_len = std::max(max_len, ix_significant_len(keys + i * len, len));
+    }
+    *prefix_len = std::min(lcp, max_len);
+    *key_len = max_len - *prefix_len;
+}
+
+}  // namespace
+
+/**
+ * @brief 有序的完整key数组keys[0,n)按当前结点的格式编码之后占用的字节数
+ */
+int IxNodeHandle::encoded_bytes(const char *keys, int n) const {
+    int prefix_len = 0;
+    int key_len = file_hdr->col_tot_len_;
+    if (is_compressed()) {
+        compute_layout(keys, n, is_leaf_page() ? 0 : 1, file_hdr->col_tot_len_, &prefix_len, &key_len);
+    }
+    return prefix_len + n * (key_len + static_cast<int>(sizeof(Rid)));
+}
+
+/**
+ * @brief 用完整的key数组keys[0,n)和rids[0,n)重写结点中的所有键值对，压缩时重新计算公共前缀和key_len
+ * @note keys和rids不能指向当前结点的页面
+ */
+void IxNodeHandle::assign(const char *keys, const Rid *rids, int n) {
+    int len = file_hdr->col_tot_len_;
+    int prefix_len = 0;
+    int key_len = len;
+    if (is_compressed()) {
+        int first = is_leaf_page() ? 0 : 1;
+        compute_layout(keys, n, first, len, &prefix_len, &key_len);
+        if (first < n) {
+            memcpy(get_prefix(), keys + first * len, prefix_len);
+        }
+    }
+    page_hdr->prefix_len = static_cast<int16_t>(prefix_len);
+    page_hdr->key_len = static_cast<int16_t>(key_len);
+    assert(prefix_len + n * (key_len + static_cast<int>(sizeof(Rid))) <= usable_bytes(file_hdr));
+    for (int i = 0; i < n; i++) {
+        memcpy(get_key(i), keys + i * len + prefix_len, key_len);
+        set_rid(i, rids[i]);
+    }
+    set_size(n);
+}
+
+/**
+ * @brief 压缩结点中，key能否按当前的prefix_len和key_len直接存放
+ */
+bool IxNodeHandle::fits_in_place(const char *key) const {
+    int prefix_len = get_prefix_len();
+    return memcmp(get_prefix(), key, prefix_len) == 0 &&
+           ix_significant_len(key, file_hdr->col_tot_len_) <= prefix_len + get_key_len();
+}
+
+/**
+ * @brief 压缩结点在pos处插入key（replace为true时替换第pos个key）之后占用的字节数
+ * @note 替换key时沿用原来的最大长度，结果可能略大于实际值
+ */
+int IxNodeHandle::bytes_after(int pos, const char *key, bool replace) const {
+    int len = file_hdr->col_tot_len_;
+    int size = get_size();
+    int new_size = replace ? size : size + 1;
+    int first = is_leaf_page() ? 0 : 1;
+    assert(pos >= first);
+    int prefix_len = 0;
+    int key_len = 0;
+    if (first < new_size) {
+        // 插入之后参与计算的首尾两个key
+        std::vector<char> lo_key(len), hi_key(len);
+        if (pos == first) {
+            memcpy(lo_key.data(), key, len);
+        } else {
+            get_full_key(first, lo_key.data());
+        }
+        if (pos == new_size - 1) {
+            memcpy(hi_key.data(), key, len);
+        } else {
+            get_full_key(size - 1, hi_key.data());
+        }
+        int max_len = ix_significant_len(key, len);
+        if (size > first) {
+            max_len = std::max(max_len, get_prefix_len() + get_key_len());
+        }
+        prefix_len = std::min(ix_common_prefix(lo_key.data(), hi_key.data(), len), max_len);
+        key_len = max_len - prefix_len;
+    }
+    return prefix_len + new_size * (key_len + static_cast<int>(sizeof(Rid)));
+}
+
+/**
+ * @brief 能否在pos处插入key而不需要分裂
+ */
+bool IxNodeHandle::can_insert(int pos, const char *key) const {
+    if (get_size() + 1 > file_hdr->btree_order_) {
+        return false;
+    }
+    if (!is_compressed()) {
+        return true;
+    }
+    if (fits_in_place(key)) {
+        return get_used_bytes() + get_key_len() + static_cast<int>(sizeof(Rid)) <= usable_bytes(file_hdr);
+    }
+    return bytes_after(pos, key, false) <= usable_bytes(file_hdr);
+}
+
+/**
+ * @brief 能否将第key_idx个key替换为key而不需要分裂
+ */
+bool IxNodeHandle::can_set_key(int key_idx, const char *key) const {
+    return !is_compressed() || fits_in_place(key) || bytes_after(key_idx, key, true) <= usable_bytes(file_hdr);
+}
+
+/**
+ * @brief 压缩的内部结点：路由key所在的孩子分裂（最多分裂为3个结点）之后，本结点能否容纳新插入的两个分隔key
+ * @note 分隔key的内容事先未知，按最坏情况估计：孩子两侧的分隔key都存在时，新的分隔key一定共享本结点的公共前缀，
+ * 否则公共前缀可能变为空；每个key都可能存放到最大长度
+ */
+bool IxNodeHandle::can_absorb_split(const char *key) const {
+    int size = get_size();
+    if (size + 2 > file_hdr->btree_order_) {
+        return false;
+    }
+    int child_idx = upper_bound(key) - 1;
+    int prefix_len = (child_idx >= 1 && child_idx + 1 < size) ? get_prefix_len() : 0;
+    int key_len = file_hdr->col_tot_len_ - prefix_len;
+    return prefix_len + (size + 2) * (key_len + static_cast<int>(sizeof(Rid))) <= usable_bytes(file_hdr);
+}
+
+/**
+ * @brief 删除num_removed个键值对之后结点是否过空，需要合并或重分配
+ * 未压缩时按键值对数量判断，压缩时按占用的字节数判断
+ */
+bool IxNodeHandle::is_underflow(int num_removed) const {
+    if (!is_compressed()) {
+        return get_size() - num_removed < get_min_size();
+    }
+    int entry_bytes = get_key_len() + static_cast<int>(sizeof(Rid));
+    return get_used_bytes() - num_removed * entry_bytes < usable_bytes(file_hdr) / 4;  // 压缩结点占用的字节数低于可用空间的1/4时需要合并或重分配
+}
 
-    return -1;
+/**
+ * @brief 将第key_idx个key替换为完整的key；压缩时若无法按当前格式存放，则重新编码整个结点
+ */
+void IxNodeHandle::set_key(int key_idx, const char *key) {
+    if (!is_compressed()) {
+        memcpy(get_key(key_idx), key, file_hdr->col_tot_len_);
+        return;
+    }
+    if (fits_in_place(key)) {
+        memcpy(get_key(key_idx), key + get_prefix_len(), get_key_len());
+        return;
+    }
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    get_entries(&keys, &rids);
+    memcpy(keys.data() + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_);
+    assign(keys.data(), rids.data(), get_size());
 }
 
 /**
@@ -49,13 +466,12 @@ int IxNodeHandle::upper_bound(const char *target) const {
  * @return 目标key是否存在
  */
 bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
-    // Todo:
-    // 1. 在叶子节点中获取目标key所在位置
-    // 2. 判断目标key是否存在
-    // 3. 如果存在，获取key对应的Rid，并赋值给传出参数value
-    // 提示：可以调用lower_bound()和get_rid()函数。
-
-    return false;
+    int pos = lower_bound(key);
+    if (pos == get_size() || compare_key(pos, key) != 0) {
+        return false;
+    }
+    *value = get_rid(pos);
+    return true;
 }
 
 /**
@@ -64,35 +480,45 @@ bool IxNodeHandle::leaf_lookup(const char *key, Rid **value) {
  * @return page_id_t 目标key所在的孩子节点（子树）的存储页面编号
  */
 page_id_t IxNodeHandle::internal_lookup(const char *key) {
-    // Todo:
-    // 1. 查找当前非叶子节点中目标key所在孩子节点（子树）的位置
-    // 2. 获取该孩子节点（子树）所在页面的编号
-    // 3. 返回页面编号
-
-    return -1;
+    // 第一个>key的位置的前一个孩子即为key所在的子树
+    return value_at(upper_bound(key) - 1);
 }
 
 /**
- * @brief 在指定位置插入n个连续的键值对
- * 将key的前n位插入到原来keys中的pos位置；将rid的前n位插入到原来rids中的pos位置
+ * @brief 在指定位置插入单个键值对，调用者需保证can_insert(pos, key)
+ * 压缩时若key无法按当前的公共前缀和key_len存放，则解码整个结点后重新编码
  *
  * @param pos 要插入键值对的位置
- * @param (key, rid) 连续键值对的起始地址，也就是第一个键值对，可以通过(key, rid)来获取n个键值对
- * @param n 键值对数量
+ * @param (key, rid) 要插入的键值对，key为完整的key
  * @note [0,pos)           [pos,num_key)
  *                            key_slot
  *                            /      \
  *                           /        \
- *       [0,pos)     [pos,pos+n)   [pos+n,num_key+n)
+ *       [0,pos)     [pos,pos+1)   [pos+1,num_key+1)
  *                      key           key_slot
  */
-void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n) {
-    // Todo:
-    // 1. 判断pos的合法性
-    // 2. 通过key获取n个连续键值对的key值，并把n个key值插入到pos位置
-    // 3. 通过rid获取n个连续键值对的rid值，并把n个rid值插入到pos位置
-    // 4. 更新当前节点的键数量
-
+void IxNodeHandle::insert_pair(int pos, const char *key, const Rid &rid) {
+    int size = get_size();
+    assert(pos >= 0 && pos <= size);
+    if (is_compressed() && !fits_in_place(key)) {
+        std::vector<char> keys;
+        std::vector<Rid> rids;
+        get_entries(&keys, &rids);
+        int len = file_hdr->col_tot_len_;
+        keys.insert(keys.begin() + pos * len, key, key + len);
+        rids.insert(rids.begin() + pos, rid);
+        assign(keys.data(), rids.data(), size + 1);
+        return;
+    }
+    int prefix_len = get_prefix_len();
+    int key_len = get_key_len();
+    assert(get_used_bytes() + key_len + static_cast<int>(sizeof(Rid)) <= usable_bytes(file_hdr));
+    memmove(get_key(pos + 1), get_key(pos), (size - pos) * key_len);
+    memcpy(get_key(pos), key + prefix_len, key_len);
+    // rid从页面末尾向前存放，[pos,size)在内存中的起始地址是get_rid(size - 1)
+    memmove(get_rid(size), get_rid(size - 1), (size - pos) * sizeof(Rid));
+    set_rid(pos, rid);
+    set_size(size + 1);
 }
 
 /**
@@ -103,26 +529,27 @@ void IxNodeHandle::insert_pairs(int pos, const char *key, const Rid *rid, int n)
  * @return int 键值对数量
  */
 int IxNodeHandle::insert(const char *key, const Rid &value) {
-    // Todo:
-    // 1. 查找要插入的键值对应该插入到当前节点的哪个位置
-    // 2. 如果key重复则不插入
-    // 3. 如果key不重复则插入键值对
-    // 4. 返回完成插入操作之后的键值对数量
-
-    return -1;
+    int pos = lower_bound(key);
+    if (pos < get_size() && compare_key(pos, key) == 0) {
+        return get_size();  // key重复则不插入
+    }
+    insert_pair(pos, key, value);
+    return get_size();
 }
 
 /**
  * @brief 用于在结点中的指定位置删除单个键值对
+ * 剩余的key仍满足原来的公共前缀和key_len，不需要重新编码
  *
  * @param pos 要删除键值对的位置
  */
 void IxNodeHandle::erase_pair(int pos) {
-    // Todo:
-    // 1. 删除该位置的key
-    // 2. 删除该位置的rid
-    // 3. 更新结点的键值对数量
-
+    int size = get_size();
+    assert(pos >= 0 && pos < size);
+    int key_len = get_key_len();
+    memmove(get_key(pos), get_key(pos + 1), (size - pos - 1) * key_len);
+    memmove(get_rid(size - 2), get_rid(size - 1), (size - pos - 1) * sizeof(Rid));
+    set_size(size - 1);
 }
 
 /**
@@ -132,27 +559,153 @@ void IxNodeHandle::erase_pair(int pos) {
  * @return 完成删除操作后的键值对数量
  */
 int IxNodeHandle::remove(const char *key) {
-    // Todo:
-    // 1. 查找要删除键值对的位置
-    // 2. 如果要删除的键值对存在，删除键值对
-    // 3. 返回完成删除操作后的键值对数量
-
-    return -1;
+    int pos = lower_bound(key);
+    if (pos < get_size() && compare_key(pos, key) == 0) {
+        erase_pair(pos);
+    }
+    return get_size();
 }
 
 IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
     : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
     // init file_hdr_
-    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
     char* buf = new char[PAGE_SIZE];
     memset(buf, 0, PAGE_SIZE);
     disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, PAGE_SIZE);
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
-    
+    delete[] buf;
+
     // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
-    int now_page_no = disk_manager_->get_fd2pageno(fd);
-    disk_manager_->set_fd2pageno(fd, now_page_no + 1);
+    disk_manager_->set_fd2pageno(fd, file_hdr_->num_pages_);
+}
+
+/**
+ * @brief 按B-link树的方式查找指定键所在的叶子结点：任意时刻只持有一个结点的锁，不做锁耦合
+ * 从父结点读到孩子的页面号之后立即释放父结点，期间孩子可能被并发地分裂或合并：
+ * key不小于结点的high key时沿右兄弟指针向右移动；结点已被删除时从根结点重新开始。
+ * 结构修改只会把key移到右边（分裂、向右重分配）或把右结点合并到左结点并标记删除，因此这样总能找到正确的叶子
+ *
+ * @param key 要查找的目标key值
+ * @param find_first 为true时查找第一个叶子结点
+ * @param exclusive 为true时对叶子结点加写锁（乐观的插入和删除），否则加读锁
+ * @param path 不为nullptr时，从path中最后一个结点（为空时从根结点）开始下降，并把经过的内部结点追加到path中
+ * @return 加了锁并且pin住的叶子结点
+ */
+IxNodeHandle *IxIndexHandle::find_leaf_page_blink(const char *key, bool find_first, bool exclusive,
+                                                  std::vector<IxPathEntry> *path) {
+    page_id_t page_no = get_root_page_no();
+    if (path != nullptr && !path->empty()) {
+        page_no = path->back().page_no;
+        path->pop_back();
+    }
+    while (true) {
+        IxNodeHandle *node = fetch_node(page_no);
+        // 结点是否为叶子结点在其生命周期内不会改变；本操作开始之后被删除的结点要等本操作结束
+        // 才进入空闲页面链表（IxOpGuard），本操作期间page_no不会被重用为另一个结点，可以在加锁前读取
+        bool latch_exclusive = exclusive && node->is_leaf_page();
+        latch_exclusive ? node->page->wlatch() : node->page->rlatch();
+        if (node->is_deleted()) {
+            page_no = get_root_page_no();
+            if (path != nullptr) {
+                path->clear();
+            }
+        } else if (!find_first && node->beyond_high_key(key)) {
+            page_no = node->get_next_leaf();
+        } else if (node->is_leaf_page()) {
+            return node;
+        } else {
+            if (path != nullptr) {
+                const char *high_key = node->get_high_key();
+                path->push_back({node->get_page_no(), node->has_high_key(),
+                                 std::vector<char>(high_key, high_key + file_hdr_->col_tot_len_)});
+            }
+            page_no = find_first ? node->value_at(0) : node->internal_lookup(key);
+        }
+        latch_exclusive ? node->page->wunlatch() : node->page->runlatch();
+        unpin_node(node, false);
+        delete node;
+    }
+}
+
+/**
+ * @brief 自增key的插入总是追加在最右叶子结点的末尾：若append_leaf_仍是最右叶子结点，且key大于其中所有的key，
+ * 直接返回该叶子结点（加写锁），不必从根结点下降
+ * @return 不满足条件时返回nullptr，并清除append_leaf_
+ * @note append_leaf_可能已经过期（被拆分或合并），加锁之后再确认；最右叶子结点覆盖大于其分隔key的所有key，
+ * key大于其中已有的key时一定属于该结点
+ */
+IxNodeHandle *IxIndexHandle::find_append_leaf(const char *key) {
+    page_id_t page_no = append_leaf_.load(std::memory_order_relaxed);
+    if (page_no == IX_NO_PAGE) {
+        return nullptr;
+    }
+    IxNodeHandle *leaf = fetch_node(page_no);
+    leaf->page->wlatch();
+    if (!leaf->is_deleted() && leaf->is_leaf_page() && !leaf->has_high_key() && leaf->get_size() > 0 &&
+        leaf->compare_key(leaf->get_size() - 1, key) < 0) {
+        return leaf;
+    }
+    leaf->page->wunlatch();
+    unpin_node(leaf, false);
+    delete leaf;
+    append_leaf_.store(IX_NO_PAGE, std::memory_order_relaxed);
+    return nullptr;
+}
+
+/**
+ * @brief 判断在node上执行operation之后，是否不会影响到其祖先结点（不会分裂、合并或重分配）
+ * 若node是安全的，悲观路径可以释放node所有祖先结点的锁
+ * @note 父结点中的分隔key是孩子的下界，不必等于孩子的第一个key，因此不需要考虑第一个key的变化；
+ * 压缩的内部结点按孩子分裂时最坏的情况判断能否容纳新的分隔key
+ */
+bool IxIndexHandle::is_safe(IxNodeHandle *node, const char *key, Operation operation) {
+    bool compressed = node->is_compressed();
+    if (operation == Operation::INSERT) {
+        if (compressed) {
+            return node->is_leaf_page() ? node->can_insert(node->lower_bound(key), key) : node->can_absorb_split(key);
+        }
+        return node->get_size() + 1 < node->get_max_size();
+    }
+    if (operation == Operation::DELETE) {
+        if (node->is_root_page()) {
+            // 叶子根结点允许为空；内部根结点只剩一个孩子时需要调整根结点
+            return node->is_leaf_page() || node->get_size() > 2;
+        }
+        return !node->is_underflow(1);
+    }
+    return true;
+}
+
+/**
+ * @brief 释放事务中除最后一个结点以外的所有已加写锁的结点（即当前结点的祖先），以及root_latch_
+ */
+void IxIndexHandle::release_ancestors(Transaction *transaction, bool *root_is_latched) {
+    auto latch_page_set = transaction->get_index_latch_page_set();
+    while (latch_page_set->size() > 1) {
+        Page *page = latch_page_set->front();
+        latch_page_set->pop_front();
+        page->wunlatch();
+        unpin_page(page, false);
+    }
+    if (*root_is_latched) {
+        root_latch_.unlock();
+        *root_is_latched = false;
+    }
+}
+
+/**
+ * @brief 悲观路径结束时，释放事务中所有加了写锁的结点
+ * @note 被合并掉的结点只标记为已删除并随其他结点一起写回，不从缓冲池中删除：
+ * 不做锁耦合的查找可能在读到父结点之后才访问它，需要从中得知应当重新开始
+ */
+void IxIndexHandle::release_latched_pages(Transaction *transaction) {
+    auto latch_page_set = transaction->get_index_latch_page_set();
+    for (Page *page : *latch_page_set) {
+        page->wunlatch();
+        unpin_page(page, true);
+    }
+    latch_page_set->clear();
 }
 
 /**
@@ -163,15 +716,37 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
  * @return [leaf node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
  * @note need to Unlatch and unpin the leaf node outside!
  * 注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
+ * FIND：按B-link树的方式查找（find_leaf_page_blink），不阻塞在结构修改上，返回加了读锁的叶子结点，
+ * 调用者负责runlatch、unpin和delete；
+ * INSERT/DELETE（悲观路径）：持有root_latch_并沿路径加写锁，遇到安全结点时释放其祖先，
+ * 所有加锁的结点记录在transaction的index_latch_page_set_中，由release_latched_pages统一释放，调用者只需delete返回的结点
  */
 std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,
                                                             Transaction *transaction, bool find_first) {
-    // Todo:
-    // 1. 获取根节点
-    // 2. 从根节点开始不断向下查找目标key
-    // 3. 找到包含该key值的叶子结点停止查找，并返回叶子节点
+    if (operation == Operation::FIND) {
+        return std::make_pair(find_leaf_page_blink(key, find_first, false), false);
+    }
 
-    return std::make_pair(nullptr, false);
+    // 悲观路径持有父结点的写锁时才给孩子加锁，孩子不会被并发地分裂或合并，因此不需要向右移动
+    root_latch_.lock();
+    bool root_is_latched = true;
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    node->page->wlatch();
+    transaction->append_index_latch_page_set(node->page);
+    if (is_safe(node, key, operation)) {
+        release_ancestors(transaction, &root_is_latched);
+    }
+    while (!node->is_leaf_page()) {
+        page_id_t child_page_no = find_first ? node->value_at(0) : node->internal_lookup(key);
+        delete node;
+        node = fetch_node(child_page_no);
+        node->page->wlatch();
+        transaction->append_index_latch_page_set(node->page);
+        if (is_safe(node, key, operation)) {
+            release_ancestors(transaction, &root_is_latched);
+        }
+    }
+    return std::make_pair(node, root_is_latched);
 }
 
 /**
@@ -183,85 +758,753 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
  * @return bool 返回目标键值对是否存在
  */
 bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
-    // Todo:
-    // 1. 获取目标key值所在的叶子结点
-    // 2. 在叶子节点中查找目标key值的位置，并读取key对应的rid
-    // 3. 把rid存入result参数中
-    // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
+    IxOpGuard guard(this);
+    char key_buf[IX_MAX_COL_LEN];
+    key = file_hdr_->encode_key(key, key_buf);
+    merge_encoded_changes(key, key, transaction);
+    return lookup_encoded(key, result);
+}
 
+/**
+ * @brief 与get_value的结果相同，但不合并key上暂存的修改，而是把它叠加在B+树的查找结果上
+ * 执行器插入和更新记录之前检查唯一性时使用，使暂存的修改不会因为检查而被立即合并
+ */
+bool IxIndexHandle::probe_value(const char *key, std::vector<Rid> *result, Transaction *transaction) {
+    if (change_buffer_ == nullptr) {
+        return get_value(key, result, transaction);
+    }
+    IxOpGuard guard(this);
+    char key_buf[IX_MAX_COL_LEN];
+    key = file_hdr_->encode_key(key, key_buf);
+    // 持有读锁期间暂存的修改不会被合并，B+树中该key的状态与暂存的修改一致
+    std::shared_lock<std::shared_mutex> lock(change_latch_);
+    const IxChangeBuffer::Change *change = change_buffer_->find(key);
+    if (change != nullptr && change->delete_first) {
+        if (change->has_insert) {
+            result->push_back(change->rid);
+        }
+        return change->has_insert;
+    }
+    if (lookup_encoded(key, result)) {
+        return true;
+    }
+    if (change != nullptr && change->has_insert) {
+        result->push_back(change->rid);
+        return true;
+    }
     return false;
 }
 
 /**
- * @brief  将传入的一个node拆分(Split)成两个结点，在node的右边生成一个新结点new node
- * @param node 需要拆分的结点
- * @return 拆分得到的new_node
- * @note need to unpin the new node outside
- * 注意：本函数执行完毕后，原node和new node都需要在函数外面进行unpin
+ * @brief 在B+树中查找规范化的key，不考虑暂存的修改
+ */
+bool IxIndexHandle::lookup_encoded(const char *key, std::vector<Rid> *result) {
+    if (!bloom_may_contain(key)) {
+        return false;
+    }
+    int slot_no;
+    IxNodeHandle *leaf = find_leaf_for_lookup(key, &slot_no);
+    bool found = slot_no < leaf->get_size() && leaf->compare_key(slot_no, key) == 0;
+    if (found) {
+        result->push_back(*leaf->get_rid(slot_no));
+    }
+    leaf->page->runlatch();
+    unpin_node(leaf, false);
+    delete leaf;
+    return found;
+}
+
+/**
+ * @brief 批量查找多个key：先把key排序，沿叶子结点依次处理，只有key超出当前叶子结点的范围时才回到
+ * 仍然覆盖该key的最低的祖先重新下降，路径上的内部结点由整批key分摊
+ *
+ * @param keys 要查找的key，各字段原始值拼接而成，不要求有序，可以重复
+ * @param[out] result 与keys一一对应的rid，key不存在时为{IX_NO_PAGE, -1}
+ * @return 找到的key的数量
+ * @note 同一时刻只持有一个叶子结点的读锁；记录的祖先可能已被并发地分裂或删除，下降时按B-link树的方式向右移动或重新开始
  */
-IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
-    // Todo:
-    // 1. 将原结点的键值对平均分配，右半部分分裂为新的右兄弟结点
-    //    需要初始化新节点的page_hdr内容
-    // 2. 如果新的右兄弟结点是叶子结点，更新新旧节点的prev_leaf和next_leaf指针
-    //    为新节点分配键值对，更新旧节点的键值对数记录
-    // 3. 如果新的右兄弟结点不是叶子结点，更新该结点的所有孩子结点的父节点信息(使用IxIndexHandle::maintain_child())
+size_t IxIndexHandle::get_values(const std::vector<const char *> &keys, std::vector<Rid> *result,
+                                 Transaction *transaction) {
+    IxOpGuard guard(this);
+    int len = file_hdr_->col_tot_len_;
+    size_t n = keys.size();
+    std::vector<char> encoded(n * len);
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; i++) {
+        file_hdr_->encode_key(keys[i], encoded.data() + i * len);
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return memcmp(encoded.data() + a * len, encoded.data() + b * len, len) < 0;
+    });
+    for (size_t idx : order) {
+        merge_encoded_changes(encoded.data() + idx * len, encoded.data() + idx * len, transaction);
+    }
 
+    result->assign(n, Rid{IX_NO_PAGE, -1});
+    size_t num_found = 0;
+    std::vector<IxPathEntry> path;
+    IxNodeHandle *leaf = nullptr;
+    auto release_leaf = [&]() {
+        leaf->page->runlatch();
+        unpin_node(leaf, false);
+        delete leaf;
+        leaf = nullptr;
+    };
+    for (size_t idx : order) {
+        const char *key = encoded.data() + idx * len;
+        if (!bloom_may_contain(key)) {
+            continue;
+        }
+        if (leaf != nullptr && leaf->beyond_high_key(key)) {
+            release_leaf();
+            while (!path.empty() && path.back().has_high_key && memcmp(path.back().high_key.data(), key, len) <= 0) {
+                path.pop_back();
+            }
+        }
+        if (leaf == nullptr) {
+            leaf = find_leaf_page_blink(key, false, false, &path);
+        }
+        Rid *rid;
+        if (leaf->leaf_lookup(key, &rid)) {
+            (*result)[idx] = *rid;
+            num_found++;
+        }
+    }
+    if (leaf != nullptr) {
+        release_leaf();
+    }
+    return num_found;
+}
+
+/**
+ * @brief 在自适应哈希索引中查找规范化的key，并在叶子结点的读锁下核对其位置
+ * @param[out] slot_no key在叶子结点中的位置
+ * @return 加了读锁并且pin住的叶子结点；key没有哈希项或哈希项已失效时返回nullptr
+ * @note 哈希项指向的页面可能已被删除并重用：create_node在页面写锁下清空重用的页面并把版本号加一，
+ * 同一个页面上的版本号只增不减。因此结点未被删除、仍是叶子且版本号与建立哈希项时相同，
+ * 说明它仍是建立哈希项时的叶子结点，且之后键值对没有移动，slot_no处仍是该key
+ */
+IxNodeHandle *IxIndexHandle::find_hashed_key(const char *key, int *slot_no) {
+    IxAdaptiveHash::Entry entry;
+    if (!adaptive_hash_.lookup(key, file_hdr_->col_tot_len_, &entry)) {
+        return nullptr;
+    }
+    IxNodeHandle *leaf = fetch_node(entry.page_no);
+    leaf->page->rlatch();
+    if (!leaf->is_deleted() && leaf->is_leaf_page() && leaf->page_hdr->version == entry.version &&
+        entry.slot_no < leaf->get_size()) {
+        *slot_no = entry.slot_no;
+        return leaf;
+    }
+    leaf->page->runlatch();
+    unpin_node(leaf, false);
+    delete leaf;
+    adaptive_hash_.invalidate_page(entry.page_no);
     return nullptr;
 }
 
+/**
+ * @brief 点查找使用的查找：先查自适应哈希索引，未命中时按B-link树的方式下降，并记录对叶子结点的访问，
+ * 叶子结点变热时为其中所有的key建立哈希项
+ * @param[out] slot_no 叶子结点中第一个不小于key的位置
+ * @return 加了读锁并且pin住的叶子结点，调用者负责runlatch、unpin和delete
+ */
+IxNodeHandle *IxIndexHandle::find_leaf_for_lookup(const char *key, int *slot_no) {
+    IxNodeHandle *leaf = find_hashed_key(key, slot_no);
+    if (leaf != nullptr) {
+        return leaf;
+    }
+    leaf = find_leaf_page_blink(key, false, false);
+    *slot_no = leaf->lower_bound(key);
+    if (adaptive_hash_.record_access(leaf->get_page_no())) {
+        std::vector<char> keys;
+        std::vector<Rid> rids;
+        leaf->get_entries(&keys, &rids);
+        adaptive_hash_.build(leaf->get_page_no(), leaf->page_hdr->version, keys.data(), file_hdr_->col_tot_len_,
+                             leaf->get_size());
+    }
+    return leaf;
+}
+
+/**
+ * @brief 叶子结点被分裂、合并、重分配或删除键值对时调用，作废其中所有key的哈希项；调用者持有node的写锁
+ */
+void IxIndexHandle::invalidate_hashed_keys(IxNodeHandle *node) {
+    if (node->is_leaf_page()) {
+        adaptive_hash_.invalidate_page(node->get_page_no());
+    }
+}
+
+/**
+ * @brief key（各字段原始值拼接而成）是否可能在索引中；未启用Bloom过滤器时总是返回true
+ */
+bool IxIndexHandle::may_contain(const char *key) {
+    char key_buf[IX_MAX_COL_LEN];
+    return bloom_may_contain(file_hdr_->encode_key(key, key_buf));
+}
+
+/**
+ * @brief 在查找B+树之前用Bloom过滤器排除不存在的规范化key
+ */
+bool IxIndexHandle::bloom_may_contain(const char *key) {
+    if (file_hdr_->bloom_bits_per_key_ == 0) {
+        return true;
+    }
+    std::shared_lock<std::shared_mutex> lock(bloom_latch_);
+    return bloom_ == nullptr || bloom_->may_contain(key, file_hdr_->col_tot_len_);
+}
+
+/**
+ * @brief 扫描叶子链表，用索引中所有的key重建Bloom过滤器，容量为当前key数量的2倍
+ * @param force 为false时，只在过滤器不存在或已超过容量时重建（其他线程可能已经重建过）
+ * @note 持有bloom_latch_的写锁：插入在修改B+树期间持有读锁，因此扫描时没有进行中的插入，不会遗漏已加入旧过滤器的key
+ */
+void IxIndexHandle::build_bloom_filter(bool force) {
+    std::unique_lock<std::shared_mutex> lock(bloom_latch_);
+    if (!force && bloom_ != nullptr && !bloom_->is_overloaded()) {
+        return;
+    }
+    auto for_each_leaf = [&](auto &&visit) {
+        page_id_t page_no = file_hdr_->first_leaf_;
+        while (page_no != IX_LEAF_HEADER_PAGE) {
+            IxNodeHandle *leaf = fetch_node(page_no);
+            leaf->page->rlatch();
+            visit(leaf);
+            page_no = leaf->get_next_leaf();
+            leaf->page->runlatch();
+            unpin_node(leaf, false);
+            delete leaf;
+        }
+    };
+    size_t num_keys = 0;
+    for_each_leaf([&](IxNodeHandle *leaf) { num_keys += leaf->get_size(); });
+    constexpr size_t min_capacity = 1024;
+    auto filter = std::make_unique<IxBloomFilter>(std::max(2 * num_keys, min_capacity), file_hdr_->bloom_bits_per_key_);
+    char key[IX_MAX_COL_LEN];
+    for_each_leaf([&](IxNodeHandle *leaf) {
+        for (int i = 0; i < leaf->get_size(); i++) {
+            leaf->get_full_key(i, key);
+            filter->add(key, file_hdr_->col_tot_len_);
+        }
+    });
+    bloom_ = std::move(filter);
+}
+
+/**
+ * @brief 为插入了新键值对之后放不下的结点选择拆分位置
+ * @param keys 插入之后的完整key数组，共n个
+ * @param pos 新键值对在keys中的位置
+ * @return 拆分后各结点的边界 {0, b_1, ..., n}，第j个结点存放[b_j, b_{j+1})
+ * @note 未压缩时与原来一样从中间拆分为两个结点；压缩时叶子结点优先在中间附近选择分隔key最短的位置（后缀截断），
+ * 选中的位置必须使两侧都能放下。新key追加在最右结点（没有high key）的末尾时（自增key），左边的结点以后不会再有插入，
+ * 于是不从中间拆分，而是让左边保留IX_APPEND_SPLIT_FILL%的键值对，否则每个结点都只有一半的空间被使用。若新key与原有的key差异很大，公共前缀变短可能导致两侧都放不下，
+ * 此时把新键值对单独放入一个结点，拆分为至多3个结点，由于原有的键值对本来就能放入一个结点，这样总是可行的
+ */
+std::vector<int> IxIndexHandle::choose_split_points(IxNodeHandle *node, const std::vector<char> &keys, int pos) {
+    int len = file_hdr_->col_tot_len_;
+    int n = static_cast<int>(keys.size()) / len;
+    int mid = n / 2;
+    bool append = !node->has_high_key() && pos == n - 1;
+    if (append) {
+        mid = std::max(1, std::min(n - 1, n * IX_APPEND_SPLIT_FILL / 100));
+    }
+    if (!node->is_compressed()) {
+        return {0, mid, n};
+    }
+    auto fits = [&](int lo, int hi) { return node->fits(keys.data() + lo * len, hi - lo); };
+
+    std::vector<int> candidates;
+    if (node->is_leaf_page() && !append) {
+        // 窗口内按分隔key长度排序，长度相同时离中间越近越好
+        int window = std::max(1, n / 8);
+        for (int m = std::max(1, mid - window); m <= std::min(n - 1, mid + window); m++) {
+            candidates.push_back(m);
+        }
+        std::vector<int> sep_len(n, 0);
+        for (int m : candidates) {
+            sep_len[m] = ix_common_prefix(keys.data() + (m - 1) * len, keys.data() + m * len, len);
+        }
+        std::stable_sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+            return sep_len[a] != sep_len[b] ? sep_len[a] < sep_len[b] : std::abs(a - mid) < std::abs(b - mid);
+        });
+    } else {
+        candidates.push_back(mid);
+    }
+    candidates.push_back(pos);
+    candidates.push_back(pos + 1);
+    for (int m : candidates) {
+        if (m >= 1 && m <= n - 1 && fits(0, m) && fits(m, n)) {
+            return {0, m, n};
+        }
+    }
+    assert(pos >= 1 && pos + 1 <= n - 1);
+    return {0, pos, pos + 1, n};
+}
+
+/**
+ * @brief 在node的pos处插入键值对，node放不下时将其拆分(Split)，在node的右边生成新结点
+ * 分别把各个新结点的分隔key插入父结点
+ *
+ * @param node 需要插入并拆分的结点
+ * @param pos 插入的位置
+ * @param (key, rid) 要插入的键值对
+ * @return 插入的键值对最终所在结点的page_no
+ * @note 新结点在被链入右兄弟链表或插入父结点之前对其他线程不可见，因此无需加锁；
+ * 所有新结点先在内部连接好并设置high key，叶子结点拆分时再给原右兄弟（可能是叶子头结点）加写锁修改其prev_leaf，
+ * 最后修改node的next_leaf和high key，加锁顺序为从左到右。在插入父结点之前，查找可以经node的右兄弟指针找到新结点
+ */
+page_id_t IxIndexHandle::split_insert(IxNodeHandle *node, int pos, const char *key, const Rid &rid,
+                                      Transaction *transaction) {
+    invalidate_hashed_keys(node);
+    int len = file_hdr_->col_tot_len_;
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    node->get_entries(&keys, &rids);
+    keys.insert(keys.begin() + pos * len, key, key + len);
+    rids.insert(rids.begin() + pos, rid);
+    std::vector<int> bounds = choose_split_points(node, keys, pos);
+    int num_nodes = static_cast<int>(bounds.size()) - 1;
+
+    // 第j个新结点的分隔key：内部结点直接上移其第一个key；压缩的叶子结点取最短的分隔key
+    std::vector<char> seps(num_nodes * len);
+    for (int j = 1; j < num_nodes; j++) {
+        const char *first = keys.data() + bounds[j] * len;
+        if (node->is_leaf_page() && node->is_compressed()) {
+            ix_make_separator(first - len, first, len, seps.data() + j * len);
+        } else {
+            memcpy(seps.data() + j * len, first, len);
+        }
+    }
+
+    // 最右边的新结点继承node原来的high key，其余结点的high key为右边结点的分隔key
+    std::vector<char> old_high_key(node->get_high_key(), node->get_high_key() + len);
+    bool had_high_key = node->has_high_key();
+    node->assign(keys.data(), rids.data(), bounds[1]);
+    page_id_t page_no = node->get_page_no();
+    std::vector<IxNodeHandle *> new_nodes;
+    for (int j = 1; j < num_nodes; j++) {
+        IxNodeHandle *new_node = create_node();
+        *new_node->page_hdr = {
+            .next_free_page_no = IX_NO_PAGE,
+            .parent = node->get_parent_page_no(),
+            .num_key = 0,
+            .is_leaf = node->is_leaf_page(),
+            .prev_leaf = IX_NO_PAGE,
+            .next_leaf = IX_NO_PAGE,
+            .prefix_len = 0,
+            .key_len = 0,
+            .version = new_node->page_hdr->version,  // 重用的页面保留版本号
+        };
+        new_node->assign(keys.data() + bounds[j] * len, rids.data() + bounds[j], bounds[j + 1] - bounds[j]);
+        new_node->set_high_key(j + 1 < num_nodes ? seps.data() + (j + 1) * len
+                                                 : (had_high_key ? old_high_key.data() : nullptr));
+        if (pos >= bounds[j]) {
+            page_no = new_node->get_page_no();
+        }
+        if (!new_node->is_leaf_page()) {
+            for (int i = 0; i < new_node->get_size(); i++) {
+                maintain_child(new_node, i);
+            }
+        }
+        new_nodes.push_back(new_node);
+    }
+
+    page_id_t next_page_no = node->get_next_leaf();
+    for (int j = 0; j < static_cast<int>(new_nodes.size()); j++) {
+        new_nodes[j]->set_next_leaf(j + 1 < static_cast<int>(new_nodes.size()) ? new_nodes[j + 1]->get_page_no()
+                                                                               : next_page_no);
+        if (node->is_leaf_page()) {
+            new_nodes[j]->set_prev_leaf(j == 0 ? node->get_page_no() : new_nodes[j - 1]->get_page_no());
+        }
+    }
+    if (node->is_leaf_page()) {
+        page_id_t last_new = new_nodes.back()->get_page_no();
+        IxNodeHandle *next = fetch_node(next_page_no);
+        next->page->wlatch();
+        next->set_prev_leaf(last_new);
+        if (next->get_page_no() == IX_LEAF_HEADER_PAGE) {
+            // node原来是最右叶子结点，持有叶子头结点的写锁时更新last_leaf_
+            file_hdr_->last_leaf_ = last_new;
+        }
+        next->page->wunlatch();
+        unpin_node(next, true);
+        delete next;
+    }
+    node->set_next_leaf(new_nodes.front()->get_page_no());
+    node->set_high_key(seps.data() + len);
+
+    IxNodeHandle *prev = node;
+    for (int j = 1; j < num_nodes; j++) {
+        insert_into_parent(prev, seps.data() + j * len, new_nodes[j - 1], transaction);
+        prev = new_nodes[j - 1];
+    }
+    for (IxNodeHandle *new_node : new_nodes) {
+        unpin_node(new_node, true);
+        delete new_node;
+    }
+    return page_no;
+}
+
 /**
  * @brief Insert key & value pair into internal page after split
  * 拆分(Split)后，向上找到old_node的父结点
- * 将new_node的第一个key插入到父结点，其位置在 父结点指向old_node的孩子指针 之后
- * 如果插入后>=maxsize，则必须继续拆分父结点，然后在其父结点的父结点再插入，即需要递归
+ * 将new_node的分隔key插入到父结点，其位置在 父结点指向old_node的孩子指针 之后
+ * 如果父结点放不下，则必须继续拆分父结点，然后在其父结点的父结点再插入，即需要递归
  * 直到找到的old_node为根结点时，结束递归（此时将会新建一个根R，关键字为key，old_node和new_node为其孩子）
  *
  * @param (old_node, new_node) 原结点为old_node，old_node被分裂之后产生了新的右兄弟结点new_node
  * @param key 要插入parent的key
  * @note 一个结点插入了键值对之后需要分裂，分裂后左半部分的键值对保留在原结点，在参数中称为old_node，
- * 右半部分的键值对分裂为新的右兄弟节点，在参数中称为new_node（参考Split函数来理解old_node和new_node）
+ * 右半部分的键值对分裂为新的右兄弟节点，在参数中称为new_node（参考split_insert函数来理解old_node和new_node）
  * @note 本函数执行完毕后，new node和old node都需要在函数外面进行unpin
+ * @note 父结点会因为孩子不安全而保留在事务的加锁集合中，这里重新fetch只是为了获得结点句柄，不需要再加锁
  */
 void IxIndexHandle::insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node,
                                      Transaction *transaction) {
-    // Todo:
-    // 1. 分裂前的结点（原结点, old_node）是否为根结点，如果为根结点需要分配新的root
-    // 2. 获取原结点（old_node）的父亲结点
-    // 3. 获取key对应的rid，并将(key, rid)插入到父亲结点
-    // 4. 如果父亲结点仍需要继续分裂，则进行递归插入
-    // 提示：记得unpin page
+    if (old_node->is_root_page()) {
+        // 根结点分裂，此时一定持有root_latch_
+        IxNodeHandle *root = create_node();
+        *root->page_hdr = {
+            .next_free_page_no = IX_NO_PAGE,
+            .parent = IX_NO_PAGE,
+            .num_key = 0,
+            .is_leaf = false,
+            .prev_leaf = IX_NO_PAGE,
+            .next_leaf = IX_NO_PAGE,
+            .prefix_len = 0,
+            .key_len = 0,
+            .version = root->page_hdr->version,  // 重用的页面保留版本号
+        };
+        int len = file_hdr_->col_tot_len_;
+        std::vector<char> keys(2 * len);
+        old_node->get_full_key(0, keys.data());
+        memcpy(keys.data() + len, key, len);
+        Rid rids[2] = {Rid{old_node->get_page_no(), -1}, Rid{new_node->get_page_no(), -1}};
+        root->assign(keys.data(), rids, 2);
+        old_node->set_parent_page_no(root->get_page_no());
+        new_node->set_parent_page_no(root->get_page_no());
+        update_root_page_no(root->get_page_no());
+        unpin_node(root, true);
+        delete root;
+        return;
+    }
+
+    IxNodeHandle *parent = fetch_node(old_node->get_parent_page_no());
+    int rank = parent->find_child(old_node);
+    new_node->set_parent_page_no(parent->get_page_no());
+    if (parent->can_insert(rank + 1, key)) {
+        parent->insert_pair(rank + 1, key, Rid{new_node->get_page_no(), -1});
+    } else {
+        split_insert(parent, rank + 1, key, Rid{new_node->get_page_no(), -1}, transaction);
+    }
+    unpin_node(parent, true);
+    delete parent;
 }
 
 /**
  * @brief 将指定键值对插入到B+树中
  * @param (key, value) 要插入的键值对
  * @param transaction 事务指针
- * @return page_id_t 插入到的叶结点的page_no
+ * @return page_id_t 插入到的叶结点的page_no；key已存在时不插入，返回IX_NO_PAGE
+ * @note 先走乐观路径，只对叶子结点加写锁；若叶子结点需要分裂，再走悲观路径重新查找
+ * @note 上一次插入追加在最右叶子结点的末尾时，乐观路径先尝试直接追加到该叶子，不从根结点下降
+ * @note 启用Bloom过滤器时，先把key加入过滤器再修改B+树，并在插入期间持有bloom_latch_的读锁
+ * @note 正在在线重建时同时记入side log；已被重建出的新索引替换时转发给新索引
  */
 page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transaction *transaction) {
-    // Todo:
-    // 1. 查找key值应该插入到哪个叶子节点
-    // 2. 在该叶子节点中插入键值对
-    // 3. 如果结点已满，分裂结点，并把新结点的相关信息插入父节点
-    // 提示：记得unpin page；若当前叶子节点是最右叶子节点，则需要更新file_hdr_.last_leaf；记得处理并发的上锁
+    std::shared_lock<std::shared_mutex> rebuild_lock(rebuild_latch_);
+    if (forward_ != nullptr) {
+        return forward_->insert_entry(key, value, transaction);
+    }
+    char key_buf[IX_MAX_COL_LEN];
+    key = file_hdr_->encode_key(key, key_buf);
+    if (side_log_ != nullptr) {
+        side_log_->add_insert(key, value);
+    }
+    return insert_encoded(key, value, transaction);
+}
 
-    return -1;
+/**
+ * @brief insert_entry中编码之后的部分，key为规范化的key
+ */
+page_id_t IxIndexHandle::insert_encoded(const char *key, const Rid &value, Transaction *transaction) {
+    IxOpGuard guard(this);
+    std::shared_lock<std::shared_mutex> bloom_lock(bloom_latch_, std::defer_lock);
+    if (file_hdr_->bloom_bits_per_key_ > 0) {
+        bloom_lock.lock();
+        if (bloom_ == nullptr || bloom_->is_overloaded()) {
+            bloom_lock.unlock();
+            build_bloom_filter(false);
+            bloom_lock.lock();
+        }
+        bloom_->add(key, file_hdr_->col_tot_len_);
+    }
+    {
+        IxNodeHandle *leaf = find_append_leaf(key);
+        if (leaf == nullptr) {
+            leaf = find_leaf_page_blink(key, false, true);
+        }
+        int pos = leaf->lower_bound(key);
+        bool exists = pos < leaf->get_size() && leaf->compare_key(pos, key) == 0;
+        bool safe = leaf->can_insert(pos, key);
+        page_id_t page_no = exists ? IX_NO_PAGE : leaf->get_page_no();
+        if (!exists && safe) {
+            if (pos == leaf->get_size() && !leaf->has_high_key()) {
+                append_leaf_.store(page_no, std::memory_order_relaxed);
+            }
+            leaf->insert_pair(pos, key, value);
+        }
+        leaf->page->wunlatch();
+        unpin_node(leaf, !exists && safe);
+        delete leaf;
+        if (exists || safe) {
+            return page_no;
+        }
+    }
+
+    Transaction local_txn(INVALID_TXN_ID);
+    if (transaction == nullptr) {
+        transaction = &local_txn;
+    }
+    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::INSERT, transaction);
+    page_id_t page_no = IX_NO_PAGE;
+    int pos = leaf->lower_bound(key);
+    if (pos == leaf->get_size() || leaf->compare_key(pos, key) != 0) {
+        bool append = pos == leaf->get_size() && !leaf->has_high_key();
+        if (leaf->can_insert(pos, key)) {
+            leaf->insert_pair(pos, key, value);
+            page_no = leaf->get_page_no();
+        } else {
+            page_no = split_insert(leaf, pos, key, value, transaction);
+        }
+        if (append) {
+            // 追加的键值对位于拆分出的最右结点中
+            append_leaf_.store(page_no, std::memory_order_relaxed);
+        }
+    }
+    delete leaf;
+    release_latched_pages(transaction);
+    if (root_is_latched) {
+        root_latch_.unlock();
+    }
+    return page_no;
 }
 
 /**
  * @brief 用于删除B+树中含有指定key的键值对
  * @param key 要删除的key值
  * @param transaction 事务指针
+ * @note 先走乐观路径，只对叶子结点加写锁；若删除后叶子结点需要合并或重分配，再走悲观路径重新查找
  */
 bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
-    // Todo:
-    // 1. 获取该键值对所在的叶子结点
-    // 2. 在该叶子结点中删除键值对
-    // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
-    // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
+    std::shared_lock<std::shared_mutex> rebuild_lock(rebuild_latch_);
+    if (forward_ != nullptr) {
+        return forward_->delete_entry(key, transaction);
+    }
+    char key_buf[IX_MAX_COL_LEN];
+    key = file_hdr_->encode_key(key, key_buf);
+    if (side_log_ != nullptr) {
+        side_log_->add_delete(key);
+    }
+    return delete_encoded(key, transaction);
+}
 
-    return false;
+/**
+ * @brief delete_entry中编码之后的部分，key为规范化的key
+ */
+bool IxIndexHandle::delete_encoded(const char *key, Transaction *transaction) {
+    IxOpGuard guard(this);
+    {
+        IxNodeHandle *leaf = find_leaf_page_blink(key, false, true);
+        int pos = leaf->lower_bound(key);
+        bool exists = pos < leaf->get_size() && leaf->compare_key(pos, key) == 0;
+        bool safe = leaf->is_root_page() || !leaf->is_underflow(1);
+        if (exists && safe) {
+            leaf->erase_pair(pos);
+            invalidate_hashed_keys(leaf);
+        }
+        leaf->page->wunlatch();
+        unpin_node(leaf, exists && safe);
+        delete leaf;
+        if (!exists || safe) {
+            return exists;
+        }
+    }
+
+    Transaction local_txn(INVALID_TXN_ID);
+    if (transaction == nullptr) {
+        transaction = &local_txn;
+    }
+    auto [leaf, root_is_latched] = find_leaf_page(key, Operation::DELETE, transaction);
+    bool exists = false;
+    int pos = leaf->lower_bound(key);
+    if (pos < leaf->get_size() && leaf->compare_key(pos, key) == 0) {
+        exists = true;
+        leaf->erase_pair(pos);
+        invalidate_hashed_keys(leaf);
+        coalesce_or_redistribute(leaf, transaction, &root_is_latched);
+    }
+    delete leaf;
+    release_latched_pages(transaction);
+    if (root_is_latched) {
+        root_latch_.unlock();
+    }
+    return exists;
+}
+
+/**
+ * @brief 执行器插入记录时维护索引：启用了change buffer时只把插入暂存起来，否则立即插入B+树
+ * @note 暂存的插入不检查key是否已存在，与insert_entry一样，合并时已存在的key不会被插入
+ */
+void IxIndexHandle::defer_insert(const char *key, const Rid &value, Transaction *transaction) {
+    std::shared_lock<std::shared_mutex> rebuild_lock(rebuild_latch_);
+    if (forward_ != nullptr) {
+        forward_->defer_insert(key, value, transaction);
+        return;
+    }
+    char key_buf[IX_MAX_COL_LEN];
+    key = file_hdr_->encode_key(key, key_buf);
+    if (side_log_ != nullptr) {
+        side_log_->add_insert(key, value);
+    }
+    if (change_buffer_ == nullptr) {
+        insert_encoded(key, value, transaction);
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(change_latch_);
+    change_buffer_->add_insert(key, value);
+    if (change_buffer_->size() >= IX_CHANGE_BUFFER_MAX_ENTRIES) {
+        apply_changes(change_buffer_->take_all(), transaction);
+        change_buffer_->clear_log();
+    }
+}
+
+/**
+ * @brief 执行器删除记录时维护索引：启用了change buffer时只把删除暂存起来，否则立即从B+树中删除
+ */
+void IxIndexHandle::defer_delete(const char *key, Transaction *transaction) {
+    std::shared_lock<std::shared_mutex> rebuild_lock(rebuild_latch_);
+    if (forward_ != nullptr) {
+        forward_->defer_delete(key, transaction);
+        return;
+    }
+    char key_buf[IX_MAX_COL_LEN];
+    key = file_hdr_->encode_key(key, key_buf);
+    if (side_log_ != nullptr) {
+        side_log_->add_delete(key);
+    }
+    if (change_buffer_ == nullptr) {
+        delete_encoded(key, transaction);
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(change_latch_);
+    change_buffer_->add_delete(key);
+    if (change_buffer_->size() >= IX_CHANGE_BUFFER_MAX_ENTRIES) {
+        apply_changes(change_buffer_->take_all(), transaction);
+        change_buffer_->clear_log();
+    }
+}
+
+/**
+ * @brief 读取B+树中key位于[lower, upper]（各字段原始值拼接而成）的部分之前，把其中暂存的修改合并到叶子结点中
+ * get_value和get_values自动调用，范围扫描（IxScan）的调用者需要先调用
+ */
+void IxIndexHandle::merge_changes(const char *lower, const char *upper, Transaction *transaction) {
+    if (change_buffer_ == nullptr) {
+        return;
+    }
+    char lower_buf[IX_MAX_COL_LEN], upper_buf[IX_MAX_COL_LEN];
+    merge_encoded_changes(file_hdr_->encode_key(lower, lower_buf), file_hdr_->encode_key(upper, upper_buf),
+                          transaction);
+}
+
+/**
+ * @brief 把所有暂存的修改合并到B+树中并清空日志，关闭索引前调用
+ */
+void IxIndexHandle::merge_all_changes(Transaction *transaction) {
+    if (change_buffer_ == nullptr) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(change_latch_);
+    apply_changes(change_buffer_->take_all(), transaction);
+    change_buffer_->clear_log();
+}
+
+/**
+ * @brief merge_changes中编码之后的部分，lower和upper为规范化的key
+ * @note 先持有读锁检查，没有暂存的修改时（多数情况）不与其他读者互斥；取出和合并期间持有写锁，
+ * 其他读者不会在修改合并完成之前读到B+树中的旧值
+ */
+void IxIndexHandle::merge_encoded_changes(const char *lower, const char *upper, Transaction *transaction) {
+    if (change_buffer_ == nullptr) {
+        return;
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(change_latch_);
+        if (!change_buffer_->contains(lower, upper)) {
+            return;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(change_latch_);
+    apply_changes(change_buffer_->take(lower, upper), transaction);
+}
+
+/**
+ * @brief 按key的顺序把取出的修改应用到B+树，相邻的key通常落在同一个或相邻的叶子结点中
+ */
+void IxIndexHandle::apply_changes(const std::vector<std::pair<std::string, IxChangeBuffer::Change>> &changes,
+                                  Transaction *transaction) {
+    for (auto &[key, change] : changes) {
+        if (change.delete_first) {
+            delete_encoded(key.data(), transaction);
+        }
+        if (change.has_insert) {
+            insert_encoded(key.data(), change.rid, transaction);
+        }
+    }
+}
+
+/**
+ * @brief 开始在线重建：之后的写操作在修改本索引的同时记入side log，等待已经开始的写操作完成
+ * 调用者随后扫描表构建新索引，扫描开始之前已完成的修改都反映在表中，之后的修改都在side log中
+ */
+void IxIndexHandle::begin_rebuild() {
+    std::unique_lock<std::shared_mutex> lock(rebuild_latch_);
+    side_log_ = std::make_unique<IxSideLog>(file_hdr_->col_tot_len_);
+}
+
+/**
+ * @brief 把side log中目前记录的修改按顺序应用到重建出的新索引target，返回应用的修改数量
+ * @note 插入已存在的key和删除不存在的key都不改变新索引，因此与表扫描重叠的修改重放多次也没有影响
+ */
+size_t IxIndexHandle::replay_side_log(IxIndexHandle *target) {
+    auto entries = side_log_->take_all();
+    for (auto &entry : entries) {
+        if (entry.is_insert) {
+            target->insert_encoded(entry.key.data(), entry.rid, nullptr);
+        } else {
+            target->delete_encoded(entry.key.data(), nullptr);
+        }
+    }
+    return entries.size();
+}
+
+/**
+ * @brief 重建完成，本索引被replacement替换：之后的写操作转发给replacement，调用者须持有freeze_writes()返回的锁
+ * 仍持有本索引的读者（如已经开始的IxScan）读到的是冻结时的内容
+ */
+void IxIndexHandle::finish_rebuild(IxIndexHandle *replacement) {
+    side_log_.reset();
+    forward_ = replacement;
+}
+
+/**
+ * @brief 重建失败，停止记录side log
+ */
+void IxIndexHandle::abort_rebuild() {
+    std::unique_lock<std::shared_mutex> lock(rebuild_latch_);
+    side_log_.reset();
 }
 
 /**
@@ -274,19 +1517,71 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
  * @note User needs to first find the sibling of input page.
  * If sibling's size + input page's size >= 2 * page's minsize, then redistribute.
  * Otherwise, merge(Coalesce).
+ * 压缩时按字节判断：两个结点合并之后能放入一个结点则合并，否则重分配
+ * @note 为了让不加锁耦合的查找能够通过向右移动找到key，键值对只能从左结点移到右结点：
+ * node是第0个孩子（兄弟结点在右边）时不做重分配，能放入一个结点就合并，否则暂时保持过空
+ * @note node不安全，因此node的父结点一定在事务的加锁集合中；兄弟结点在父结点的写锁保护下加写锁，并加入加锁集合
  */
 bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 判断node结点是否为根节点
-    //    1.1 如果是根节点，需要调用AdjustRoot() 函数来进行处理，返回根节点是否需要被删除
-    //    1.2 如果不是根节点，并且不需要执行合并或重分配操作，则直接返回false，否则执行2
-    // 2. 获取node结点的父亲结点
-    // 3. 寻找node结点的兄弟结点（优先选取前驱结点）
-    // 4. 如果node结点和兄弟结点的键值对数量之和，能够支撑两个B+树结点（即node.size+neighbor.size >=
-    // NodeMinSize*2)，则只需要重新分配键值对（调用Redistribute函数）
-    // 5. 如果不满足上述条件，则需要合并两个结点，将右边的结点合并到左边的结点（调用Coalesce函数）
+    if (node->is_root_page()) {
+        return adjust_root(node);
+    }
+    if (!node->is_underflow()) {
+        return false;
+    }
 
-    return false;
+    IxNodeHandle *parent = fetch_node(node->get_parent_page_no());
+    if (parent->get_size() < 2) {
+        // 压缩时父结点的重分配可能因为分隔key放不下而未完成，父结点只有一个孩子时没有兄弟结点可用
+        unpin_node(parent, false);
+        delete parent;
+        return false;
+    }
+    int index = parent->find_child(node);
+    // 优先选取前驱结点作为兄弟结点
+    IxNodeHandle *neighbor = fetch_node(parent->value_at(index > 0 ? index - 1 : index + 1));
+    neighbor->page->wlatch();
+    transaction->append_index_latch_page_set(neighbor->page);
+
+    bool merge;
+    if (node->is_compressed()) {
+        // 合并之后的键值对：内部结点中右结点的第0个key替换为父结点中的分隔key
+        IxNodeHandle *left = index > 0 ? neighbor : node;
+        IxNodeHandle *right = index > 0 ? node : neighbor;
+        int len = file_hdr_->col_tot_len_;
+        std::vector<char> keys;
+        std::vector<Rid> rids;
+        left->get_entries(&keys, &rids);
+        int left_size = left->get_size();
+        right->get_entries(&keys, &rids);
+        if (!left->is_leaf_page()) {
+            parent->get_full_key(index > 0 ? index : 1, keys.data() + left_size * len);
+        }
+        merge = left->fits(keys.data(), static_cast<int>(rids.size()));
+    } else {
+        int total = node->get_size() + neighbor->get_size();
+        merge = total < node->get_min_size() * 2 || (index == 0 && total <= file_hdr_->btree_order_);
+    }
+
+    invalidate_hashed_keys(node);
+    invalidate_hashed_keys(neighbor);
+    bool node_deleted = false;
+    if (!merge) {
+        if (index > 0) {
+            redistribute(neighbor, node, parent, index);
+        }
+    } else {
+        IxNodeHandle *left = neighbor;
+        IxNodeHandle *right = node;
+        IxNodeHandle *parent_node = parent;
+        coalesce(&left, &right, &parent_node, index, transaction, root_is_latched);
+        // 总是将右结点合并到左结点，index为0时被删除的是兄弟结点
+        node_deleted = index > 0;
+    }
+    unpin_node(parent, true);
+    delete parent;
+    delete neighbor;
+    return node_deleted;
 }
 
 /**
@@ -294,36 +1589,99 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
  * @param old_root_node 原根节点
  * @return bool 根结点是否需要被删除
  * @note size of root page can be less than min size and this method is only called within coalesce_or_redistribute()
+ * @note 叶子根结点为空时仍保留该结点，使first_leaf_和last_leaf_始终指向合法的叶子结点
+ * @note 原根结点标记为已删除，正在读它的查找会从新的根结点重新开始
  */
 bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
-    // Todo:
-    // 1. 如果old_root_node是内部结点，并且大小为1，则直接把它的孩子更新成新的根结点
-    // 2. 如果old_root_node是叶结点，且大小为0，则直接更新root page
-    // 3. 除了上述两种情况，不需要进行操作
-
+    if (!old_root_node->is_leaf_page() && old_root_node->get_size() == 1) {
+        // 此时一定持有root_latch_，唯一的孩子也在事务的加锁集合中
+        page_id_t child_page_no = old_root_node->remove_and_return_only_child();
+        IxNodeHandle *child = fetch_node(child_page_no);
+        child->set_parent_page_no(IX_NO_PAGE);
+        unpin_node(child, true);
+        delete child;
+        update_root_page_no(child_page_no);
+        release_node_handle(*old_root_node);
+        return true;
+    }
     return false;
 }
 
 /**
  * @brief 重新分配node和兄弟结点neighbor_node的键值对
- * Redistribute key & value pairs from one page to its sibling page. If index == 0, move sibling page's first key
- * & value pair into end of input "node", otherwise move sibling page's last key & value pair into head of input "node".
+ * Move sibling page's last key & value pair into head of input "node".
  *
  * @param neighbor_node sibling page of input "node"
  * @param node input from method coalesceOrRedistribute()
  * @param parent the parent of "node" and "neighbor_node"
- * @param index node在parent中的rid_idx
+ * @param index node在parent中的rid_idx，index>0，neighbor是node前驱结点，表示：neighbor(left)  node(right)
  * @note node是之前刚被删除过一个key的结点
- * index=0，则neighbor是node后继结点，表示：node(left)      neighbor(right)
- * index>0，则neighbor是node前驱结点，表示：neighbor(left)  node(right)
- * 注意更新parent结点的相关kv对
+ * 注意更新parent结点中node的分隔key，以及左兄弟的high key
+ * @note 压缩时每次移动一个键值对，直到node不再过空，或者继续移动会使兄弟结点过空、放不下或父结点放不下新的分隔key
  */
 void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index) {
-    // Todo:
-    // 1. 通过index判断neighbor_node是否为node的前驱结点
-    // 2. 从neighbor_node中移动一个键值对到node结点中
-    // 3. 更新父节点中的相关信息，并且修改移动键值对对应孩字结点的父结点信息（maintain_child函数）
-    // 注意：neighbor_node的位置不同，需要移动的键值对不同，需要分类讨论
+    assert(index > 0);
+    if (node->is_compressed()) {
+        while (node->is_underflow() && redistribute_compressed(neighbor_node, node, parent, index)) {
+        }
+        return;
+    }
+    // 把左兄弟的最后一个键值对移动到node开头，移动的key成为新的分隔key
+    int last = neighbor_node->get_size() - 1;
+    if (!node->is_leaf_page() && node->get_size() > 0) {
+        // 内部结点的第0个key不参与查找，移动后它成为第1个key，改为原第0棵子树的下界，即原来的分隔key
+        node->set_key(0, parent->get_key(index));
+    }
+    node->insert_pair(0, neighbor_node->get_key(last), *neighbor_node->get_rid(last));
+    neighbor_node->erase_pair(last);
+    maintain_child(node, 0);
+    parent->set_key(index, node->get_key(0));
+    neighbor_node->set_high_key(node->get_key(0));
+}
+
+/**
+ * @brief 压缩结点的一步重分配：经过父结点中的分隔key把左兄弟的最后一个键值对移到node开头
+ * 叶子结点移动键值对后重新计算最短分隔key；内部结点移动孩子时，原分隔key下移，兄弟结点边界上的key上移为新的分隔key；
+ * 新的分隔key同时成为左兄弟的high key
+ * @return 是否移动成功
+ */
+bool IxIndexHandle::redistribute_compressed(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent,
+                                            int index) {
+    if (neighbor_node->get_size() < 2 || neighbor_node->is_underflow(1)) {
+        return false;
+    }
+    int len = file_hdr_->col_tot_len_;
+    bool is_leaf = node->is_leaf_page();
+    std::vector<char> moved_key(len), sep(len), tmp(len);
+    // 左兄弟的最后一个键值对移动到node开头
+    int sep_idx = index;
+    int last = neighbor_node->get_size() - 1;
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    node->get_entries(&keys, &rids);
+    neighbor_node->get_full_key(last, moved_key.data());
+    if (is_leaf) {
+        neighbor_node->get_full_key(last - 1, tmp.data());
+        ix_make_separator(tmp.data(), moved_key.data(), len, sep.data());
+        keys.insert(keys.begin(), moved_key.begin(), moved_key.end());
+    } else {
+        // node原来的第0个key无意义，替换为原分隔key；新的第0个key同样无意义
+        memcpy(sep.data(), moved_key.data(), len);
+        if (!keys.empty()) {
+            parent->get_full_key(sep_idx, keys.data());
+        }
+        keys.insert(keys.begin(), moved_key.begin(), moved_key.end());
+    }
+    rids.insert(rids.begin(), *neighbor_node->get_rid(last));
+    if (!node->fits(keys.data(), static_cast<int>(rids.size())) || !parent->can_set_key(sep_idx, sep.data())) {
+        return false;
+    }
+    node->assign(keys.data(), rids.data(), static_cast<int>(rids.size()));
+    maintain_child(node, 0);
+    neighbor_node->erase_pair(last);
+    neighbor_node->set_high_key(sep.data());
+    parent->set_key(sep_idx, sep.data());
+    return true;
 }
 
 /**
@@ -342,13 +1700,37 @@ void IxIndexHandle::redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node
  */
 bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                              Transaction *transaction, bool *root_is_latched) {
-    // Todo:
-    // 1. 用index判断neighbor_node是否为node的前驱结点，若不是则交换两个结点，让neighbor_node作为左结点，node作为右结点
-    // 2. 把node结点的键值对移动到neighbor_node中，并更新node结点孩子结点的父节点信息（调用maintain_child函数）
-    // 3. 释放和删除node结点，并删除parent中node结点的信息，返回parent是否需要被删除
-    // 提示：如果是叶子结点且为最右叶子结点，需要更新file_hdr_.last_leaf
+    if (index == 0) {
+        std::swap(*neighbor_node, *node);
+        index = 1;
+    }
+    IxNodeHandle *left = *neighbor_node;
+    IxNodeHandle *right = *node;
 
-    return false;
+    std::vector<char> keys;
+    std::vector<Rid> rids;
+    left->get_entries(&keys, &rids);
+    int pos = left->get_size();
+    right->get_entries(&keys, &rids);
+    if (!left->is_leaf_page()) {
+        // 右结点的第0个key不参与查找，替换为父结点中的分隔key
+        (*parent)->get_full_key(index, keys.data() + pos * file_hdr_->col_tot_len_);
+    }
+    left->assign(keys.data(), rids.data(), static_cast<int>(rids.size()));
+    for (int i = pos; i < left->get_size(); i++) {
+        maintain_child(left, i);
+    }
+    // 左结点接管右结点的key范围
+    left->set_high_key(right->has_high_key() ? right->get_high_key() : nullptr);
+    if (right->is_leaf_page()) {
+        erase_leaf(right);
+    } else {
+        left->set_next_leaf(right->get_next_leaf());
+    }
+    release_node_handle(*right);
+
+    (*parent)->erase_pair(index);
+    return coalesce_or_redistribute(*parent, transaction, root_is_latched);
 }
 
 /**
@@ -362,11 +1744,39 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
  */
 Rid IxIndexHandle::get_rid(const Iid &iid) const {
     IxNodeHandle *node = fetch_node(iid.page_no);
+    node->page->rlatch();
     if (iid.slot_no >= node->get_size()) {
+        node->page->runlatch();
+        unpin_node(node, false);
+        delete node;
         throw IndexEntryNotFoundError();
     }
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return *node->get_rid(iid.slot_no);
+    Rid rid = *node->get_rid(iid.slot_no);
+    node->page->runlatch();
+    unpin_node(node, false);  // unpin it!
+    delete node;
+    return rid;
+}
+
+/**
+ * @brief 读取iid对应索引槽中的key，还原为各字段原始值拼接成的key写入key
+ * 索引覆盖查询所需的全部字段时，可以直接由key构造结果，不必回表
+ */
+void IxIndexHandle::get_key(const Iid &iid, char *key) const {
+    IxNodeHandle *node = fetch_node(iid.page_no);
+    node->page->rlatch();
+    if (iid.slot_no >= node->get_size()) {
+        node->page->runlatch();
+        unpin_node(node, false);
+        delete node;
+        throw IndexEntryNotFoundError();
+    }
+    char encoded[IX_MAX_COL_LEN];
+    node->get_full_key(iid.slot_no, encoded);
+    node->page->runlatch();
+    unpin_node(node, false);
+    delete node;
+    file_hdr_->decode_key(encoded, key);
 }
 
 /**
@@ -374,12 +1784,23 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  *
  * @param key
  * @return Iid
- * @note 上层传入的key本来是int类型，通过(const char *)&key进行了转换
- * 可用*(int *)key转换回去
+ * @note 上层传入的key为字段原始值，例如int类型的key通过(const char *)&key进行了转换，这里先编码为规范化的key
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
-
-    return Iid{-1, -1};
+    IxOpGuard guard(this);
+    char key_buf[IX_MAX_COL_LEN];
+    key = file_hdr_->encode_key(key, key_buf);
+    int slot_no;
+    IxNodeHandle *leaf = find_leaf_for_lookup(key, &slot_no);
+    Iid iid = {.page_no = leaf->get_page_no(), .slot_no = slot_no};
+    if (slot_no == leaf->get_size() && leaf->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        // 叶子结点中所有key都小于目标key，下一个位置是后继叶子的第一个键值对
+        iid = {.page_no = leaf->get_next_leaf(), .slot_no = 0};
+    }
+    leaf->page->runlatch();
+    unpin_node(leaf, false);
+    delete leaf;
+    return iid;
 }
 
 /**
@@ -389,8 +1810,22 @@ Iid IxIndexHandle::lower_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
-    
-    return Iid{-1, -1};
+    IxOpGuard guard(this);
+    char key_buf[IX_MAX_COL_LEN];
+    key = file_hdr_->encode_key(key, key_buf);
+    int slot_no;
+    IxNodeHandle *leaf = find_leaf_for_lookup(key, &slot_no);
+    if (slot_no < leaf->get_size() && leaf->compare_key(slot_no, key) == 0) {
+        slot_no++;
+    }
+    Iid iid = {.page_no = leaf->get_page_no(), .slot_no = slot_no};
+    if (slot_no == leaf->get_size() && leaf->get_next_leaf() != IX_LEAF_HEADER_PAGE) {
+        iid = {.page_no = leaf->get_next_leaf(), .slot_no = 0};
+    }
+    leaf->page->runlatch();
+    unpin_node(leaf, false);
+    delete leaf;
+    return iid;
 }
 
 /**
@@ -400,9 +1835,13 @@ Iid IxIndexHandle::upper_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::leaf_end() const {
+    IxOpGuard guard(this);
     IxNodeHandle *node = fetch_node(file_hdr_->last_leaf_);
+    node->page->rlatch();
     Iid iid = {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
+    node->page->runlatch();
+    unpin_node(node, false);  // unpin it!
+    delete node;
     return iid;
 }
 
@@ -425,81 +1864,273 @@ Iid IxIndexHandle::leaf_begin() const {
  * @note pin the page, remember to unpin it outside!
  */
 IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
+    {
+        std::shared_lock<std::shared_mutex> lock(pinned_latch_);
+        Page *page = find_pinned_page(page_no);
+        if (page != nullptr) {
+            // 常驻pin保证页面不会被换出，这次的pin直接加在页面上，与其他pin一样由unpin_node或缓冲池的unpin_page释放
+            BufferPoolManager::pin_pinned_page(page);
+            return new IxNodeHandle(file_hdr_, page);
+        }
+    }
     Page *page = buffer_pool_manager_->fetch_page(PageId{fd_, page_no});
+    if (page == nullptr) {
+        throw InternalError("IxIndexHandle::fetch_node: buffer pool is full");
+    }
     IxNodeHandle *node = new IxNodeHandle(file_hdr_, page);
-    
+    // 根结点和根结点的内部孩子结点常驻缓冲池；这里不加锁读取页头，判断错误只会多占用或少占用一个常驻位置
+    if (!node->is_leaf_page() && !node->is_deleted() &&
+        (node->is_root_page() || node->get_parent_page_no() == get_root_page_no())) {
+        pin_page(page);
+    }
     return node;
 }
 
+/**
+ * @brief 与fetch_node配对使用，释放一个pin
+ * @note 常驻结点上的pin不经过缓冲池，只修改页面的pin计数；常驻pin还在，计数不会在这里变为0
+ */
+void IxIndexHandle::unpin_page(Page *page, bool is_dirty) const {
+    {
+        std::shared_lock<std::shared_mutex> lock(pinned_latch_);
+        if (find_pinned_page(page->get_page_id().page_no) == page) {
+            BufferPoolManager::unpin_pinned_page(page, is_dirty);
+            return;
+        }
+    }
+    buffer_pool_manager_->unpin_page(page->get_page_id(), is_dirty);
+}
+
+/**
+ * @brief 返回常驻结点page_no所在的页面，不是常驻结点时返回nullptr
+ * @note 调用者持有pinned_latch_
+ */
+Page *IxIndexHandle::find_pinned_page(page_id_t page_no) const {
+    for (int i = 0; i < num_pinned_; i++) {
+        if (pinned_page_nos_[i] == page_no) {
+            return pinned_pages_[i];
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief 把刚刚fetch的page加入常驻结点，常驻结点另外持有一个pin，调用者的pin不变
+ * @note 其他线程已经把page加入常驻结点，或常驻结点已满时不做任何事，page仍按普通页面使用
+ */
+void IxIndexHandle::pin_page(Page *page) const {
+    std::unique_lock<std::shared_mutex> lock(pinned_latch_);
+    page_id_t page_no = page->get_page_id().page_no;
+    if (find_pinned_page(page_no) != nullptr || num_pinned_ == IX_PINNED_NODES) {
+        return;
+    }
+    BufferPoolManager::pin_pinned_page(page);
+    pinned_pages_[num_pinned_] = page;
+    pinned_page_nos_[num_pinned_] = page_no;
+    num_pinned_++;
+}
+
+/**
+ * @brief 去掉不再是上层结点的常驻结点并释放它们的常驻pin，腾出的位置留给之后fetch_node遇到的上层结点
+ * @param freed 刚被删除的结点，没有时为IX_NO_PAGE
+ * @note 与fetch_node一样不加锁读取页头，判断错误只会多占用或少占用一个常驻位置
+ */
+void IxIndexHandle::refresh_pinned_pages(page_id_t freed) const {
+    page_id_t root = get_root_page_no();
+    std::vector<Page *> stale;
+    {
+        std::unique_lock<std::shared_mutex> lock(pinned_latch_);
+        int n = 0;
+        for (int i = 0; i < num_pinned_; i++) {
+            IxNodeHandle node(file_hdr_, pinned_pages_[i]);
+            if (pinned_page_nos_[i] != freed && !node.is_leaf_page() && !node.is_deleted() &&
+                (pinned_page_nos_[i] == root || node.get_parent_page_no() == root)) {
+                pinned_pages_[n] = pinned_pages_[i];
+                pinned_page_nos_[n] = pinned_page_nos_[i];
+                n++;
+            } else {
+                stale.push_back(pinned_pages_[i]);
+            }
+        }
+        num_pinned_ = n;
+    }
+    // 脏标记在释放其他pin时已经记在页面上
+    for (Page *page : stale) {
+        buffer_pool_manager_->unpin_page(page->get_page_id(), false);
+    }
+}
+
+/**
+ * @brief 释放所有常驻pin，关闭索引或整个文件被重写之前调用
+ */
+void IxIndexHandle::unpin_all_pinned_pages() const {
+    std::unique_lock<std::shared_mutex> lock(pinned_latch_);
+    for (int i = 0; i < num_pinned_; i++) {
+        buffer_pool_manager_->unpin_page(pinned_pages_[i]->get_page_id(), false);
+    }
+    num_pinned_ = 0;
+}
+
+/**
+ * @brief 更新根结点页面号，去掉不再是上层结点的常驻结点，并使新的根结点常驻缓冲池
+ */
+void IxIndexHandle::update_root_page_no(page_id_t root) {
+    __atomic_store_n(&file_hdr_->root_page_, root, __ATOMIC_RELEASE);
+    refresh_pinned_pages(IX_NO_PAGE);
+    IxNodeHandle *node = fetch_node(root);
+    unpin_node(node, false);
+    delete node;
+}
+
 /**
  * @brief 创建一个新结点
  *
  * @return IxNodeHandle*
  * @note pin the page, remember to unpin it outside!
  * 注意：对于Index的处理是，删除某个页面后，认为该被删除的页面是free_page
- * 而first_free_page实际上就是最新被删除的页面，初始为IX_NO_PAGE
- * 在最开始插入时，一直是create node，那么first_page_no一直没变，一直是IX_NO_PAGE
+ * 而first_free_page实际上就是最新被回收的页面，初始为IX_NO_PAGE；空闲页面链表不为空时优先重用其中的页面
  * 与Record的处理不同，Record将未插入满的记录页认为是free_page
  */
 IxNodeHandle *IxIndexHandle::create_node() {
+    {
+        std::lock_guard<std::mutex> lock(free_latch_);
+        page_id_t page_no = file_hdr_->first_free_page_no_;
+        if (page_no != IX_NO_PAGE) {
+            // 重用空闲页面链表中的第一个页面，版本号继续递增，之前记录的slot全部失效；
+            // 持有过期哈希项的查找仍可能读这个页面（find_hashed_key），因此在写锁下修改
+            IxNodeHandle *node = fetch_node(page_no);
+            file_hdr_->first_free_page_no_ = node->page_hdr->next_free_page_no;
+            node->page->wlatch();
+            uint32_t version = node->page_hdr->version;
+            memset(node->page->get_data(), 0, PAGE_SIZE);
+            node->page_hdr->version = version + 1;
+            node->page->wunlatch();
+            adaptive_hash_.invalidate_page(page_no);
+            return node;
+        }
+    }
     IxNodeHandle *node;
-    file_hdr_->num_pages_++;
-
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
-    // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
-    Page *page = buffer_pool_manager_->new_page(&new_page_id);
+    Page *page;
+    {
+        // 不同子树上的悲观写操作可能同时创建结点
+        std::lock_guard<std::mutex> lock(file_hdr_latch_);
+        file_hdr_->num_pages_++;
+        // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
+        page = buffer_pool_manager_->new_page(&new_page_id);
+    }
+    if (page == nullptr) {
+        throw InternalError("IxIndexHandle::create_node: buffer pool is full");
+    }
     node = new IxNodeHandle(file_hdr_, page);
     return node;
 }
 
-/**
- * @brief 从node开始更新其父节点的第一个key，一直向上更新直到根节点
- *
- * @param node
- */
-void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
-    IxNodeHandle *curr = node;
-    while (curr->get_parent_page_no() != IX_NO_PAGE) {
-        // Load its parent
-        IxNodeHandle *parent = fetch_node(curr->get_parent_page_no());
-        int rank = parent->find_child(curr);
-        char *parent_key = parent->get_key(rank);
-        char *child_first_key = curr->get_key(0);
-        if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
-            break;
-        }
-        memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_);  // 修改了parent node
-        curr = parent;
-
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
-    }
-}
-
 /**
  * @brief 要删除leaf之前调用此函数，更新leaf前驱结点的next指针和后继结点的prev指针
  *
  * @param leaf 要删除的leaf
+ * @note 前驱结点是合并的目标结点，调用者已持有其写锁；后继结点（可能是叶子头结点）在这里加写锁
  */
 void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
     assert(leaf->is_leaf_page());
 
     IxNodeHandle *prev = fetch_node(leaf->get_prev_leaf());
     prev->set_next_leaf(leaf->get_next_leaf());
-    buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
+    unpin_node(prev, true);
 
     IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
+    next->page->wlatch();
     next->set_prev_leaf(leaf->get_prev_leaf());  // 注意此处是SetPrevLeaf()
-    buffer_pool_manager_->unpin_page(next->get_page_id(), true);
+    if (next->get_page_no() == IX_LEAF_HEADER_PAGE) {
+        file_hdr_->last_leaf_ = leaf->get_prev_leaf();
+    }
+    next->page->wunlatch();
+    unpin_node(next, true);
+    delete prev;
+    delete next;
 }
 
 /**
- * @brief 删除node时，更新file_hdr_.num_pages
+ * @brief 删除node时调用，调用者持有node的写锁
  *
  * @param node
+ * @note num_pages_表示文件中已分配的页面号个数，重新打开索引时据此继续分配页面号，因此这里不减少num_pages_
+ * @note 结点先标记为已删除而保留其页面，不加锁耦合的查找可能在读到父结点之后才访问到它；
+ * 页面连同当前纪元放入pending_free_，等到删除时仍在进行的操作都结束后才链入空闲页面链表（见recycle_pending_pages）
+ * @note 之后纪元前进，删除之后开始的操作登记在新的纪元中，不会推迟本结点的回收；下一个纪元的计数项
+ * 仍被IX_OP_EPOCHS个纪元之前开始的操作占用时不前进，之后删除的结点与本结点一起等待
  */
 void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
-    file_hdr_->num_pages_--;
+    node.page_hdr->is_deleted = true;
+    refresh_pinned_pages(node.get_page_no());
+    std::lock_guard<std::mutex> lock(free_latch_);
+    uint64_t epoch = op_epoch_.load();
+    pending_free_.emplace_back(node.get_page_no(), epoch);
+    has_pending_free_.store(true, std::memory_order_release);
+    if (epoch_ops_[(epoch + 1) % IX_OP_EPOCHS].load() == 0) {
+        op_epoch_.store(epoch + 1);
+    }
+}
+
+/**
+ * @brief 开始一个操作，登记在当前纪元中，返回该纪元，结束时传给exit_op
+ * @note 读到纪元之后、计数之前纪元可能已经前进，操作被算作开始于更早的纪元，只会推迟回收；
+ * 计数项不为0时纪元不会前进到与它对应的下一个纪元，因此计数项对应的纪元在操作结束之前不变
+ */
+uint64_t IxIndexHandle::enter_op() const {
+    uint64_t epoch = op_epoch_.load();
+    epoch_ops_[epoch % IX_OP_EPOCHS].fetch_add(1);
+    return epoch;
+}
+
+/**
+ * @brief 结束一个开始于epoch的操作；某个纪元的最后一个操作结束时回收可以回收的结点
+ */
+void IxIndexHandle::exit_op(uint64_t epoch) const {
+    if (epoch_ops_[epoch % IX_OP_EPOCHS].fetch_sub(1) == 1 && has_pending_free_.load(std::memory_order_acquire)) {
+        recycle_pending_pages(false);
+    }
+}
+
+/**
+ * @brief 仍有活跃操作的最早的纪元，没有活跃操作时为当前纪元加一；调用者持有free_latch_
+ * 纪元只在对应的计数项为0时前进，因此活跃操作都开始于最近的IX_OP_EPOCHS个纪元中
+ */
+uint64_t IxIndexHandle::min_active_epoch() const {
+    uint64_t epoch = op_epoch_.load();
+    uint64_t first = epoch + 1 >= IX_OP_EPOCHS ? epoch + 1 - IX_OP_EPOCHS : 0;
+    for (uint64_t e = first; e <= epoch; e++) {
+        if (epoch_ops_[e % IX_OP_EPOCHS].load() > 0) {
+            return e;
+        }
+    }
+    return epoch + 1;
+}
+
+/**
+ * @brief 把pending_free_中可以回收的页面链入空闲页面链表，之后create_node可以重用它们
+ * @param force 为true时不检查活跃操作，回收所有页面，只在关闭索引等确定没有其他操作时使用
+ * @note 删除时的纪元早于所有活跃操作的纪元，说明删除时仍在进行的操作都已结束；
+ * 之后开始的操作从根结点下降，不会再访问到已删除的结点
+ */
+void IxIndexHandle::recycle_pending_pages(bool force) const {
+    std::lock_guard<std::mutex> lock(free_latch_);
+    uint64_t min_epoch = force ? UINT64_MAX : min_active_epoch();
+    size_t num_kept = 0;
+    for (auto &[page_no, epoch] : pending_free_) {
+        if (epoch >= min_epoch) {
+            pending_free_[num_kept++] = {page_no, epoch};
+            continue;
+        }
+        IxNodeHandle *node = fetch_node(page_no);
+        node->page_hdr->next_free_page_no = file_hdr_->first_free_page_no_;
+        file_hdr_->first_free_page_no_ = page_no;
+        unpin_node(node, true);
+        delete node;
+    }
+    pending_free_.resize(num_kept);
+    has_pending_free_.store(num_kept > 0, std::memory_order_release);
 }
 
 /**
@@ -511,6 +2142,7 @@ void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx) {
         int child_page_no = node->value_at(child_idx);
         IxNodeHandle *child = fetch_node(child_page_no);
         child->set_parent_page_no(node->get_page_no());
-        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        unpin_node(child, true);
+        delete child;
     }
-}
\ No newline at end of file
+}
@@ -10,12 +10,22 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+
+#include "ix_adaptive_hash.h"
+#include "ix_bloom_filter.h"
+#include "ix_change_buffer.h"
 #include "ix_defs.h"
+#include "ix_side_log.h"
 #include "transaction/transaction.h"
 
 enum class Operation { FIND = 0, INSERT, DELETE };  // 三种操作：查找、插入、删除
 
-static const bool binary_search = false;
+static const bool binary_search = true;
 
 inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
     switch (type) {
@@ -46,36 +56,86 @@ inline int ix_compare(const char* a, const char* b, const std::vector<ColType>&
     return 0;
 }
 
-/* 管理B+树中的每个节点 */
+/**
+ * @brief 返回a和b的最长公共前缀的长度
+ */
+inline int ix_common_prefix(const char *a, const char *b, int len) {
+    int i = 0;
+    while (i < len && a[i] == b[i]) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief 返回key去掉末尾的0之后的长度；按字节比较时，末尾的0可以省略，读取时再补齐
+ */
+inline int ix_significant_len(const char *key, int len) {
+    while (len > 0 && key[len - 1] == 0) {
+        len--;
+    }
+    return len;
+}
+
+/**
+ * @brief 后缀截断：求满足 left < sep <= right 的最短分隔key，即right的前 LCP(left, right) + 1 个字节，其余字节补0
+ * @note 只适用于按字节比较的key，且要求 left < right
+ */
+inline void ix_make_separator(const char *left, const char *right, int len, char *sep) {
+    int n = std::min(ix_common_prefix(left, right, len) + 1, len);
+    memcpy(sep, right, n);
+    memset(sep + n, 0, len - n);
+}
+
+/* 管理B+树中的每个节点
+ * 页面布局：| IxPageHdr | high key | prefix | key_0 ... key_{n-1} | ... 空闲 ... | rid_{n-1} ... rid_0 |
+ * high key是结点中所有key的严格上界（B-link树），等于父结点中右兄弟的分隔key，固定占col_tot_len字节；
+ * 查找沿next_leaf（内部结点中为同一层的右兄弟）向右移动，即可越过并发的分裂
+ * 未压缩时prefix为空，每个key占col_tot_len字节；压缩时（file_hdr->key_compress_）结点内的key共享长度为prefix_len的
+ * 公共前缀，每个key只存放前缀之后的key_len个字节，省略的末尾部分视为0。rid从页面末尾向前存放，
+ * 因此key区和rid区的边界随键值对数量和key_len变化
+ * @note 压缩的内部结点中第0个key不参与查找（总是进入第0棵子树），也不参与计算prefix_len和key_len，其内容无意义
+ */
 class IxNodeHandle {
     friend class IxIndexHandle;
     friend class IxScan;
+    friend class IxBulkLoader;
 
    private:
     const IxFileHdr *file_hdr;      // 节点所在文件的头部信息
     Page *page;                     // 存储节点的页面
     IxPageHdr *page_hdr;            // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
-    char *keys;                     // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
-    Rid *rids;                      // page->data的第三部分，指针指向首地址
 
    public:
+    /* 可用于存放键值对的字节数 */
+    static int usable_bytes(const IxFileHdr *file_hdr) {
+        return PAGE_SIZE - static_cast<int>(sizeof(IxPageHdr)) - file_hdr->col_tot_len_;
+    }
+
     IxNodeHandle() = default;
 
     IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
         page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
-        keys = page->get_data() + sizeof(IxPageHdr);
-        rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
     }
 
-    int get_size() { return page_hdr->num_key; }
+    int get_size() const { return page_hdr->num_key; }
 
-    void set_size(int size) { page_hdr->num_key = size; }
+    /* 键值对的数量或位置改变时都会调用，同时增加结点的版本号 */
+    void set_size(int size) {
+        page_hdr->num_key = size;
+        page_hdr->version++;
+    }
 
-    int get_max_size() { return file_hdr->btree_order_ + 1; }
+    int get_max_size() const { return file_hdr->btree_order_ + 1; }
 
-    int get_min_size() { return get_max_size() / 2; }
+    int get_min_size() const { return get_max_size() / 2; }
 
-    int key_at(int i) { return *(int *)get_key(i); }
+    /* 第i个key的第一个字段按INT解码后的值，用于测试 */
+    int key_at(int i) const {
+        char key[IX_MAX_COL_LEN], raw[IX_MAX_COL_LEN];
+        get_full_key(i, key);
+        return *reinterpret_cast<int *>(file_hdr->decode_key(key, raw));
+    }
 
     /* 得到第i个孩子结点的page_no */
     page_id_t value_at(int i) { return get_rid(i)->page_no; }
@@ -90,29 +150,83 @@ class IxNodeHandle {
 
     page_id_t get_parent_page_no() { return page_hdr->parent; }
 
-    bool is_leaf_page() { return page_hdr->is_leaf; }
+    bool is_leaf_page() const { return page_hdr->is_leaf; }
 
     bool is_root_page() { return get_parent_page_no() == INVALID_PAGE_ID; }
 
+    bool is_compressed() const { return file_hdr->key_compress_; }
+
+    bool is_deleted() const { return page_hdr->is_deleted; }
+
+    bool has_high_key() const { return page_hdr->has_high_key; }
+
+    char *get_high_key() const { return page->get_data() + sizeof(IxPageHdr); }
+
+    /* 设置high key，key为nullptr表示没有上界 */
+    void set_high_key(const char *key) {
+        page_hdr->has_high_key = key != nullptr;
+        if (key != nullptr && key != get_high_key()) {
+            memcpy(get_high_key(), key, file_hdr->col_tot_len_);
+        }
+    }
+
+    /* key不小于high key，即key已经被并发的分裂或重分配移到了右兄弟 */
+    bool beyond_high_key(const char *key) const {
+        return has_high_key() && memcmp(get_high_key(), key, file_hdr->col_tot_len_) <= 0;
+    }
+
     void set_next_leaf(page_id_t page_no) { page_hdr->next_leaf = page_no; }
 
     void set_prev_leaf(page_id_t page_no) { page_hdr->prev_leaf = page_no; }
 
     void set_parent_page_no(page_id_t parent) { page_hdr->parent = parent; }
 
-    char *get_key(int key_idx) const { return keys + key_idx * file_hdr->col_tot_len_; }
+    int get_prefix_len() const { return is_compressed() ? page_hdr->prefix_len : 0; }
+
+    int get_key_len() const { return is_compressed() ? page_hdr->key_len : file_hdr->col_tot_len_; }
+
+    char *get_prefix() const { return get_high_key() + file_hdr->col_tot_len_; }
+
+    /* 第key_idx个key在结点中存放的部分；未压缩时即为完整的key */
+    char *get_key(int key_idx) const { return get_prefix() + get_prefix_len() + key_idx * get_key_len(); }
 
-    Rid *get_rid(int rid_idx) const { return &rids[rid_idx]; }
+    Rid *get_rid(int rid_idx) const { return reinterpret_cast<Rid *>(page->get_data() + PAGE_SIZE) - (rid_idx + 1); }
 
-    void set_key(int key_idx, const char *key) { memcpy(keys + key_idx * file_hdr->col_tot_len_, key, file_hdr->col_tot_len_); }
+    void get_full_key(int key_idx, char *dst) const;
 
-    void set_rid(int rid_idx, const Rid &rid) { rids[rid_idx] = rid; }
+    int compare_key(int key_idx, const char *target) const;
+
+    void get_entries(std::vector<char> *keys, std::vector<Rid> *rids) const;
+
+    void assign(const char *keys, const Rid *rids, int n);
+
+    int get_used_bytes() const { return get_prefix_len() + get_size() * (get_key_len() + static_cast<int>(sizeof(Rid))); }
+
+    int encoded_bytes(const char *keys, int n) const;
+
+    bool fits(const char *keys, int n) const {
+        return n <= file_hdr->btree_order_ && encoded_bytes(keys, n) <= usable_bytes(file_hdr);
+    }
+
+    bool can_insert(int pos, const char *key) const;
+
+    bool can_set_key(int key_idx, const char *key) const;
+
+    bool can_absorb_split(const char *key) const;
+
+    bool is_underflow(int num_removed = 0) const;
+
+    void set_key(int key_idx, const char *key);
+
+    void set_rid(int rid_idx, const Rid &rid) { *get_rid(rid_idx) = rid; }
 
     int lower_bound(const char *target) const;
 
     int upper_bound(const char *target) const;
 
-    void insert_pairs(int pos, const char *key, const Rid *rid, int n);
+    int typed_bound(const char *target, int lo, int hi, bool upper) const;
+
+    int compressed_bound(const char *target, int lo, int hi, bool upper) const;
 
     page_id_t internal_lookup(const char *key);
 
@@ -120,8 +234,7 @@ class IxNodeHandle {
 
     int insert(const char *key, const Rid &value);
 
-    // 用于在结点中的指定位置插入单个键值对
-    void insert_pair(int pos, const char *key, const Rid &rid) { insert_pairs(pos, key, &rid, 1); }
+    void insert_pair(int pos, const char *key, const Rid &rid);
 
     void erase_pair(int pos);
 
@@ -155,19 +268,59 @@ class IxNodeHandle {
         assert(rid_idx < page_hdr->num_key);
         return rid_idx;
     }
+
+   private:
+    bool fits_in_place(const char *key) const;
+
+    int bytes_after(int pos, const char *key, bool replace) const;
+};
+
+/* 批量查找时记录的下降路径上的内部结点，以及进入该结点时读到的high key */
+struct IxPathEntry {
+    page_id_t page_no;
+    bool has_high_key;
+    std::vector<char> high_key;
 };
 
-/* B+树 */
+/* B+树
+ * 公有接口中的key由各字段的原始值拼接而成，进入B+树时先编码为规范化的key（IxFileHdr::encode_key），
+ * 结点中只存放规范化的key，所有比较都是memcmp */
 class IxIndexHandle {
     friend class IxScan;
     friend class IxManager;
+    friend class IxBulkLoader;
+    friend class IxOpGuard;
 
    private:
     DiskManager *disk_manager_;
     BufferPoolManager *buffer_pool_manager_;
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
-    std::mutex root_latch_;
+    std::mutex root_latch_;                     // 悲观写操作在确定根结点不会改变之前持有
+    std::mutex file_hdr_latch_;                 // 保护file_hdr_中的页面计数
+    std::unique_ptr<IxBloomFilter> bloom_;      // 未启用Bloom过滤器时为空
+    std::shared_mutex bloom_latch_;             // 重建Bloom过滤器时持有写锁，查找和插入持有读锁
+    std::atomic<page_id_t> append_leaf_{IX_NO_PAGE};  // 最近一次在末尾追加键值对的最右叶子结点，没有时为IX_NO_PAGE
+    std::unique_ptr<IxChangeBuffer> change_buffer_;   // 未启用change buffer时为空
+    std::shared_mutex change_latch_;                  // 取出并合并暂存的修改时持有写锁，检查是否有暂存的修改时持有读锁
+    IxAdaptiveHash adaptive_hash_;                    // 热点叶子结点中的key到其位置的哈希索引
+    // 常驻缓冲池的上层结点（根结点和根结点的内部孩子结点）：每个页面持有一个常驻pin，前num_pinned_项有效；
+    // 根结点改变或结点被删除时去掉不再是上层结点的页面。fetch_node对这些页面的pin不经过缓冲池的latch_
+    mutable std::array<page_id_t, IX_PINNED_NODES> pinned_page_nos_{};
+    mutable std::array<Page *, IX_PINNED_NODES> pinned_pages_{};
+    mutable int num_pinned_ = 0;
+    mutable std::shared_mutex pinned_latch_;        // 查找常驻结点时持有读锁，增删常驻结点时持有写锁
+    // 被删除的结点可能仍被删除之前开始的操作访问，先连同删除时的纪元放入pending_free_，
+    // 在该纪元及之前开始的操作都结束后再链入文件中的空闲页面链表，不必等到完全没有活跃操作
+    mutable std::atomic<uint64_t> op_epoch_{0};     // 当前纪元，每删除一个结点前进一次，开始的操作登记在当前纪元中
+    mutable std::array<std::atomic<int>, IX_OP_EPOCHS> epoch_ops_{};  // 第e % IX_OP_EPOCHS项为纪元e中开始、尚未结束的操作数量
+    mutable std::mutex free_latch_;                 // 保护pending_free_、纪元的前进和file_hdr_中的空闲页面链表
+    mutable std::vector<std::pair<page_id_t, uint64_t>> pending_free_;  // 被删除的结点及删除时的纪元
+    mutable std::atomic<bool> has_pending_free_{false};
+    // 在线重建（REINDEX）：写操作持有rebuild_latch_的读锁，开始记录side log和切换到新索引时持有写锁
+    std::shared_mutex rebuild_latch_;
+    std::unique_ptr<IxSideLog> side_log_;           // 正在重建时记录对本索引的修改，否则为空
+    IxIndexHandle *forward_ = nullptr;              // 重建完成后被替换的旧索引把写操作转发给新索引
 
    public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
@@ -175,25 +328,53 @@ class IxIndexHandle {
     // for search
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
+    size_t get_values(const std::vector<const char *> &keys, std::vector<Rid> *result, Transaction *transaction);
+
+    bool probe_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
+
+    bool may_contain(const char *key);
+
     std::pair<IxNodeHandle *, bool> find_leaf_page(const char *key, Operation operation, Transaction *transaction,
                                                  bool find_first = false);
 
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
 
-    IxNodeHandle *split(IxNodeHandle *node);
+    void defer_insert(const char *key, const Rid &value, Transaction *transaction);
+
+    page_id_t split_insert(IxNodeHandle *node, int pos, const char *key, const Rid &rid, Transaction *transaction);
 
     void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction);
 
     // for delete
     bool delete_entry(const char *key, Transaction *transaction);
 
+    void defer_delete(const char *key, Transaction *transaction);
+
+    // for change buffer
+    void merge_changes(const char *lower, const char *upper, Transaction *transaction);
+
+    void merge_all_changes(Transaction *transaction);
+
+    // for online rebuild
+    void begin_rebuild();
+
+    size_t replay_side_log(IxIndexHandle *target);
+
+    std::unique_lock<std::shared_mutex> freeze_writes() { return std::unique_lock<std::shared_mutex>(rebuild_latch_); }
+
+    void finish_rebuild(IxIndexHandle *replacement);
+
+    void abort_rebuild();
+
     bool coalesce_or_redistribute(IxNodeHandle *node, Transaction *transaction = nullptr,
                                 bool *root_is_latched = nullptr);
     bool adjust_root(IxNodeHandle *old_root_node);
 
     void redistribute(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index);
 
+    bool redistribute_compressed(IxNodeHandle *neighbor_node, IxNodeHandle *node, IxNodeHandle *parent, int index);
+
     bool coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node, IxNodeHandle **parent, int index,
                   Transaction *transaction, bool *root_is_latched);
 
@@ -207,18 +388,79 @@ class IxIndexHandle {
 
    private:
     // 辅助函数
-    void update_root_page_no(page_id_t root) { file_hdr_->root_page_ = root; }
+    // 根结点页面号允许在不持有root_latch_时读取（乐观路径持有页面latch时不能再等待root_latch_）
+    void update_root_page_no(page_id_t root);
+
+    page_id_t get_root_page_no() const { return __atomic_load_n(&file_hdr_->root_page_, __ATOMIC_ACQUIRE); }
 
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
+    bool lookup_encoded(const char *key, std::vector<Rid> *result);
+
+    page_id_t insert_encoded(const char *key, const Rid &value, Transaction *transaction);
+
+    bool delete_encoded(const char *key, Transaction *transaction);
+
+    // for change buffer
+    void merge_encoded_changes(const char *lower, const char *upper, Transaction *transaction);
+
+    void apply_changes(const std::vector<std::pair<std::string, IxChangeBuffer::Change>> &changes,
+                       Transaction *transaction);
+
+    // for adaptive hash index
+    IxNodeHandle *find_hashed_key(const char *key, int *slot_no);
+
+    IxNodeHandle *find_leaf_for_lookup(const char *key, int *slot_no);
+
+    void invalidate_hashed_keys(IxNodeHandle *node);
+
+    // for bloom filter
+    bool bloom_may_contain(const char *key);
+
+    void build_bloom_filter(bool force);
+
+    std::vector<int> choose_split_points(IxNodeHandle *node, const std::vector<char> &keys, int pos);
+
+    // for latch crabbing
+    IxNodeHandle *find_append_leaf(const char *key);
+
+    IxNodeHandle *find_leaf_page_blink(const char *key, bool find_first, bool exclusive,
+                                       std::vector<IxPathEntry> *path = nullptr);
+
+    bool is_safe(IxNodeHandle *node, const char *key, Operation operation);
+
+    void release_ancestors(Transaction *transaction, bool *root_is_latched);
+
+    void release_latched_pages(Transaction *transaction);
+
     // for get/create node
     IxNodeHandle *fetch_node(int page_no) const;
 
+    void unpin_node(IxNodeHandle *node, bool is_dirty) const { unpin_page(node->page, is_dirty); }
+
+    void unpin_page(Page *page, bool is_dirty) const;
+
+    // for pinned upper-level nodes
+    Page *find_pinned_page(page_id_t page_no) const;
+
+    void pin_page(Page *page) const;
+
+    void refresh_pinned_pages(page_id_t freed) const;
+
+    void unpin_all_pinned_pages() const;
+
     IxNodeHandle *create_node();
 
-    // for maintain data structure
-    void maintain_parent(IxNodeHandle *node);
+    // for page recycling
+    uint64_t enter_op() const;
+
+    void exit_op(uint64_t epoch) const;
+
+    uint64_t min_active_epoch() const;
+
+    void recycle_pending_pages(bool force) const;
 
+    // for maintain data structure
     void erase_leaf(IxNodeHandle *leaf);
 
     void release_node_handle(IxNodeHandle &node);
@@ -227,4 +469,23 @@ class IxIndexHandle {
 
     // for index test
     Rid get_rid(const Iid &iid) const;
-};
\ No newline at end of file
+
+    // for index-only scan
+    void get_key(const Iid &iid, char *key) const;
+};
+
+/* 在生命周期内把一个操作登记为index的活跃操作，期间删除的结点不会被重用 */
+class IxOpGuard {
+   public:
+    explicit IxOpGuard(const IxIndexHandle *ih) : ih_(ih), epoch_(ih->enter_op()) {}
+
+    ~IxOpGuard() { ih_->exit_op(epoch_); }
+
+    IxOpGuard(const IxOpGuard &) = delete;
+
+    IxOpGuard &operator=(const IxOpGuard &) = delete;
+
+   private:
+    const IxIndexHandle *ih_;
+    uint64_t epoch_;  // 操作开始时的纪元
+};
@@ -16,11 +16,14 @@ See the Mulan PSL v2 for more details. */
 #include "system/sm_meta.h"
 #include "ix_defs.h"
 #include "ix_index_handle.h"
+#include "ix_hash_index_handle.h"
 
 class IxManager {
    private:
     DiskManager *disk_manager_;
     BufferPoolManager *buffer_pool_manager_;
+    bool bloom_filter_ = false;  // 新建的索引是否维护Bloom过滤器
+    bool change_buffer_ = false; // 新建的索引是否使用change buffer
 
    public:
     IxManager(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
@@ -54,8 +57,175 @@ class IxManager {
         return disk_manager_->is_file(ix_name);
     }
 
+    /* Bloom过滤器在关闭索引时保存到该文件，打开索引时读入 */
+    static std::string get_bloom_name(const std::string &ix_name) { return ix_name + ".bloom"; }
+
+    /* change buffer的日志文件，索引正常关闭时所有修改都已合并，该文件被删除 */
+    static std::string get_change_log_name(const std::string &ix_name) { return ix_name + ".cbuf"; }
+
+    /**
+     * @description: 设置之后通过不带选项的create_index新建的索引是否维护Bloom过滤器，已有索引按其文件头中的选项
+     * @param {bool} enable 是否启用
+     */
+    void set_bloom_filter(bool enable) { bloom_filter_ = enable; }
+
+    /**
+     * @description: 设置之后通过不带选项的create_index新建的索引是否使用change buffer，已有索引按其文件头中的选项
+     * @param {bool} enable 是否启用
+     */
+    void set_change_buffer(bool enable) { change_buffer_ = enable; }
+
+    /* 按set_bloom_filter和set_change_buffer设置的选项创建索引 */
     void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        create_index(filename, index_cols, bloom_filter_, change_buffer_);
+    }
+
+    /**
+     * @param bloom_filter 是否为索引维护Bloom过滤器，查找前先用它排除不存在的key
+     * @param change_buffer 是否用change buffer暂存执行器对索引的修改，读到相应的key或暂存的修改过多时再合并
+     */
+    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols, bool bloom_filter,
+                      bool change_buffer = false) {
+        create_index_file(get_index_name(filename, index_cols), index_cols, bloom_filter, change_buffer);
+    }
+
+    /* 在线重建索引时新索引先构建在该文件中，完成后替换原来的文件 */
+    static std::string get_rebuild_name(const std::string &ix_name) { return ix_name + ".reindex"; }
+
+    /**
+     * @brief 为ih创建并打开用于在线重建的新索引文件，字段和选项（Bloom过滤器、change buffer）与ih相同
+     * 上次重建中途失败遗留的文件先删除
+     */
+    std::unique_ptr<IxIndexHandle> create_rebuild_index(const IxIndexHandle *ih, const std::vector<ColMeta>& index_cols) {
+        std::string rebuild_name = get_rebuild_name(disk_manager_->get_file_name(ih->fd_));
+        if (disk_manager_->is_file(rebuild_name)) {
+            destroy_index_file(rebuild_name);
+        }
+        create_index_file(rebuild_name, index_cols, ih->file_hdr_->bloom_bits_per_key_ > 0, ih->file_hdr_->change_buffer_);
+        return open_index_file(rebuild_name);
+    }
+
+    /**
+     * @brief 用已经关闭的重建文件替换索引ix_name的文件（连同页面映射文件和保存的Bloom过滤器），之后可用open_index打开
+     * @note 旧文件可能仍被被替换的IxIndexHandle打开，rename之后它读写的是已经没有名字的旧文件，不影响新文件
+     */
+    void install_rebuilt_index(const std::string &ix_name) {
+        std::string rebuild_name = get_rebuild_name(ix_name);
+        disk_manager_->rename_file(rebuild_name, ix_name);
+        if (disk_manager_->is_file(get_bloom_name(rebuild_name))) {
+            disk_manager_->rename_file(get_bloom_name(rebuild_name), get_bloom_name(ix_name));
+        }
+    }
+
+    /**
+     * @brief 重建失败时关闭并删除重建文件
+     */
+    void discard_rebuild_index(IxIndexHandle *ih) {
+        std::string rebuild_name = disk_manager_->get_file_name(ih->fd_);
+        ih->unpin_all_pinned_pages();
+        buffer_pool_manager_->remove_all_pages(ih->fd_);
+        disk_manager_->close_file(ih->fd_);
+        destroy_index_file(rebuild_name);
+    }
+
+    void destroy_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        destroy_index_file(get_index_name(filename, index_cols));
+    }
+
+    void destroy_index(const std::string &filename, const std::vector<std::string>& index_cols) {
+        destroy_index_file(get_index_name(filename, index_cols));
+    }
+
+    // 注意这里打开文件，创建并返回了index file handle的指针
+    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        return open_index_file(get_index_name(filename, index_cols));
+    }
+
+    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<std::string>& index_cols) {
+        return open_index_file(get_index_name(filename, index_cols));
+    }
+
+    void close_index(IxIndexHandle *ih) {
+        if (ih->change_buffer_ != nullptr) {
+            // 关闭前合并所有暂存的修改，之后不再需要日志
+            ih->merge_all_changes(nullptr);
+            ih->change_buffer_.reset();
+            disk_manager_->destroy_file(get_change_log_name(disk_manager_->get_file_name(ih->fd_)));
+        }
+        if (ih->bloom_ != nullptr) {
+            ih->bloom_->save(get_bloom_name(disk_manager_->get_file_name(ih->fd_)));
+        }
+        // 没有其他操作时，把还未回收的结点链入空闲页面链表，随文件头一起保存
+        ih->recycle_pending_pages(true);
+        ih->unpin_all_pinned_pages();
+        char* data = new char[ih->file_hdr_->tot_len_];
+        ih->file_hdr_->serialize(data);
+        disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
+        // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
+        buffer_pool_manager_->flush_all_pages(ih->fd_);
+        buffer_pool_manager_->remove_all_pages(ih->fd_);
+        disk_manager_->close_file(ih->fd_);
+    }
+
+    /**
+     * @brief 创建可扩展哈希索引文件：文件头、一个目录页和一个桶页，初始全局深度为0
+     * 与B+树索引使用相同的文件名，一组字段上只能建立一个索引
+     */
+    void create_hash_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+        std::string ix_name = get_index_name(filename, index_cols);
+        disk_manager_->create_file(ix_name);
+        int fd = disk_manager_->open_file(ix_name);
+
+        IxHashFileHdr fhdr;
+        fhdr.num_pages_ = IX_HASH_INIT_NUM_PAGES;
+        fhdr.global_depth_ = 0;
+        fhdr.col_num_ = index_cols.size();
+        fhdr.col_tot_len_ = 0;
+        for (auto &col : index_cols) {
+            fhdr.col_types_.push_back(col.type);
+            fhdr.col_lens_.push_back(col.len);
+            fhdr.col_tot_len_ += col.len;
+        }
+        if (fhdr.col_tot_len_ > IX_MAX_COL_LEN) {
+            throw InvalidColLengthError(fhdr.col_tot_len_);
+        }
+        fhdr.bucket_capacity_ = (PAGE_SIZE - sizeof(IxHashBucketHdr)) / (fhdr.col_tot_len_ + sizeof(Rid));
+        fhdr.dir_pages_.push_back(IX_HASH_INIT_DIR_PAGE);
+
+        char page_buf[PAGE_SIZE];
+        memset(page_buf, 0, PAGE_SIZE);
+        fhdr.serialize(page_buf);
+        disk_manager_->write_page(fd, IX_HASH_FILE_HDR_PAGE, page_buf, PAGE_SIZE);
+        // 唯一的目录项指向唯一的桶
+        memset(page_buf, 0, PAGE_SIZE);
+        *reinterpret_cast<page_id_t *>(page_buf) = IX_HASH_INIT_BUCKET_PAGE;
+        disk_manager_->write_page(fd, IX_HASH_INIT_DIR_PAGE, page_buf, PAGE_SIZE);
+        memset(page_buf, 0, PAGE_SIZE);
+        *reinterpret_cast<IxHashBucketHdr *>(page_buf) = {.local_depth = 0, .num_entries = 0};
+        disk_manager_->write_page(fd, IX_HASH_INIT_BUCKET_PAGE, page_buf, PAGE_SIZE);
+
+        disk_manager_->close_file(fd);
+    }
+
+    std::unique_ptr<IxHashIndexHandle> open_hash_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
         std::string ix_name = get_index_name(filename, index_cols);
+        int fd = disk_manager_->open_file(ix_name);
+        return std::make_unique<IxHashIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
+    }
+
+    void close_hash_index(const IxHashIndexHandle *ih) {
+        char page_buf[PAGE_SIZE];
+        memset(page_buf, 0, PAGE_SIZE);
+        ih->file_hdr_.serialize(page_buf);
+        disk_manager_->write_page(ih->fd_, IX_HASH_FILE_HDR_PAGE, page_buf, PAGE_SIZE);
+        buffer_pool_manager_->flush_all_pages(ih->fd_);
+        buffer_pool_manager_->remove_all_pages(ih->fd_);
+        disk_manager_->close_file(ih->fd_);
+    }
+
+   private:
+    void create_index_file(const std::string &ix_name, const std::vector<ColMeta>& index_cols, bool bloom_filter,
+                           bool change_buffer) {
         // Create index file
         disk_manager_->create_file(ix_name);
         // Open index file
@@ -73,9 +243,19 @@ class IxManager {
         if (col_tot_len > IX_MAX_COL_LEN) {
             throw InvalidColLengthError(col_tot_len);
         }
-        // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
+        // 根据 |page_hdr| + |high_key| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order，high_key占|attr|字节
         // 即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
-        int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
+        int usable_bytes = static_cast<int>(PAGE_SIZE - sizeof(IxPageHdr)) - col_tot_len;
+        int btree_order = static_cast<int>(usable_bytes / (col_tot_len + sizeof(Rid)) - 1);
+        std::vector<ColType> col_types;
+        for (auto &col : index_cols) {
+            col_types.push_back(col.type);
+        }
+        if (IxFileHdr::use_key_compression(col_types)) {
+            // 压缩之后结点能容纳的键值对数量取决于key的内容，由结点的剩余空间决定是否分裂，
+            // btree_order只作为键值对数量的上限，按每个键值对至少占用 1 + |rid| 字节估计
+            btree_order = static_cast<int>(usable_bytes / (1 + sizeof(Rid)) - 1);
+        }
         assert(btree_order > 2);
 
         // Create file header and write to file
@@ -86,6 +266,8 @@ class IxManager {
             fhdr->col_types_.push_back(index_cols[i].type);
             fhdr->col_lens_.push_back(index_cols[i].len);
         }
+        fhdr->bloom_bits_per_key_ = bloom_filter ? IX_BLOOM_BITS_PER_KEY : 0;
+        fhdr->change_buffer_ = change_buffer;
         fhdr->update_tot_len();
         
         char* data = new char[fhdr->tot_len_];
@@ -133,35 +315,47 @@ class IxManager {
         disk_manager_->close_file(fd);
     }
 
-    void destroy_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
-        std::string ix_name = get_index_name(filename, index_cols);
-        disk_manager_->destroy_file(ix_name);
+    std::unique_ptr<IxIndexHandle> open_index_file(const std::string &ix_name) {
+        int fd = disk_manager_->open_file(ix_name);
+        auto ih = std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
+        open_bloom_filter(ih.get(), ix_name);
+        open_change_buffer(ih.get(), ix_name);
+        return ih;
     }
 
-    void destroy_index(const std::string &filename, const std::vector<std::string>& index_cols) {
-        std::string ix_name = get_index_name(filename, index_cols);
+    void destroy_index_file(const std::string &ix_name) {
         disk_manager_->destroy_file(ix_name);
+        for (auto &name : {get_bloom_name(ix_name), get_change_log_name(ix_name)}) {
+            if (disk_manager_->is_file(name)) {
+                disk_manager_->destroy_file(name);
+            }
+        }
     }
 
-    // 注意这里打开文件，创建并返回了index file handle的指针
-    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
-        std::string ix_name = get_index_name(filename, index_cols);
-        int fd = disk_manager_->open_file(ix_name);
-        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
-    }
-
-    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<std::string>& index_cols) {
-        std::string ix_name = get_index_name(filename, index_cols);
-        int fd = disk_manager_->open_file(ix_name);
-        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
+    /**
+     * @brief 启用了change buffer时打开其日志，重放上次没有合并的修改（上次没有正常关闭）
+     */
+    void open_change_buffer(IxIndexHandle *ih, const std::string &ix_name) {
+        if (ih->file_hdr_->change_buffer_) {
+            ih->change_buffer_ = std::make_unique<IxChangeBuffer>(get_change_log_name(ix_name), ih->file_hdr_->col_tot_len_);
+        }
     }
 
-    void close_index(const IxIndexHandle *ih) {
-        char* data = new char[ih->file_hdr_->tot_len_];
-        ih->file_hdr_->serialize(data);
-        disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
-        // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
-        buffer_pool_manager_->flush_all_pages(ih->fd_);
-        disk_manager_->close_file(ih->fd_);
+    /**
+     * @brief 读入关闭索引时保存的Bloom过滤器，没有保存的过滤器（如上次没有正常关闭）时扫描索引重建
+     * 读入后即删除该文件，使得之后若没有正常关闭，下次打开时不会用到过期的过滤器
+     */
+    void open_bloom_filter(IxIndexHandle *ih, const std::string &ix_name) {
+        if (ih->file_hdr_->bloom_bits_per_key_ == 0) {
+            return;
+        }
+        std::string bloom_name = get_bloom_name(ix_name);
+        if (disk_manager_->is_file(bloom_name)) {
+            ih->bloom_ = IxBloomFilter::load(bloom_name);
+            disk_manager_->destroy_file(bloom_name);
+        }
+        if (ih->bloom_ == nullptr) {
+            ih->build_bloom_filter(true);
+        }
     }
 };
\ No newline at end of file
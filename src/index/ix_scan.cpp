@@ -11,12 +11,20 @@ See the Mulan PSL v2 for more details. */
 #include "ix_scan.h"
 
 /**
- * @brief 
- * @todo 加上读锁（需要使用缓冲池得到page）
+ * @brief 移动到下一个索引槽
+ * @note 每次只对当前叶子结点加读锁，读取完毕后立即释放
  */
 void IxScan::next() {
     assert(!is_end());
+    if (reverse_) {
+        bound_ = iid_;
+        if (!is_end()) {
+            iid_ = prev_slot(bound_);
+        }
+        return;
+    }
     IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
+    node->page->rlatch();
     assert(node->is_leaf_page());
     assert(iid_.slot_no < node->get_size());
     // increment slot no
@@ -26,6 +34,34 @@ void IxScan::next() {
         iid_.slot_no = 0;
         iid_.page_no = node->get_next_leaf();
     }
+    node->page->runlatch();
+    ih_->unpin_node(node, false);
+    delete node;
+}
+
+/**
+ * @brief 返回iid的前一个索引槽，iid位于叶子结点开头时沿prev_leaf移动到前驱叶子的最后一个键值对
+ * @note 调用者保证iid之前还有键值对，即iid不是第一个叶子的第一个索引槽
+ */
+Iid IxScan::prev_slot(Iid iid) const {
+    while (iid.slot_no == 0) {
+        IxNodeHandle *node = ih_->fetch_node(iid.page_no);
+        node->page->rlatch();
+        iid.page_no = node->get_prev_leaf();
+        node->page->runlatch();
+        ih_->unpin_node(node, false);
+        delete node;
+        assert(iid.page_no != IX_LEAF_HEADER_PAGE);
+
+        IxNodeHandle *prev = ih_->fetch_node(iid.page_no);
+        prev->page->rlatch();
+        iid.slot_no = prev->get_size();
+        prev->page->runlatch();
+        ih_->unpin_node(prev, false);
+        delete prev;
+    }
+    iid.slot_no--;
+    return iid;
 }
 
 Rid IxScan::rid() const {
@@ -17,22 +17,47 @@ See the Mulan PSL v2 for more details. */
 
 // 用于遍历叶子结点
 // 用于直接遍历叶子结点，而不用findleafpage来得到叶子结点
+// 正向扫描按key升序遍历[lower, upper)；反向扫描沿prev_leaf按key降序遍历同一区间
 // TODO：对page遍历时，要加上读锁
 class IxScan : public RecScan {
     const IxIndexHandle *ih_;
-    Iid iid_;  // 初始为lower（用于遍历的指针）
-    Iid end_;  // 初始为upper
+    Iid iid_;  // 当前索引槽，正向扫描时初始为lower（用于遍历的指针）
+    Iid end_;  // 正向扫描时为upper，反向扫描时为lower
+    Iid bound_;  // 反向扫描时为当前索引槽的后一个位置，初始为upper，到达end_时扫描结束
     BufferPoolManager *bpm_;
+    bool reverse_;
+    uint64_t op_epoch_;  // 扫描开始时的纪元
 
    public:
-    IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm)
-        : ih_(ih), iid_(lower), end_(upper), bpm_(bpm) {}
+    IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm, bool reverse = false)
+        : ih_(ih), iid_(lower), end_(upper), bpm_(bpm), reverse_(reverse) {
+        // 扫描期间登记为活跃操作，经过的叶子结点即使被删除也不会被重用
+        op_epoch_ = ih_->enter_op();
+        if (reverse_) {
+            end_ = lower;
+            bound_ = upper;
+            if (!is_end()) {
+                iid_ = prev_slot(bound_);
+            }
+        }
+    }
+
+    ~IxScan() { ih_->exit_op(op_epoch_); }
+
+    IxScan(const IxScan &) = delete;
+
+    IxScan &operator=(const IxScan &) = delete;
 
     void next() override;
 
-    bool is_end() const override { return iid_ == end_; }
+    bool is_end() const override { return reverse_ ? bound_ == end_ : iid_ == end_; }
 
     Rid rid() const override;
 
+    void key(char *key) const { ih_->get_key(iid_, key); }
+
     const Iid &iid() const { return iid_; }
+
+   private:
+    Iid prev_slot(Iid iid) const;
 };
\ No newline at end of file
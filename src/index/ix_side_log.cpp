@@ -0,0 +1,33 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "ix_side_log.h"
+
+void IxSideLog::add_insert(const char *key, const Rid &rid) {
+    std::lock_guard<std::mutex> lock(latch_);
+    entries_.push_back({true, std::string(key, key_len_), rid});
+}
+
+void IxSideLog::add_delete(const char *key) {
+    std::lock_guard<std::mutex> lock(latch_);
+    entries_.push_back({false, std::string(key, key_len_), Rid{-1, -1}});
+}
+
+std::vector<IxSideLog::Entry> IxSideLog::take_all() {
+    std::lock_guard<std::mutex> lock(latch_);
+    std::vector<Entry> entries;
+    entries.swap(entries_);
+    return entries;
+}
+
+size_t IxSideLog::size() const {
+    std::lock_guard<std::mutex> lock(latch_);
+    return entries_.size();
+}
@@ -0,0 +1,46 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ix_defs.h"
+
+/**
+ * @description: 在线重建索引（REINDEX）期间记录对旧索引的修改，新索引构建完成后按原来的顺序重放
+ * 只保存在内存中，key为规范化的key；重建期间写操作并发追加，重建线程分批取出
+ */
+class IxSideLog {
+   public:
+    struct Entry {
+        bool is_insert;     // 插入(key, rid)，否则删除key
+        std::string key;
+        Rid rid;
+    };
+
+    explicit IxSideLog(int key_len) : key_len_(key_len) {}
+
+    void add_insert(const char *key, const Rid &rid);
+
+    void add_delete(const char *key);
+
+    /* 按追加的顺序取出所有修改并清空 */
+    std::vector<Entry> take_all();
+
+    size_t size() const;
+
+   private:
+    int key_len_;
+    mutable std::mutex latch_;
+    std::vector<Entry> entries_;
+};
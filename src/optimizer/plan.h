@@ -28,6 +28,7 @@ typedef enum PlanTag{
     T_DropTable,
     T_CreateIndex,
     T_DropIndex,
+    T_Reindex,
     T_Insert,
     T_Update,
     T_Delete,
@@ -38,7 +39,10 @@ typedef enum PlanTag{
     T_Transaction_rollback,
     T_SeqScan,
     T_IndexScan,
+    T_IndexOnlyScan,
     T_NestLoop,
+    T_HashJoin,
+    T_MergeJoin,
     T_Sort,
     T_Projection
 } PlanTag;
@@ -74,6 +78,8 @@ class ScanPlan : public Plan
         size_t len_;                               
         std::vector<Condition> fed_conds_;
         std::vector<std::string> index_col_names_;
+        // 索引扫描是否按key降序进行（用索引的顺序满足ORDER BY ... DESC）
+        bool reverse_ = false;
     
 };
 
@@ -159,17 +165,20 @@ class DMLPlan : public Plan
 class DDLPlan : public Plan
 {
     public:
-        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols)
+        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols,
+                IndexType index_type = INDEX_BTREE)
         {
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);
             cols_ = std::move(cols);
             tab_col_names_ = std::move(col_names);
+            index_type_ = index_type;
         }
         ~DDLPlan(){}
         std::string tab_name_;
         std::vector<std::string> tab_col_names_;
         std::vector<ColDef> cols_;
+        IndexType index_type_;  // create index时索引的类型
 };
 
 // help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
@@ -22,16 +22,140 @@ See the Mulan PSL v2 for more details. */
 #include "index/ix.h"
 #include "record_printer.h"
 
-// 目前的索引匹配规则为：完全匹配索引字段，且全部为单点查询，不会自动调整where条件的顺序
+/**
+ * @brief 为表tab_name选择扫描使用的索引
+ * 索引匹配规则：从索引的第一个字段开始，依次匹配where中的等值条件，得到最长的等值前缀（与条件的顺序无关），
+ * 其后的一个字段还可以匹配一个范围条件（<, >, <=, >=）；在表上的所有索引中选择等值前缀最长的，
+ * 相同时选择还能匹配范围条件的；哈希索引只有所有字段都有等值条件时可用，
+ * 此时优先于等值前缀同样长、但没有范围条件的B+树索引
+ * @note 用索引扫描代替顺序扫描要求索引中恰好有表中每条记录的一项：索引都是唯一索引，
+ * CREATE INDEX、INSERT和UPDATE遇到重复的key都会报错，不会只把其中一条记录放进索引
+ *
+ * @param index_col_names 选中的索引包含的全部字段
+ * @return 是否有可用的索引
+ */
 bool Planner::get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names) {
     index_col_names.clear();
-    for(auto& cond: curr_conds) {
-        if(cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.tab_name.compare(tab_name) == 0)
-            index_col_names.push_back(cond.lhs_col.col_name);
-    }
+    auto has_cond = [&](const std::string &col_name, bool is_eq) {
+        for (auto &cond : curr_conds) {
+            if (!cond.is_rhs_val || cond.lhs_col.tab_name != tab_name || cond.lhs_col.col_name != col_name) {
+                continue;
+            }
+            if (is_eq ? cond.op == OP_EQ : (cond.op != OP_EQ && cond.op != OP_NE)) {
+                return true;
+            }
+        }
+        return false;
+    };
     TabMeta& tab = sm_manager_->db_.get_table(tab_name);
-    if(tab.is_index(index_col_names)) return true;
-    return false;
+    int best_score = 0;
+    for (auto &index : tab.indexes) {
+        int num_eq = 0;
+        while (num_eq < index.col_num && has_cond(index.cols[num_eq].name, true)) {
+            num_eq++;
+        }
+        int score;
+        if (index.type == INDEX_HASH) {
+            score = num_eq == index.col_num ? num_eq * 4 + 1 : 0;
+        } else {
+            bool has_range = num_eq < index.col_num && has_cond(index.cols[num_eq].name, false);
+            score = num_eq * 4 + has_range * 2;
+        }
+        if (score > best_score) {
+            best_score = score;
+            index_col_names.clear();
+            for (auto &col : index.cols) {
+                index_col_names.push_back(col.name);
+            }
+        }
+    }
+    return best_score > 0;
+}
+
+/**
+ * @brief 判断索引是否覆盖查询在表tab_name上用到的所有字段：选取的字段、扫描条件、连接条件和排序字段
+ * 覆盖时可以只扫描索引，由叶子结点中的key直接构造元组
+ */
+bool Planner::is_covering_index(std::shared_ptr<Query> query, const std::string &tab_name,
+                                const std::vector<Condition> &curr_conds, const std::vector<std::string> &index_col_names) {
+    auto in_index = [&](const std::string &col_name) {
+        return std::find(index_col_names.begin(), index_col_names.end(), col_name) != index_col_names.end();
+    };
+    auto covered = [&](const TabCol &col) { return col.tab_name != tab_name || in_index(col.col_name); };
+    for (auto &sel_col : query->cols) {
+        if (!covered(sel_col)) {
+            return false;
+        }
+    }
+    auto conds_covered = [&](const std::vector<Condition> &conds) {
+        return std::all_of(conds.begin(), conds.end(), [&](const Condition &cond) {
+            return covered(cond.lhs_col) && (cond.is_rhs_val || covered(cond.rhs_col));
+        });
+    };
+    if (!conds_covered(curr_conds) || !conds_covered(query->conds)) {
+        return false;
+    }
+    // 排序字段只有列名，与该表的字段同名时也要求在索引中
+    auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
+    if (x->has_sort) {
+        const std::string &order_col = x->order->cols->col_name;
+        if (sm_manager_->db_.get_table(tab_name).is_col(order_col) && !in_index(order_col)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 单表查询的ORDER BY字段可以由B+树索引的顺序得到时，用正向或反向的索引扫描代替排序
+ * 索引(c_0, ..., c_n)上的扫描按key有序，若c_0 ... c_{j-1}都有等值条件，扫描结果也按c_j有序；
+ * 扫描已选用的索引满足该条件时直接使用，顺序扫描时改为扫描表上满足该条件的索引；
+ * 与get_index_cols一样，依赖索引中恰好有每条记录的一项，否则改写后的扫描会少返回记录
+ *
+ * @return 扫描结果是否已经按ORDER BY的要求有序，即不再需要排序
+ */
+bool Planner::use_index_order(std::shared_ptr<Query> query, std::shared_ptr<ScanPlan> scan) {
+    auto x = std::dynamic_pointer_cast<ast::SelectStmt>(query->parse);
+    TabMeta &tab = sm_manager_->db_.get_table(scan->tab_name_);
+    const std::string &order_col = x->order->cols->col_name;
+    if (!tab.is_col(order_col)) {
+        return false;
+    }
+    auto has_eq_cond = [&](const std::string &col_name) {
+        return std::any_of(scan->conds_.begin(), scan->conds_.end(), [&](const Condition &cond) {
+            return cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.col_name == col_name;
+        });
+    };
+    auto provides_order = [&](const IndexMeta &index) {
+        if (index.type == INDEX_HASH) {
+            return false;
+        }
+        for (auto &col : index.cols) {
+            if (col.name == order_col) {
+                return true;
+            }
+            if (!has_eq_cond(col.name)) {
+                return false;
+            }
+        }
+        return false;
+    };
+    if (scan->tag == T_SeqScan) {
+        auto index = std::find_if(tab.indexes.begin(), tab.indexes.end(), provides_order);
+        if (index == tab.indexes.end()) {
+            return false;
+        }
+        scan->index_col_names_.clear();
+        for (auto &col : index->cols) {
+            scan->index_col_names_.push_back(col.name);
+        }
+        scan->tag = is_covering_index(query, scan->tab_name_, scan->conds_, scan->index_col_names_) ? T_IndexOnlyScan
+                                                                                                     : T_IndexScan;
+    } else if (!provides_order(*tab.get_index_meta(scan->index_col_names_))) {
+        return false;
+    }
+    scan->reverse_ = x->order->orderby_dir == ast::OrderBy_DESC;
+    return true;
 }
 
 /**
@@ -155,8 +279,9 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
             table_scan_executors[i] = 
                 std::make_shared<ScanPlan>(T_SeqScan, sm_manager_, tables[i], curr_conds, index_col_names);
         } else {  // 存在索引
+            PlanTag tag = is_covering_index(query, tables[i], curr_conds, index_col_names) ? T_IndexOnlyScan : T_IndexScan;
             table_scan_executors[i] =
-                std::make_shared<ScanPlan>(T_IndexScan, sm_manager_, tables[i], curr_conds, index_col_names);
+                std::make_shared<ScanPlan>(tag, sm_manager_, tables[i], curr_conds, index_col_names);
         }
     }
     // 只有一个表，不需要join。
@@ -244,10 +369,78 @@ std::shared_ptr<Plan> Planner::make_one_rel(std::shared_ptr<Query> query)
         }
     }
 
+    choose_join_method(table_join_executors);
     return table_join_executors;
 
 }
 
+/**
+ * @brief 为每个连接节点选择连接算法：
+ * 两边的索引扫描都按某个等值连接条件的列有序时使用归并连接，两边各读一遍且不需要哈希表
+ * （索引是唯一索引，每条记录在索引中恰好出现一次，见get_index_cols）；
+ * 否则连接条件中有可以作为哈希key的等值条件时使用哈希连接，都没有时使用嵌套循环连接
+ * 条件在生成连接树的过程中还会被下推到已有的连接节点，因此在连接树生成之后再选择
+ */
+void Planner::choose_join_method(std::shared_ptr<Plan> plan) {
+    auto join = std::dynamic_pointer_cast<JoinPlan>(plan);
+    if (join == nullptr) {
+        return;
+    }
+    choose_join_method(join->left_);
+    choose_join_method(join->right_);
+    join->tag = T_NestLoop;
+    for (auto it = join->conds_.begin(); it != join->conds_.end(); ++it) {
+        if (!is_hash_join_cond(*it)) {
+            continue;
+        }
+        join->tag = T_HashJoin;
+        if ((is_ordered_by(join->left_, it->lhs_col) && is_ordered_by(join->right_, it->rhs_col)) ||
+            (is_ordered_by(join->left_, it->rhs_col) && is_ordered_by(join->right_, it->lhs_col))) {
+            // MergeJoinExecutor以第一个等值条件作为归并的key
+            std::rotate(join->conds_.begin(), it, it + 1);
+            join->tag = T_MergeJoin;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 判断plan的结果是否按col升序：plan是正向的B+树索引扫描，且索引中col之前的字段都有等值条件
+ */
+bool Planner::is_ordered_by(std::shared_ptr<Plan> plan, const TabCol &col) {
+    auto scan = std::dynamic_pointer_cast<ScanPlan>(plan);
+    if (scan == nullptr || scan->tab_name_ != col.tab_name || scan->reverse_ ||
+        (scan->tag != T_IndexScan && scan->tag != T_IndexOnlyScan)) {
+        return false;
+    }
+    const IndexMeta &index = *sm_manager_->db_.get_table(scan->tab_name_).get_index_meta(scan->index_col_names_);
+    if (index.type == INDEX_HASH) {
+        return false;
+    }
+    for (auto &index_col : index.cols) {
+        if (index_col.name == col.col_name) {
+            return true;
+        }
+        bool has_eq_cond = std::any_of(scan->conds_.begin(), scan->conds_.end(), [&](const Condition &cond) {
+            return cond.is_rhs_val && cond.op == OP_EQ && cond.lhs_col.col_name == index_col.name;
+        });
+        if (!has_eq_cond) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/* 两个表中类型和长度都相同的列之间的等值条件 */
+bool Planner::is_hash_join_cond(const Condition &cond) {
+    if (cond.is_rhs_val || cond.op != OP_EQ || cond.lhs_col.tab_name == cond.rhs_col.tab_name) {
+        return false;
+    }
+    auto lhs = sm_manager_->db_.get_table(cond.lhs_col.tab_name).get_col(cond.lhs_col.col_name);
+    auto rhs = sm_manager_->db_.get_table(cond.rhs_col.tab_name).get_col(cond.rhs_col.col_name);
+    return lhs->type == rhs->type && lhs->len == rhs->len;
+}
+
 
 std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan)
 {
@@ -255,6 +448,11 @@ std::shared_ptr<Plan> Planner::generate_sort_plan(std::shared_ptr<Query> query,
     if(!x->has_sort) {
         return plan;
     }
+    if (auto scan = std::dynamic_pointer_cast<ScanPlan>(plan)) {
+        if (use_index_order(query, scan)) {
+            return plan;
+        }
+    }
     std::vector<std::string> tables = query->tables;
     std::vector<ColMeta> all_cols;
     for (auto &sel_tab_name : tables) {
@@ -315,10 +513,14 @@ std::shared_ptr<Plan> Planner::do_planner(std::shared_ptr<Query> query, Context
         plannerRoot = std::make_shared<DDLPlan>(T_DropTable, x->tab_name, std::vector<std::string>(), std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::CreateIndex>(query->parse)) {
         // create index;
-        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+        plannerRoot = std::make_shared<DDLPlan>(T_CreateIndex, x->tab_name, x->col_names, std::vector<ColDef>(),
+                                                x->is_hash ? INDEX_HASH : INDEX_BTREE);
     } else if (auto x = std::dynamic_pointer_cast<ast::DropIndex>(query->parse)) {
         // drop index
         plannerRoot = std::make_shared<DDLPlan>(T_DropIndex, x->tab_name, x->col_names, std::vector<ColDef>());
+    } else if (auto x = std::dynamic_pointer_cast<ast::Reindex>(query->parse)) {
+        // reindex
+        plannerRoot = std::make_shared<DDLPlan>(T_Reindex, x->tab_name, x->col_names, std::vector<ColDef>());
     } else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(query->parse)) {
         // insert;
         plannerRoot = std::make_shared<DMLPlan>(T_Insert, std::shared_ptr<Plan>(),  x->tab_name,  
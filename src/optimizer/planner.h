@@ -42,7 +42,15 @@ class Planner {
 
     std::shared_ptr<Plan> make_one_rel(std::shared_ptr<Query> query);
 
+    void choose_join_method(std::shared_ptr<Plan> plan);
+
+    bool is_hash_join_cond(const Condition &cond);
+
+    bool is_ordered_by(std::shared_ptr<Plan> plan, const TabCol &col);
+
     std::shared_ptr<Plan> generate_sort_plan(std::shared_ptr<Query> query, std::shared_ptr<Plan> plan);
+
+    bool use_index_order(std::shared_ptr<Query> query, std::shared_ptr<ScanPlan> scan);
     
     std::shared_ptr<Plan> generate_select_plan(std::shared_ptr<Query> query, Context *context);
 
@@ -50,6 +58,9 @@ class Planner {
     // int get_indexNo(std::string tab_name, std::vector<Condition> curr_conds);
     bool get_index_cols(std::string tab_name, std::vector<Condition> curr_conds, std::vector<std::string>& index_col_names);
 
+    bool is_covering_index(std::shared_ptr<Query> query, const std::string &tab_name,
+                           const std::vector<Condition> &curr_conds, const std::vector<std::string> &index_col_names);
+
     ColType interp_sv_type(ast::SvType sv_type) {
         std::map<ast::SvType, ColType> m = {
             {ast::SV_TYPE_INT, TYPE_INT}, {ast::SV_TYPE_FLOAT, TYPE_FLOAT}, {ast::SV_TYPE_STRING, TYPE_STRING}};
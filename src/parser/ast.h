@@ -96,9 +96,10 @@ struct DescTable : public TreeNode {
 struct CreateIndex : public TreeNode {
     std::string tab_name;
     std::vector<std::string> col_names;
+    bool is_hash;   // CREATE INDEX ... USING HASH
 
-    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_) :
-            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_, bool is_hash_ = false) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)), is_hash(is_hash_) {}
 };
 
 struct DropIndex : public TreeNode {
@@ -109,6 +110,15 @@ struct DropIndex : public TreeNode {
             tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
 };
 
+// REINDEX tb(a, b)：在线重建索引
+struct Reindex : public TreeNode {
+    std::string tab_name;
+    std::vector<std::string> col_names;
+
+    Reindex(std::string tab_name_, std::vector<std::string> col_names_) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+};
+
 struct Expr : public TreeNode {
 };
 
@@ -1136,6 +1136,16 @@ case 42:
 YY_RULE_SETUP
 #line 95 "lex.l"
 {
+    /* 只在索引DDL中出现的关键字在这里识别 */
+    if (strcasecmp(yytext, "USING") == 0) {
+        return USING;
+    }
+    if (strcasecmp(yytext, "HASH") == 0) {
+        return HASH;
+    }
+    if (strcasecmp(yytext, "REINDEX") == 0) {
+        return REINDEX;
+    }
     yylval->sv_str = yytext;
     return IDENTIFIER;
 }
@@ -21,8 +21,10 @@ int main() {
         "drop table tb;",
         "create index tb(a);",
         "create index tb(a, b, c);",
+        "create index tb(a, b) using hash;",
         "drop index tb(a, b, c);",
         "drop index tb(b);",
+        "reindex tb(a, b);",
         "insert into tb values (1, 3.14, 'pi');",
         "delete from tb where a = 1;",
         "update tb set a = 1, b = 2.2, c = 'xyz' where x = 2 and y < 1.1 and z > 'abc';",
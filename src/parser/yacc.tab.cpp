@@ -144,52 +144,55 @@ enum yysymbol_kind_t
   YYSYMBOL_TXN_ABORT = 31,                 /* TXN_ABORT  */
   YYSYMBOL_TXN_ROLLBACK = 32,              /* TXN_ROLLBACK  */
   YYSYMBOL_ORDER_BY = 33,                  /* ORDER_BY  */
-  YYSYMBOL_LEQ = 34,                       /* LEQ  */
-  YYSYMBOL_NEQ = 35,                       /* NEQ  */
-  YYSYMBOL_GEQ = 36,                       /* GEQ  */
-  YYSYMBOL_T_EOF = 37,                     /* T_EOF  */
-  YYSYMBOL_IDENTIFIER = 38,                /* IDENTIFIER  */
-  YYSYMBOL_VALUE_STRING = 39,              /* VALUE_STRING  */
-  YYSYMBOL_VALUE_INT = 40,                 /* VALUE_INT  */
-  YYSYMBOL_VALUE_FLOAT = 41,               /* VALUE_FLOAT  */
-  YYSYMBOL_42_ = 42,                       /* ';'  */
-  YYSYMBOL_43_ = 43,                       /* '('  */
-  YYSYMBOL_44_ = 44,                       /* ')'  */
-  YYSYMBOL_45_ = 45,                       /* ','  */
-  YYSYMBOL_46_ = 46,                       /* '.'  */
-  YYSYMBOL_47_ = 47,                       /* '='  */
-  YYSYMBOL_48_ = 48,                       /* '<'  */
-  YYSYMBOL_49_ = 49,                       /* '>'  */
-  YYSYMBOL_50_ = 50,                       /* '*'  */
-  YYSYMBOL_YYACCEPT = 51,                  /* $accept  */
-  YYSYMBOL_start = 52,                     /* start  */
-  YYSYMBOL_stmt = 53,                      /* stmt  */
-  YYSYMBOL_txnStmt = 54,                   /* txnStmt  */
-  YYSYMBOL_dbStmt = 55,                    /* dbStmt  */
-  YYSYMBOL_ddl = 56,                       /* ddl  */
-  YYSYMBOL_dml = 57,                       /* dml  */
-  YYSYMBOL_fieldList = 58,                 /* fieldList  */
-  YYSYMBOL_colNameList = 59,               /* colNameList  */
-  YYSYMBOL_field = 60,                     /* field  */
-  YYSYMBOL_type = 61,                      /* type  */
-  YYSYMBOL_valueList = 62,                 /* valueList  */
-  YYSYMBOL_value = 63,                     /* value  */
-  YYSYMBOL_condition = 64,                 /* condition  */
-  YYSYMBOL_optWhereClause = 65,            /* optWhereClause  */
-  YYSYMBOL_whereClause = 66,               /* whereClause  */
-  YYSYMBOL_col = 67,                       /* col  */
-  YYSYMBOL_colList = 68,                   /* colList  */
-  YYSYMBOL_op = 69,                        /* op  */
-  YYSYMBOL_expr = 70,                      /* expr  */
-  YYSYMBOL_setClauses = 71,                /* setClauses  */
-  YYSYMBOL_setClause = 72,                 /* setClause  */
-  YYSYMBOL_selector = 73,                  /* selector  */
-  YYSYMBOL_tableList = 74,                 /* tableList  */
-  YYSYMBOL_opt_order_clause = 75,          /* opt_order_clause  */
-  YYSYMBOL_order_clause = 76,              /* order_clause  */
-  YYSYMBOL_opt_asc_desc = 77,              /* opt_asc_desc  */
-  YYSYMBOL_tbName = 78,                    /* tbName  */
-  YYSYMBOL_colName = 79                    /* colName  */
+  YYSYMBOL_USING = 34,                     /* USING  */
+  YYSYMBOL_HASH = 35,                      /* HASH  */
+  YYSYMBOL_REINDEX = 36,                   /* REINDEX  */
+  YYSYMBOL_LEQ = 37,                       /* LEQ  */
+  YYSYMBOL_NEQ = 38,                       /* NEQ  */
+  YYSYMBOL_GEQ = 39,                       /* GEQ  */
+  YYSYMBOL_T_EOF = 40,                     /* T_EOF  */
+  YYSYMBOL_IDENTIFIER = 41,                /* IDENTIFIER  */
+  YYSYMBOL_VALUE_STRING = 42,              /* VALUE_STRING  */
+  YYSYMBOL_VALUE_INT = 43,                 /* VALUE_INT  */
+  YYSYMBOL_VALUE_FLOAT = 44,               /* VALUE_FLOAT  */
+  YYSYMBOL_45_ = 45,                       /* ';'  */
+  YYSYMBOL_46_ = 46,                       /* '('  */
+  YYSYMBOL_47_ = 47,                       /* ')'  */
+  YYSYMBOL_48_ = 48,                       /* ','  */
+  YYSYMBOL_49_ = 49,                       /* '.'  */
+  YYSYMBOL_50_ = 50,                       /* '='  */
+  YYSYMBOL_51_ = 51,                       /* '<'  */
+  YYSYMBOL_52_ = 52,                       /* '>'  */
+  YYSYMBOL_53_ = 53,                       /* '*'  */
+  YYSYMBOL_YYACCEPT = 54,                  /* $accept  */
+  YYSYMBOL_start = 55,                     /* start  */
+  YYSYMBOL_stmt = 56,                      /* stmt  */
+  YYSYMBOL_txnStmt = 57,                   /* txnStmt  */
+  YYSYMBOL_dbStmt = 58,                    /* dbStmt  */
+  YYSYMBOL_ddl = 59,                       /* ddl  */
+  YYSYMBOL_dml = 60,                       /* dml  */
+  YYSYMBOL_fieldList = 61,                 /* fieldList  */
+  YYSYMBOL_colNameList = 62,               /* colNameList  */
+  YYSYMBOL_field = 63,                     /* field  */
+  YYSYMBOL_type = 64,                      /* type  */
+  YYSYMBOL_valueList = 65,                 /* valueList  */
+  YYSYMBOL_value = 66,                     /* value  */
+  YYSYMBOL_condition = 67,                 /* condition  */
+  YYSYMBOL_optWhereClause = 68,            /* optWhereClause  */
+  YYSYMBOL_whereClause = 69,               /* whereClause  */
+  YYSYMBOL_col = 70,                       /* col  */
+  YYSYMBOL_colList = 71,                   /* colList  */
+  YYSYMBOL_op = 72,                        /* op  */
+  YYSYMBOL_expr = 73,                      /* expr  */
+  YYSYMBOL_setClauses = 74,                /* setClauses  */
+  YYSYMBOL_setClause = 75,                 /* setClause  */
+  YYSYMBOL_selector = 76,                  /* selector  */
+  YYSYMBOL_tableList = 77,                 /* tableList  */
+  YYSYMBOL_opt_order_clause = 78,          /* opt_order_clause  */
+  YYSYMBOL_order_clause = 79,              /* order_clause  */
+  YYSYMBOL_opt_asc_desc = 80,              /* opt_asc_desc  */
+  YYSYMBOL_tbName = 81,                    /* tbName  */
+  YYSYMBOL_colName = 82                    /* colName  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
@@ -306,7 +309,7 @@ typedef int yytype_uint16;
 
 
 /* Stored state numbers (used for stacks). */
-typedef yytype_int8 yy_state_t;
+typedef yytype_uint8 yy_state_t;
 
 /* State numbers in computations.  */
 typedef int yy_state_fast_t;
@@ -518,21 +521,21 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  39
+#define YYFINAL  41
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   112
+#define YYLAST   123
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  51
+#define YYNTOKENS  54
 /* YYNNTS -- Number of nonterminals.  */
 #define YYNNTS  29
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  69
+#define YYNRULES  71
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  127
+#define YYNSTATES  134
 
 /* YYMAXUTOK -- Last valid token kind.  */
-#define YYMAXUTOK   296
+#define YYMAXUTOK   299
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
@@ -550,9 +553,9 @@ static const yytype_int8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      43,    44,    50,     2,    45,     2,    46,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,    42,
-      48,    47,    49,     2,     2,     2,     2,     2,     2,     2,
+      46,    47,    53,     2,    48,     2,    49,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,    45,
+      51,    50,    52,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -575,7 +578,7 @@ static const yytype_int8 yytranslate[] =
        5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
       15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
       25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
-      35,    36,    37,    38,    39,    40,    41
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    44
 };
 
 #if YYDEBUG
@@ -584,11 +587,12 @@ static const yytype_int16 yyrline[] =
 {
        0,    56,    56,    61,    66,    71,    79,    80,    81,    82,
       86,    90,    94,    98,   105,   112,   116,   120,   124,   128,
-     135,   139,   143,   147,   154,   158,   165,   169,   176,   183,
-     187,   191,   198,   202,   209,   213,   217,   224,   231,   232,
-     239,   243,   250,   254,   261,   265,   272,   276,   280,   284,
-     288,   292,   299,   303,   310,   314,   321,   328,   332,   336,
-     340,   344,   351,   355,   359,   366,   367,   368,   371,   373
+     132,   136,   143,   147,   151,   155,   162,   166,   173,   177,
+     184,   191,   195,   199,   206,   210,   217,   221,   225,   232,
+     239,   240,   247,   251,   258,   262,   269,   273,   280,   284,
+     288,   292,   296,   300,   307,   311,   318,   322,   329,   336,
+     340,   344,   348,   352,   359,   363,   367,   374,   375,   376,
+     379,   381
 };
 #endif
 
@@ -608,14 +612,14 @@ static const char *const yytname[] =
   "CREATE", "TABLE", "DROP", "DESC", "INSERT", "INTO", "VALUES", "DELETE",
   "FROM", "ASC", "ORDER", "BY", "WHERE", "UPDATE", "SET", "SELECT", "INT",
   "CHAR", "FLOAT", "INDEX", "AND", "JOIN", "EXIT", "HELP", "TXN_BEGIN",
-  "TXN_COMMIT", "TXN_ABORT", "TXN_ROLLBACK", "ORDER_BY", "LEQ", "NEQ",
-  "GEQ", "T_EOF", "IDENTIFIER", "VALUE_STRING", "VALUE_INT", "VALUE_FLOAT",
-  "';'", "'('", "')'", "','", "'.'", "'='", "'<'", "'>'", "'*'", "$accept",
-  "start", "stmt", "txnStmt", "dbStmt", "ddl", "dml", "fieldList",
-  "colNameList", "field", "type", "valueList", "value", "condition",
-  "optWhereClause", "whereClause", "col", "colList", "op", "expr",
-  "setClauses", "setClause", "selector", "tableList", "opt_order_clause",
-  "order_clause", "opt_asc_desc", "tbName", "colName", YY_NULLPTR
+  "TXN_COMMIT", "TXN_ABORT", "TXN_ROLLBACK", "ORDER_BY", "USING", "HASH",
+  "REINDEX", "LEQ", "NEQ", "GEQ", "T_EOF", "IDENTIFIER", "VALUE_STRING",
+  "VALUE_INT", "VALUE_FLOAT", "';'", "'('", "')'", "','", "'.'", "'='",
+  "'<'", "'>'", "'*'", "$accept", "start", "stmt", "txnStmt", "dbStmt",
+  "ddl", "dml", "fieldList", "colNameList", "field", "type", "valueList",
+  "value", "condition", "optWhereClause", "whereClause", "col", "colList",
+  "op", "expr", "setClauses", "setClause", "selector", "tableList",
+  "opt_order_clause", "order_clause", "opt_asc_desc", "tbName", "colName", YY_NULLPTR
 };
 
 static const char *
@@ -625,12 +629,12 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-75)
+#define YYPACT_NINF (-71)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF (-69)
+#define YYTABLE_NINF (-71)
 
 #define yytable_value_is_error(Yyn) \
   0
@@ -639,19 +643,20 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int8 yypact[] =
 {
-      42,    21,     5,     8,    -2,    32,    31,    -2,   -26,   -75,
-     -75,   -75,   -75,   -75,   -75,   -75,    52,     6,   -75,   -75,
-     -75,   -75,   -75,    -2,    -2,    -2,    -2,   -75,   -75,    -2,
-      -2,    34,    13,   -75,   -75,    16,    55,    39,   -75,   -75,
-     -75,    43,    44,   -75,    45,    78,    73,    53,    54,    -2,
-      53,    53,    53,    53,    50,    54,   -75,   -75,    -4,   -75,
-      51,   -75,    -7,   -75,   -75,   -11,   -75,    -5,    22,   -75,
-      33,    24,   -75,    74,    48,    53,   -75,    24,    -2,    -2,
-      85,   -75,    53,   -75,    58,   -75,   -75,   -75,    53,   -75,
-     -75,   -75,   -75,    36,   -75,    54,   -75,   -75,   -75,   -75,
-     -75,   -75,    17,   -75,   -75,   -75,   -75,    86,   -75,   -75,
-      63,   -75,   -75,    24,   -75,   -75,   -75,   -75,    54,    60,
-     -75,     1,   -75,   -75,   -75,   -75,   -75
+      26,    22,    12,    37,   -31,    20,    27,   -31,   -38,   -71,
+     -71,   -71,   -71,   -71,   -71,   -31,   -71,    59,     0,   -71,
+     -71,   -71,   -71,   -71,   -31,   -31,   -31,   -31,   -71,   -71,
+     -31,   -31,    41,    18,   -71,   -71,    36,    65,    47,   -71,
+      51,   -71,   -71,    52,    54,   -71,    55,    78,    85,    62,
+      63,   -31,    62,    62,    62,    62,    62,    60,    63,   -71,
+     -71,     2,   -71,    57,   -71,    -1,   -71,   -71,     4,   -71,
+      38,   -71,    42,    40,    43,    33,   -71,    80,    31,    62,
+     -71,    33,   -31,   -31,    93,   -71,    62,   -71,    62,   -71,
+      64,   -71,   -71,    75,   -71,   -71,   -71,   -71,    45,   -71,
+      63,   -71,   -71,   -71,   -71,   -71,   -71,    30,   -71,   -71,
+     -71,   -71,    95,   -71,   -71,   -71,    69,    79,   -71,    33,
+     -71,   -71,   -71,   -71,    63,    66,   -71,   -71,     6,   -71,
+     -71,   -71,   -71,   -71
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -660,69 +665,72 @@ static const yytype_int8 yypact[] =
 static const yytype_int8 yydefact[] =
 {
        0,     0,     0,     0,     0,     0,     0,     0,     0,     4,
-       3,    10,    11,    12,    13,     5,     0,     0,     9,     6,
-       7,     8,    14,     0,     0,     0,     0,    68,    17,     0,
-       0,     0,    69,    57,    44,    58,     0,     0,    43,     1,
-       2,     0,     0,    16,     0,     0,    38,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,    21,    69,    38,    54,
-       0,    45,    38,    59,    42,     0,    24,     0,     0,    26,
-       0,     0,    40,    39,     0,     0,    22,     0,     0,     0,
-      63,    15,     0,    29,     0,    31,    28,    18,     0,    19,
-      36,    34,    35,     0,    32,     0,    50,    49,    51,    46,
-      47,    48,     0,    55,    56,    61,    60,     0,    23,    25,
-       0,    27,    20,     0,    41,    52,    53,    37,     0,     0,
-      33,    67,    62,    30,    66,    65,    64
+       3,    10,    11,    12,    13,     0,     5,     0,     0,     9,
+       6,     7,     8,    14,     0,     0,     0,     0,    70,    17,
+       0,     0,     0,    71,    59,    46,    60,     0,     0,    45,
+       0,     1,     2,     0,     0,    16,     0,     0,    40,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,    23,
+      71,    40,    56,     0,    47,    40,    61,    44,     0,    28,
+       0,    26,     0,     0,     0,     0,    42,    41,     0,     0,
+      24,     0,     0,     0,    65,    21,     0,    15,     0,    31,
+       0,    33,    30,    18,    20,    38,    36,    37,     0,    34,
+       0,    52,    51,    53,    48,    49,    50,     0,    57,    58,
+      63,    62,     0,    25,    29,    27,     0,     0,    22,     0,
+      43,    54,    55,    39,     0,     0,    19,    35,    69,    64,
+      32,    68,    67,    66
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-     -75,   -75,   -75,   -75,   -75,   -75,   -75,   -75,    56,    23,
-     -75,   -75,   -74,    11,   -27,   -75,    -8,   -75,   -75,   -75,
-     -75,    37,   -75,   -75,   -75,   -75,   -75,    -3,   -45
+     -71,   -71,   -71,   -71,   -71,   -71,   -71,   -71,    39,    29,
+     -71,   -71,   -70,    15,   -48,   -71,    -8,   -71,   -71,   -71,
+     -71,    44,   -71,   -71,   -71,   -71,   -71,    -3,   -47
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int8 yydefgoto[] =
+static const yytype_uint8 yydefgoto[] =
 {
-       0,    16,    17,    18,    19,    20,    21,    65,    68,    66,
-      86,    93,    94,    72,    56,    73,    74,    35,   102,   117,
-      58,    59,    36,    62,   108,   122,   126,    37,    38
+       0,    17,    18,    19,    20,    21,    22,    70,    68,    71,
+      92,    98,    99,    76,    59,    77,    78,    36,   107,   123,
+      61,    62,    37,    65,   113,   129,   133,    38,    39
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
    positive, shift that token.  If negative, reduce the rule whose
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
-static const yytype_int8 yytable[] =
+static const yytype_int16 yytable[] =
 {
-      34,    28,    60,   104,    31,    64,    67,    69,    69,   124,
-      55,    23,    32,    55,    25,   125,    83,    84,    85,    78,
-      41,    42,    43,    44,    33,    22,    45,    46,   115,    24,
-      60,    76,    26,    81,    82,    80,    27,    67,    79,   120,
-      61,    75,    29,   111,    30,     1,    63,     2,    40,     3,
-       4,     5,    39,    47,     6,    32,    90,    91,    92,   -68,
-       7,    48,     8,    90,    91,    92,    87,    88,    49,     9,
-      10,    11,    12,    13,    14,   105,   106,    89,    88,    15,
-     112,   113,    96,    97,    98,    50,    51,    52,    53,    54,
-      55,    57,    32,    71,   116,    99,   100,   101,    77,    95,
-     107,   110,   118,   119,   123,   109,   114,     0,     0,    70,
-     121,     0,   103
+      35,    29,    63,    33,    32,    67,    69,    72,    69,    69,
+      28,   109,    40,    80,   131,    34,    58,    84,    24,    58,
+     132,    43,    44,    45,    46,    82,    23,    47,    48,     1,
+      30,     2,    63,     3,     4,     5,    25,   121,     6,   114,
+      31,    72,    64,    26,     7,    42,     8,    83,    66,   127,
+      79,    85,    86,     9,    10,    11,    12,    13,    14,    41,
+      49,    27,    15,    89,    90,    91,    16,   -70,   101,   102,
+     103,    33,    95,    96,    97,    95,    96,    97,    51,   110,
+     111,   104,   105,   106,    50,    87,    88,    93,    86,    57,
+      94,    86,   118,   119,    73,    74,    52,    53,    54,   122,
+      55,    56,    58,    60,    33,   100,    75,    81,   112,   117,
+     116,   124,   125,   130,   126,   120,   128,   115,     0,     0,
+       0,     0,     0,   108
 };
 
 static const yytype_int8 yycheck[] =
 {
-       8,     4,    47,    77,     7,    50,    51,    52,    53,     8,
-      17,     6,    38,    17,     6,    14,    21,    22,    23,    26,
-      23,    24,    25,    26,    50,     4,    29,    30,   102,    24,
-      75,    58,    24,    44,    45,    62,    38,    82,    45,   113,
-      48,    45,    10,    88,    13,     3,    49,     5,    42,     7,
-       8,     9,     0,    19,    12,    38,    39,    40,    41,    46,
-      18,    45,    20,    39,    40,    41,    44,    45,    13,    27,
-      28,    29,    30,    31,    32,    78,    79,    44,    45,    37,
-      44,    45,    34,    35,    36,    46,    43,    43,    43,    11,
-      17,    38,    38,    43,   102,    47,    48,    49,    47,    25,
-      15,    43,    16,    40,    44,    82,    95,    -1,    -1,    53,
-     118,    -1,    75
+       8,     4,    49,    41,     7,    52,    53,    54,    55,    56,
+      41,    81,    15,    61,     8,    53,    17,    65,     6,    17,
+      14,    24,    25,    26,    27,    26,     4,    30,    31,     3,
+      10,     5,    79,     7,     8,     9,    24,   107,    12,    86,
+      13,    88,    50,     6,    18,    45,    20,    48,    51,   119,
+      48,    47,    48,    27,    28,    29,    30,    31,    32,     0,
+      19,    24,    36,    21,    22,    23,    40,    49,    37,    38,
+      39,    41,    42,    43,    44,    42,    43,    44,    13,    82,
+      83,    50,    51,    52,    48,    47,    48,    47,    48,    11,
+      47,    48,    47,    48,    55,    56,    49,    46,    46,   107,
+      46,    46,    17,    41,    41,    25,    46,    50,    15,    34,
+      46,    16,    43,    47,    35,   100,   124,    88,    -1,    -1,
+      -1,    -1,    -1,    79
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
@@ -730,42 +738,45 @@ static const yytype_int8 yycheck[] =
 static const yytype_int8 yystos[] =
 {
        0,     3,     5,     7,     8,     9,    12,    18,    20,    27,
-      28,    29,    30,    31,    32,    37,    52,    53,    54,    55,
-      56,    57,     4,     6,    24,     6,    24,    38,    78,    10,
-      13,    78,    38,    50,    67,    68,    73,    78,    79,     0,
-      42,    78,    78,    78,    78,    78,    78,    19,    45,    13,
-      46,    43,    43,    43,    11,    17,    65,    38,    71,    72,
-      79,    67,    74,    78,    79,    58,    60,    79,    59,    79,
-      59,    43,    64,    66,    67,    45,    65,    47,    26,    45,
-      65,    44,    45,    21,    22,    23,    61,    44,    45,    44,
-      39,    40,    41,    62,    63,    25,    34,    35,    36,    47,
-      48,    49,    69,    72,    63,    78,    78,    15,    75,    60,
-      43,    79,    44,    45,    64,    63,    67,    70,    16,    40,
-      63,    67,    76,    44,     8,    14,    77
+      28,    29,    30,    31,    32,    36,    40,    55,    56,    57,
+      58,    59,    60,     4,     6,    24,     6,    24,    41,    81,
+      10,    13,    81,    41,    53,    70,    71,    76,    81,    82,
+      81,     0,    45,    81,    81,    81,    81,    81,    81,    19,
+      48,    13,    49,    46,    46,    46,    46,    11,    17,    68,
+      41,    74,    75,    82,    70,    77,    81,    82,    62,    82,
+      61,    63,    82,    62,    62,    46,    67,    69,    70,    48,
+      68,    50,    26,    48,    68,    47,    48,    47,    48,    21,
+      22,    23,    64,    47,    47,    42,    43,    44,    65,    66,
+      25,    37,    38,    39,    50,    51,    52,    72,    75,    66,
+      81,    81,    15,    78,    82,    63,    46,    34,    47,    48,
+      67,    66,    70,    73,    16,    43,    35,    66,    70,    79,
+      47,     8,    14,    80
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
-       0,    51,    52,    52,    52,    52,    53,    53,    53,    53,
-      54,    54,    54,    54,    55,    56,    56,    56,    56,    56,
-      57,    57,    57,    57,    58,    58,    59,    59,    60,    61,
-      61,    61,    62,    62,    63,    63,    63,    64,    65,    65,
-      66,    66,    67,    67,    68,    68,    69,    69,    69,    69,
-      69,    69,    70,    70,    71,    71,    72,    73,    73,    74,
-      74,    74,    75,    75,    76,    77,    77,    77,    78,    79
+       0,    54,    55,    55,    55,    55,    56,    56,    56,    56,
+      57,    57,    57,    57,    58,    59,    59,    59,    59,    59,
+      59,    59,    60,    60,    60,    60,    61,    61,    62,    62,
+      63,    64,    64,    64,    65,    65,    66,    66,    66,    67,
+      68,    68,    69,    69,    70,    70,    71,    71,    72,    72,
+      72,    72,    72,    72,    73,    73,    74,    74,    75,    76,
+      76,    77,    77,    77,    78,    78,    79,    80,    80,    80,
+      81,    82
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
        0,     2,     2,     1,     1,     1,     1,     1,     1,     1,
-       1,     1,     1,     1,     2,     6,     3,     2,     6,     6,
-       7,     4,     5,     6,     1,     3,     1,     3,     2,     1,
-       4,     1,     1,     3,     1,     1,     1,     3,     0,     2,
-       1,     3,     3,     1,     1,     3,     1,     1,     1,     1,
-       1,     1,     1,     1,     1,     3,     3,     1,     1,     1,
-       3,     3,     3,     0,     2,     1,     1,     0,     1,     1
+       1,     1,     1,     1,     2,     6,     3,     2,     6,     8,
+       6,     5,     7,     4,     5,     6,     1,     3,     1,     3,
+       2,     1,     4,     1,     1,     3,     1,     1,     1,     3,
+       0,     2,     1,     3,     3,     1,     1,     3,     1,     1,
+       1,     1,     1,     1,     1,     1,     1,     3,     3,     1,
+       1,     1,     3,     3,     3,     0,     2,     1,     1,     0,
+       1,     1
 };
 
 
@@ -1626,7 +1637,7 @@ yyreduce:
         parse_tree = (yyvsp[-1].sv_node);
         YYACCEPT;
     }
-#line 1630 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1641 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 3: /* start: HELP  */
@@ -1635,7 +1646,7 @@ yyreduce:
         parse_tree = std::make_shared<Help>();
         YYACCEPT;
     }
-#line 1639 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1650 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 4: /* start: EXIT  */
@@ -1644,7 +1655,7 @@ yyreduce:
         parse_tree = nullptr;
         YYACCEPT;
     }
-#line 1648 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1659 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 5: /* start: T_EOF  */
@@ -1653,7 +1664,7 @@ yyreduce:
         parse_tree = nullptr;
         YYACCEPT;
     }
-#line 1657 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1668 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 10: /* txnStmt: TXN_BEGIN  */
@@ -1661,7 +1672,7 @@ yyreduce:
     {
         (yyval.sv_node) = std::make_shared<TxnBegin>();
     }
-#line 1665 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1676 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 11: /* txnStmt: TXN_COMMIT  */
@@ -1669,7 +1680,7 @@ yyreduce:
     {
         (yyval.sv_node) = std::make_shared<TxnCommit>();
     }
-#line 1673 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1684 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 12: /* txnStmt: TXN_ABORT  */
@@ -1677,7 +1688,7 @@ yyreduce:
     {
         (yyval.sv_node) = std::make_shared<TxnAbort>();
     }
-#line 1681 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1692 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 13: /* txnStmt: TXN_ROLLBACK  */
@@ -1685,7 +1696,7 @@ yyreduce:
     {
         (yyval.sv_node) = std::make_shared<TxnRollback>();
     }
-#line 1689 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1700 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 14: /* dbStmt: SHOW TABLES  */
@@ -1693,7 +1704,7 @@ yyreduce:
     {
         (yyval.sv_node) = std::make_shared<ShowTables>();
     }
-#line 1697 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1708 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 15: /* ddl: CREATE TABLE tbName '(' fieldList ')'  */
@@ -1701,7 +1712,7 @@ yyreduce:
     {
         (yyval.sv_node) = std::make_shared<CreateTable>((yyvsp[-3].sv_str), (yyvsp[-1].sv_fields));
     }
-#line 1705 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1716 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 16: /* ddl: DROP TABLE tbName  */
@@ -1709,7 +1720,7 @@ yyreduce:
     {
         (yyval.sv_node) = std::make_shared<DropTable>((yyvsp[0].sv_str));
     }
-#line 1713 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1724 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 17: /* ddl: DESC tbName  */
@@ -1717,7 +1728,7 @@ yyreduce:
     {
         (yyval.sv_node) = std::make_shared<DescTable>((yyvsp[0].sv_str));
     }
-#line 1721 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1732 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
   case 18: /* ddl: CREATE INDEX tbName '(' colNameList ')'  */
@@ -1725,385 +1736,401 @@ yyreduce:
     {
         (yyval.sv_node) = std::make_shared<CreateIndex>((yyvsp[-3].sv_str), (yyvsp[-1].sv_strs));
     }
-#line 1729 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1740 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 19: /* ddl: DROP INDEX tbName '(' colNameList ')'  */
+  case 19: /* ddl: CREATE INDEX tbName '(' colNameList ')' USING HASH  */
 #line 129 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+    {
+        (yyval.sv_node) = std::make_shared<CreateIndex>((yyvsp[-5].sv_str), (yyvsp[-3].sv_strs), true);
+    }
+#line 1748 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+    break;
+
+  case 20: /* ddl: DROP INDEX tbName '(' colNameList ')'  */
+#line 133 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DropIndex>((yyvsp[-3].sv_str), (yyvsp[-1].sv_strs));
     }
-#line 1737 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1756 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 20: /* dml: INSERT INTO tbName VALUES '(' valueList ')'  */
-#line 136 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 21: /* ddl: REINDEX tbName '(' colNameList ')'  */
+#line 137 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+    {
+        (yyval.sv_node) = std::make_shared<Reindex>((yyvsp[-3].sv_str), (yyvsp[-1].sv_strs));
+    }
+#line 1764 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+    break;
+
+  case 22: /* dml: INSERT INTO tbName VALUES '(' valueList ')'  */
+#line 144 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<InsertStmt>((yyvsp[-4].sv_str), (yyvsp[-1].sv_vals));
     }
-#line 1745 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1772 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 21: /* dml: DELETE FROM tbName optWhereClause  */
-#line 140 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 23: /* dml: DELETE FROM tbName optWhereClause  */
+#line 148 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<DeleteStmt>((yyvsp[-1].sv_str), (yyvsp[0].sv_conds));
     }
-#line 1753 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1780 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 22: /* dml: UPDATE tbName SET setClauses optWhereClause  */
-#line 144 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 24: /* dml: UPDATE tbName SET setClauses optWhereClause  */
+#line 152 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<UpdateStmt>((yyvsp[-3].sv_str), (yyvsp[-1].sv_set_clauses), (yyvsp[0].sv_conds));
     }
-#line 1761 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1788 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 23: /* dml: SELECT selector FROM tableList optWhereClause opt_order_clause  */
-#line 148 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 25: /* dml: SELECT selector FROM tableList optWhereClause opt_order_clause  */
+#line 156 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_node) = std::make_shared<SelectStmt>((yyvsp[-4].sv_cols), (yyvsp[-2].sv_strs), (yyvsp[-1].sv_conds), (yyvsp[0].sv_orderby));
     }
-#line 1769 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1796 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 24: /* fieldList: field  */
-#line 155 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 26: /* fieldList: field  */
+#line 163 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_fields) = std::vector<std::shared_ptr<Field>>{(yyvsp[0].sv_field)};
     }
-#line 1777 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1804 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 25: /* fieldList: fieldList ',' field  */
-#line 159 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 27: /* fieldList: fieldList ',' field  */
+#line 167 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_fields).push_back((yyvsp[0].sv_field));
     }
-#line 1785 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1812 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 26: /* colNameList: colName  */
-#line 166 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 28: /* colNameList: colName  */
+#line 174 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_strs) = std::vector<std::string>{(yyvsp[0].sv_str)};
     }
-#line 1793 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1820 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 27: /* colNameList: colNameList ',' colName  */
-#line 170 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 29: /* colNameList: colNameList ',' colName  */
+#line 178 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_strs).push_back((yyvsp[0].sv_str));
     }
-#line 1801 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1828 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 28: /* field: colName type  */
-#line 177 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 30: /* field: colName type  */
+#line 185 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_field) = std::make_shared<ColDef>((yyvsp[-1].sv_str), (yyvsp[0].sv_type_len));
     }
-#line 1809 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1836 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 29: /* type: INT  */
-#line 184 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 31: /* type: INT  */
+#line 192 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_INT, sizeof(int));
     }
-#line 1817 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1844 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 30: /* type: CHAR '(' VALUE_INT ')'  */
-#line 188 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 32: /* type: CHAR '(' VALUE_INT ')'  */
+#line 196 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_STRING, (yyvsp[-1].sv_int));
     }
-#line 1825 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1852 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 31: /* type: FLOAT  */
-#line 192 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 33: /* type: FLOAT  */
+#line 200 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_type_len) = std::make_shared<TypeLen>(SV_TYPE_FLOAT, sizeof(float));
     }
-#line 1833 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1860 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 32: /* valueList: value  */
-#line 199 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 34: /* valueList: value  */
+#line 207 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_vals) = std::vector<std::shared_ptr<Value>>{(yyvsp[0].sv_val)};
     }
-#line 1841 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1868 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 33: /* valueList: valueList ',' value  */
-#line 203 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 35: /* valueList: valueList ',' value  */
+#line 211 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_vals).push_back((yyvsp[0].sv_val));
     }
-#line 1849 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1876 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 34: /* value: VALUE_INT  */
-#line 210 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 36: /* value: VALUE_INT  */
+#line 218 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<IntLit>((yyvsp[0].sv_int));
     }
-#line 1857 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1884 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 35: /* value: VALUE_FLOAT  */
-#line 214 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 37: /* value: VALUE_FLOAT  */
+#line 222 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<FloatLit>((yyvsp[0].sv_float));
     }
-#line 1865 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1892 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 36: /* value: VALUE_STRING  */
-#line 218 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 38: /* value: VALUE_STRING  */
+#line 226 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_val) = std::make_shared<StringLit>((yyvsp[0].sv_str));
     }
-#line 1873 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1900 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 37: /* condition: col op expr  */
-#line 225 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 39: /* condition: col op expr  */
+#line 233 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_cond) = std::make_shared<BinaryExpr>((yyvsp[-2].sv_col), (yyvsp[-1].sv_comp_op), (yyvsp[0].sv_expr));
     }
-#line 1881 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1908 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 38: /* optWhereClause: %empty  */
-#line 231 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 40: /* optWhereClause: %empty  */
+#line 239 "/home/cyy/rucbase-lab/src/parser/yacc.y"
                       { /* ignore*/ }
-#line 1887 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1914 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 39: /* optWhereClause: WHERE whereClause  */
-#line 233 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 41: /* optWhereClause: WHERE whereClause  */
+#line 241 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_conds) = (yyvsp[0].sv_conds);
     }
-#line 1895 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1922 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 40: /* whereClause: condition  */
-#line 240 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 42: /* whereClause: condition  */
+#line 248 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_conds) = std::vector<std::shared_ptr<BinaryExpr>>{(yyvsp[0].sv_cond)};
     }
-#line 1903 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1930 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 41: /* whereClause: whereClause AND condition  */
-#line 244 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 43: /* whereClause: whereClause AND condition  */
+#line 252 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_conds).push_back((yyvsp[0].sv_cond));
     }
-#line 1911 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1938 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 42: /* col: tbName '.' colName  */
-#line 251 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 44: /* col: tbName '.' colName  */
+#line 259 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_col) = std::make_shared<Col>((yyvsp[-2].sv_str), (yyvsp[0].sv_str));
     }
-#line 1919 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1946 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 43: /* col: colName  */
-#line 255 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 45: /* col: colName  */
+#line 263 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_col) = std::make_shared<Col>("", (yyvsp[0].sv_str));
     }
-#line 1927 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1954 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 44: /* colList: col  */
-#line 262 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 46: /* colList: col  */
+#line 270 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_cols) = std::vector<std::shared_ptr<Col>>{(yyvsp[0].sv_col)};
     }
-#line 1935 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1962 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 45: /* colList: colList ',' col  */
-#line 266 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 47: /* colList: colList ',' col  */
+#line 274 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_cols).push_back((yyvsp[0].sv_col));
     }
-#line 1943 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1970 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 46: /* op: '='  */
-#line 273 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 48: /* op: '='  */
+#line 281 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_EQ;
     }
-#line 1951 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1978 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 47: /* op: '<'  */
-#line 277 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 49: /* op: '<'  */
+#line 285 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_LT;
     }
-#line 1959 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1986 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 48: /* op: '>'  */
-#line 281 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 50: /* op: '>'  */
+#line 289 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_GT;
     }
-#line 1967 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 1994 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 49: /* op: NEQ  */
-#line 285 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 51: /* op: NEQ  */
+#line 293 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_NE;
     }
-#line 1975 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2002 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 50: /* op: LEQ  */
-#line 289 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 52: /* op: LEQ  */
+#line 297 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_LE;
     }
-#line 1983 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2010 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 51: /* op: GEQ  */
-#line 293 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 53: /* op: GEQ  */
+#line 301 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_comp_op) = SV_OP_GE;
     }
-#line 1991 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2018 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 52: /* expr: value  */
-#line 300 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 54: /* expr: value  */
+#line 308 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_expr) = std::static_pointer_cast<Expr>((yyvsp[0].sv_val));
     }
-#line 1999 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2026 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 53: /* expr: col  */
-#line 304 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 55: /* expr: col  */
+#line 312 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_expr) = std::static_pointer_cast<Expr>((yyvsp[0].sv_col));
     }
-#line 2007 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2034 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 54: /* setClauses: setClause  */
-#line 311 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 56: /* setClauses: setClause  */
+#line 319 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_set_clauses) = std::vector<std::shared_ptr<SetClause>>{(yyvsp[0].sv_set_clause)};
     }
-#line 2015 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2042 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 55: /* setClauses: setClauses ',' setClause  */
-#line 315 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 57: /* setClauses: setClauses ',' setClause  */
+#line 323 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_set_clauses).push_back((yyvsp[0].sv_set_clause));
     }
-#line 2023 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2050 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 56: /* setClause: colName '=' value  */
-#line 322 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 58: /* setClause: colName '=' value  */
+#line 330 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_set_clause) = std::make_shared<SetClause>((yyvsp[-2].sv_str), (yyvsp[0].sv_val));
     }
-#line 2031 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2058 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 57: /* selector: '*'  */
-#line 329 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 59: /* selector: '*'  */
+#line 337 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_cols) = {};
     }
-#line 2039 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2066 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 59: /* tableList: tbName  */
-#line 337 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 61: /* tableList: tbName  */
+#line 345 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_strs) = std::vector<std::string>{(yyvsp[0].sv_str)};
     }
-#line 2047 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2074 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 60: /* tableList: tableList ',' tbName  */
-#line 341 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 62: /* tableList: tableList ',' tbName  */
+#line 349 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_strs).push_back((yyvsp[0].sv_str));
     }
-#line 2055 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2082 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 61: /* tableList: tableList JOIN tbName  */
-#line 345 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 63: /* tableList: tableList JOIN tbName  */
+#line 353 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     {
         (yyval.sv_strs).push_back((yyvsp[0].sv_str));
     }
-#line 2063 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2090 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 62: /* opt_order_clause: ORDER BY order_clause  */
-#line 352 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 64: /* opt_order_clause: ORDER BY order_clause  */
+#line 360 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     { 
         (yyval.sv_orderby) = (yyvsp[0].sv_orderby); 
     }
-#line 2071 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2098 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 63: /* opt_order_clause: %empty  */
-#line 355 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 65: /* opt_order_clause: %empty  */
+#line 363 "/home/cyy/rucbase-lab/src/parser/yacc.y"
                       { /* ignore*/ }
-#line 2077 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2104 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 64: /* order_clause: col opt_asc_desc  */
-#line 360 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 66: /* order_clause: col opt_asc_desc  */
+#line 368 "/home/cyy/rucbase-lab/src/parser/yacc.y"
     { 
         (yyval.sv_orderby) = std::make_shared<OrderBy>((yyvsp[-1].sv_col), (yyvsp[0].sv_orderby_dir));
     }
-#line 2085 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2112 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 65: /* opt_asc_desc: ASC  */
-#line 366 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 67: /* opt_asc_desc: ASC  */
+#line 374 "/home/cyy/rucbase-lab/src/parser/yacc.y"
                  { (yyval.sv_orderby_dir) = OrderBy_ASC;     }
-#line 2091 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2118 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 66: /* opt_asc_desc: DESC  */
-#line 367 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 68: /* opt_asc_desc: DESC  */
+#line 375 "/home/cyy/rucbase-lab/src/parser/yacc.y"
                  { (yyval.sv_orderby_dir) = OrderBy_DESC;    }
-#line 2097 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2124 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
-  case 67: /* opt_asc_desc: %empty  */
-#line 368 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+  case 69: /* opt_asc_desc: %empty  */
+#line 376 "/home/cyy/rucbase-lab/src/parser/yacc.y"
             { (yyval.sv_orderby_dir) = OrderBy_DEFAULT; }
-#line 2103 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2130 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
     break;
 
 
-#line 2107 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
+#line 2134 "/home/cyy/rucbase-lab/src/parser/yacc.tab.cpp"
 
       default: break;
     }
@@ -2332,5 +2359,5 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 374 "/home/cyy/rucbase-lab/src/parser/yacc.y"
+#line 382 "/home/cyy/rucbase-lab/src/parser/yacc.y"
 
@@ -85,14 +85,17 @@ extern int yydebug;
     TXN_ABORT = 286,               /* TXN_ABORT  */
     TXN_ROLLBACK = 287,            /* TXN_ROLLBACK  */
     ORDER_BY = 288,                /* ORDER_BY  */
-    LEQ = 289,                     /* LEQ  */
-    NEQ = 290,                     /* NEQ  */
-    GEQ = 291,                     /* GEQ  */
-    T_EOF = 292,                   /* T_EOF  */
-    IDENTIFIER = 293,              /* IDENTIFIER  */
-    VALUE_STRING = 294,            /* VALUE_STRING  */
-    VALUE_INT = 295,               /* VALUE_INT  */
-    VALUE_FLOAT = 296              /* VALUE_FLOAT  */
+    USING = 289,                   /* USING  */
+    HASH = 290,                    /* HASH  */
+    REINDEX = 291,                 /* REINDEX  */
+    LEQ = 292,                     /* LEQ  */
+    NEQ = 293,                     /* NEQ  */
+    GEQ = 294,                     /* GEQ  */
+    T_EOF = 295,                   /* T_EOF  */
+    IDENTIFIER = 296,              /* IDENTIFIER  */
+    VALUE_STRING = 297,            /* VALUE_STRING  */
+    VALUE_INT = 298,               /* VALUE_INT  */
+    VALUE_FLOAT = 299              /* VALUE_FLOAT  */
   };
   typedef enum yytokentype yytoken_kind_t;
 #endif
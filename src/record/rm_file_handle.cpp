@@ -20,10 +20,12 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     auto page_handle = fetch_page_handle(rid.page_no); // Get Page Handler
     auto rec = std::make_unique<RmRecord>(file_hdr_.record_size); // That's the record.
     if(!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
+      buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
       throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
     memcpy(rec->data, page_handle.get_slot(rid.slot_no), file_hdr_.record_size);
     rec->size = file_hdr_.record_size;
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
     return rec;
 }
 
@@ -98,9 +100,12 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     RmPageHandle page_handle = fetch_page_handle(rid.page_no);
     // bitmap, bitmap, bitmap!
     if(!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
+        buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
         throw PageNotExistError("a`", rid.page_no);
     }
+    // 原地覆盖slot，记录位置不变
     memcpy(page_handle.get_slot(rid.slot_no), buf, file_hdr_.record_size);
+    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
 }
 
 /**
@@ -29,16 +29,15 @@ void RmScan::next() {
         this->rid_.slot_no = Bitmap::next_bit(true, page_handle.bitmap,
             file_handle_->file_hdr_.num_records_per_page,
             this->rid_.slot_no);
+        file_handle_->buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
         if(this->rid_.slot_no < this->file_handle_->file_hdr_.num_records_per_page){
           return;
         } else {
             this->rid_ = Rid{this->rid_.page_no+1, -1};
-            if(rid_.page_no >= file_handle_ -> file_hdr_.num_pages) {
-                rid_ = Rid{RM_NO_PAGE, -1};
-                break;
-            }
         }
     }
+    // 没有更多存放记录的页面（包括表中还没有记录页面的情况）
+    rid_ = Rid{RM_NO_PAGE, -1};
 }
 
 /**
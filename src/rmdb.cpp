@@ -22,6 +22,7 @@ See the Mulan PSL v2 for more details. */
 #include "optimizer/plan.h"
 #include "optimizer/planner.h"
 #include "portal.h"
+#include "execution/execution_spill.h"
 #include "analyze/analyze.h"
 
 #define SOCK_PORT 8765
@@ -291,6 +292,13 @@ int main(int argc, char **argv) {
         }
         // Open database
         sm_manager->open_db(db_name);
+        // 上次异常退出时没有删除的溢出临时文件
+        SpillFile::remove_leftover_files(disk_manager.get());
+        // 之后新建的表和索引文件按配置决定是否透明地压缩页面，日志文件和已有的文件保持原来的格式
+        disk_manager->set_page_compression(ENABLE_PAGE_COMPRESSION);
+        // 之后新建的B+树索引按配置决定是否维护Bloom过滤器和使用change buffer，已有的索引按创建时的选项
+        ix_manager->set_bloom_filter(ENABLE_BLOOM_FILTER);
+        ix_manager->set_change_buffer(ENABLE_CHANGE_BUFFER);
 
         // recovery database
         recovery->analyze();
@@ -34,20 +34,23 @@ bool BufferPoolManager::find_victim_page(frame_id_t* frame_id) {
  * @param {Page*} page 写回页指针
  * @param {PageId} new_page_id 新的page_id
  * @param {frame_id_t} new_frame_id 新的帧frame_id
+ * @note 调用者需持有latch_
  */
 void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
-    std::scoped_lock lock(latch_);
     if (page->is_dirty())
     {
         // If the page is dirty, write it back to the disk
-        flush_page(page->get_page_id());
+        disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
         page->is_dirty_ = false;
     }
     // Update the page's metadata
+    if (page->get_page_id().page_no != INVALID_PAGE_ID)
+    {
+        page_table_.erase(page->get_page_id());
+    }
     page->id_ = new_page_id;
     page_table_[new_page_id] = new_frame_id;
     page->reset_memory();
-
 }
 
 /**
@@ -66,6 +69,7 @@ Page* BufferPoolManager::fetch_page(PageId page_id) {
         // Page exists in the buffer pool, pin it
         frame_id_t frame_id = it->second;
         pages_[frame_id].pin_count_++;
+        replacer_->pin(frame_id);
         return &pages_[frame_id];
     }
 
@@ -75,25 +79,14 @@ Page* BufferPoolManager::fetch_page(PageId page_id) {
         return nullptr; // No available pages
     }
 
-    Page &victim_page = pages_[frame_id];
-    if (victim_page.is_dirty())
-    {
-        flush_page(victim_page.get_page_id());
-        victim_page.is_dirty_ = false;
-    }
-
-    // Delete R from the page table and insert P
-    page_table_.erase(victim_page.get_page_id());
-    page_table_[page_id] = frame_id;
-
-    // Update P's metadata
-    Page &newPage = victim_page;
-    victim_page.id_ = page_id;
-    disk_manager_->read_page(page_id.fd, page_id.page_no, newPage.data_, PAGE_SIZE);
-    victim_page.is_dirty_ = false;
+    // Write back the victim if necessary, then replace it with P
+    Page &page = pages_[frame_id];
+    update_page(&page, page_id, frame_id);
+    disk_manager_->read_page(page_id.fd, page_id.page_no, page.data_, PAGE_SIZE);
+    page.pin_count_ = 1;
     replacer_->pin(frame_id);
 
-    return &newPage;
+    return &page;
 }
 
 /**
@@ -108,37 +101,24 @@ bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
     auto it = page_table_.find(page_id);
     if (it == page_table_.end())
     {
-        // Page not found in the page table
-
-        return true;
+        return false;
     }
 
     frame_id_t frame_id = it->second;
     Page &page = pages_[frame_id];
-
-    if (page.pin_count_ > 0)
+    if (page.pin_count_ <= 0)
     {
-        page.pin_count_--;
-        if (is_dirty)
-        {
-            page.is_dirty_ = true;
-        }
-        return true;
+        return false;
     }
 
-    // Check if the page can be evicted (pin_count <= 0)
-    if (page.pin_count_ <= 0)
+    if (is_dirty)
     {
-        if (is_dirty)
-        {
-            disk_manager_->write_page(page_id.fd, page_id.page_no, page.data_, PAGE_SIZE);
-        }
-
-        // Remove the page from the page table
-        page_table_.erase(page_id);
-
-        // Mark the frame as free
-        free_list_.push_back(frame_id);
+        page.is_dirty_ = true;
+    }
+    // 最后一个使用者释放后，页面交给replacer，可以被淘汰
+    if (--page.pin_count_ == 0)
+    {
+        replacer_->unpin(frame_id);
     }
     return true;
 }
@@ -172,53 +152,20 @@ bool BufferPoolManager::flush_page(PageId page_id) {
 Page* BufferPoolManager::new_page(PageId* page_id) {
     std::lock_guard<std::mutex> latch_guard(latch_);
 
-    page_id->page_no = disk_manager_->allocate_page(page_id->fd);
-    if (page_id->page_no == INVALID_PAGE_ID)
-    {
-        // No new pages could be created
-        return nullptr;
-    }
+    // 先确定有可用的帧再分配页面号，避免缓冲池已满时白白消耗页面号
     frame_id_t frame_id;
-    if (!free_list_.empty())
-    {
-
-        frame_id = free_list_.front();
-        // std::cout << " frame_id" << frame_id << std::endl;
-        free_list_.pop_front();
-        for (auto it = page_table_.begin(); it != page_table_.end(); it++)
-        {
-            if (it->second == frame_id)
-            {
-
-                it = page_table_.erase(it);
-                break;
-            }
-        }
-        
-    }
-
-    else
+    if (!find_victim_page(&frame_id))
     {
-        if (!replacer_->victim(&frame_id))
-        {
-
-            return nullptr;  // No available pages
-            printf("fuck");
-        }
-        if (pages_[frame_id].is_dirty())
-        {
-            flush_page(pages_[frame_id].get_page_id());
-            pages_[frame_id].is_dirty_ = false;
-        }
+        return nullptr;  // No available pages
     }
+    page_id->page_no = disk_manager_->allocate_page(page_id->fd);
 
     // Update P's metadata, zero out memory, and add P to the page table
-    Page &new_page = pages_[frame_id];
-    new_page.id_ = *page_id;
-
-    new_page.reset_memory();
-    page_table_[*page_id] = frame_id;
-    return &new_page;
+    Page &page = pages_[frame_id];
+    update_page(&page, *page_id, frame_id);
+    page.pin_count_ = 1;
+    replacer_->pin(frame_id);
+    return &page;
 }
 
 /**
@@ -246,6 +193,9 @@ bool BufferPoolManager::delete_page(PageId page_id) {
     }
 
     page_table_.erase(page_id);
+    replacer_->pin(frame_id);  // 从replacer中移除，该帧回到free_list
+    page.id_.page_no = INVALID_PAGE_ID;
+    page.is_dirty_ = false;
     page.reset_memory();
     free_list_.push_back(frame_id);
 
@@ -270,4 +220,28 @@ void BufferPoolManager::flush_all_pages(int fd) {
             page->is_dirty_ = false;
         }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @description: 将文件的所有页面移出buffer_pool（不写回），关闭文件时在flush_all_pages之后调用，
+ *               避免文件句柄被复用后命中已关闭文件的旧页面
+ * @param {int} fd 文件句柄
+ */
+void BufferPoolManager::remove_all_pages(int fd) {
+    std::lock_guard<std::mutex> latch_guard(latch_);
+    for (size_t i = 0; i < pool_size_; i++)
+    {
+        Page *page = &pages_[i];
+        if (page->get_page_id().fd == fd && page->get_page_id().page_no != INVALID_PAGE_ID)
+        {
+            frame_id_t frame_id = static_cast<frame_id_t>(i);
+            page_table_.erase(page->get_page_id());
+            replacer_->pin(frame_id);
+            page->id_.page_no = INVALID_PAGE_ID;
+            page->is_dirty_ = false;
+            page->pin_count_ = 0;
+            page->reset_memory();
+            free_list_.push_back(frame_id);
+        }
+    }
+}
@@ -63,6 +63,23 @@ class BufferPoolManager {
      */
     static void mark_dirty(Page* page) { page->is_dirty_ = true; }
 
+    /**
+     * @description: 为已被固定的页面再增加一个pin，不经过latch_和replacer
+     * @note 调用者保证页面上已有另一个不会同时释放的pin（例如索引常驻结点的pin），页面因此不会被淘汰
+     */
+    static void pin_pinned_page(Page* page) { page->pin_count_.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @description: 释放pin_pinned_page或fetch_page得到的一个pin，不经过latch_和replacer
+     * @note 同pin_pinned_page，释放之后页面上仍有其他pin，pin_count不会在这里变为0
+     */
+    static void unpin_pinned_page(Page* page, bool is_dirty) {
+        if (is_dirty) {
+            page->is_dirty_ = true;
+        }
+        page->pin_count_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
    public: 
     Page* fetch_page(PageId page_id);
 
@@ -76,6 +93,8 @@ class BufferPoolManager {
 
     void flush_all_pages(int fd);
 
+    void remove_all_pages(int fd);
+
    private:
     bool find_victim_page(frame_id_t* frame_id);
 
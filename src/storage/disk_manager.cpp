@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/disk_manager.h"
 
 #include <assert.h>    // for assert
+#include <stdio.h>     // for rename
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
 #include <unistd.h>    // for lseek
@@ -27,6 +28,11 @@ DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<
  * @param {int} num_bytes 要写入磁盘的数据大小
  */
 void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int num_bytes) {
+    PageExtentMap *extent_map = get_extent_map(fd);
+    if (extent_map != nullptr) {
+        write_compressed_page(fd, extent_map, page_no, offset, num_bytes);
+        return;
+    }
     lseek(fd, page_no * PAGE_SIZE, SEEK_SET);
         write(fd, offset, num_bytes);
 }
@@ -39,10 +45,117 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int
  * @param {int} num_bytes 读取的数据量大小
  */
 void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_bytes) {
+    PageExtentMap *extent_map = get_extent_map(fd);
+    if (extent_map != nullptr) {
+        std::lock_guard<std::mutex> lock(extent_map->latch_);
+        read_compressed_page(fd, extent_map, page_no, offset, num_bytes);
+        return;
+    }
     lseek(fd, page_no * PAGE_SIZE, SEEK_SET);
     read(fd, offset, num_bytes);
 }
 
+/**
+ * @description: 获得压缩文件的页面-区段映射表
+ * @return {PageExtentMap*} 若文件未启用压缩则返回nullptr
+ * @param {int} fd 磁盘文件的文件句柄
+ */
+PageExtentMap *DiskManager::get_extent_map(int fd) {
+    std::lock_guard<std::mutex> lock(extent_maps_latch_);
+    auto it = fd2extent_map_.find(fd);
+    return it == fd2extent_map_.end() ? nullptr : it->second.get();
+}
+
+/**
+ * @description: 判断文件是否启用了页面压缩
+ * @param {int} fd 磁盘文件的文件句柄
+ */
+bool DiskManager::is_compressed_file(int fd) { return get_extent_map(fd) != nullptr; }
+
+/**
+ * @description: 压缩页面并写入映射表为其分配的区段中；压缩后不能节省扇区的页面按原样存放
+ * 只写页面前num_bytes个字节时，需要先读出整个页面再合并，因为压缩的单位是整个页面
+ */
+void DiskManager::write_compressed_page(int fd, PageExtentMap *extent_map, page_id_t page_no, const char *offset,
+                                        int num_bytes) {
+    static constexpr int HDR_SIZE = sizeof(PageExtentHdr);
+    std::lock_guard<std::mutex> lock(extent_map->latch_);
+    char page[PAGE_SIZE];
+    if (num_bytes < PAGE_SIZE) {
+        PageExtent extent;
+        if (extent_map->get_extent(page_no, &extent)) {
+            read_compressed_page(fd, extent_map, page_no, page, PAGE_SIZE);
+        } else {
+            memset(page, 0, PAGE_SIZE);
+        }
+        memcpy(page, offset, num_bytes);
+        offset = page;
+    }
+
+    char buf[PageExtentMap::MAX_EXTENT_SECTORS * PageExtentMap::SECTOR_SIZE];
+    int raw_sectors = (HDR_SIZE + PAGE_SIZE + PageExtentMap::SECTOR_SIZE - 1) / PageExtentMap::SECTOR_SIZE;
+    int max_len = (raw_sectors - 1) * PageExtentMap::SECTOR_SIZE - HDR_SIZE;
+    int data_len = PageCompressor::compress(offset, PAGE_SIZE, buf + HDR_SIZE, max_len);
+    if (data_len < 0) {
+        memcpy(buf + HDR_SIZE, offset, PAGE_SIZE);
+        data_len = PAGE_SIZE;
+    }
+    PageExtentHdr hdr;
+    hdr.magic = PageExtentHdr::EXTENT_MAGIC;
+    hdr.page_no = page_no;
+    hdr.generation = extent_map->next_generation();
+    hdr.data_len = static_cast<uint16_t>(data_len);
+    hdr.checksum = hdr.compute_checksum();
+    memcpy(buf, &hdr, HDR_SIZE);
+
+    int num_sectors = (HDR_SIZE + data_len + PageExtentMap::SECTOR_SIZE - 1) / PageExtentMap::SECTOR_SIZE;
+    int num_write = num_sectors * PageExtentMap::SECTOR_SIZE;
+    memset(buf + HDR_SIZE + data_len, 0, num_write - HDR_SIZE - data_len);
+    PageExtent extent = extent_map->allocate_extent(page_no, num_sectors);
+    off_t pos = static_cast<off_t>(extent.sector_no) * PageExtentMap::SECTOR_SIZE;
+    if (pwrite(fd, buf, num_write, pos) != num_write) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 读取页面所在的区段并直接解压到offset中（通常是缓冲池的帧）；从未写入过的页面读出全0
+ * 调用者需持有extent_map->latch_
+ */
+void DiskManager::read_compressed_page(int fd, PageExtentMap *extent_map, page_id_t page_no, char *offset,
+                                       int num_bytes) {
+    static constexpr int HDR_SIZE = sizeof(PageExtentHdr);
+    PageExtent extent;
+    if (!extent_map->get_extent(page_no, &extent)) {
+        memset(offset, 0, num_bytes);
+        return;
+    }
+    char buf[PageExtentMap::MAX_EXTENT_SECTORS * PageExtentMap::SECTOR_SIZE];
+    int num_read = extent.num_sectors * PageExtentMap::SECTOR_SIZE;
+    off_t pos = static_cast<off_t>(extent.sector_no) * PageExtentMap::SECTOR_SIZE;
+    if (pread(fd, buf, num_read, pos) != num_read) {
+        throw UnixError();
+    }
+    PageExtentHdr hdr;
+    memcpy(&hdr, buf, HDR_SIZE);
+    if (!hdr.is_valid() || hdr.page_no != page_no || HDR_SIZE + hdr.data_len > num_read) {
+        throw InternalError("DiskManager::read_page: corrupted compressed page " + std::to_string(page_no));
+    }
+    const char *data = buf + HDR_SIZE;
+    if (hdr.data_len == PAGE_SIZE) {
+        memcpy(offset, data, num_bytes);
+        return;
+    }
+    char page[PAGE_SIZE];
+    char *dst = num_bytes == PAGE_SIZE ? offset : page;
+    if (PageCompressor::decompress(data, hdr.data_len, dst, PAGE_SIZE) != PAGE_SIZE) {
+        throw InternalError("DiskManager::read_page: corrupted compressed page " + std::to_string(page_no));
+    }
+    if (dst != offset) {
+        memcpy(offset, page, num_bytes);
+    }
+}
+
 /**
  * @description: 分配一个新的页号
  * @return {page_id_t} 分配的新页号
@@ -98,6 +211,15 @@ void DiskManager::create_file(const std::string &path) {
     }
     int fd = open(path.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
     close(fd);
+    if (compress_new_files_) {
+        // 启用压缩的文件通过其映射文件来标识
+        int map_fd = open((path + PAGE_MAP_SUFFIX).c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+        if (map_fd < 0) {
+            throw UnixError();
+        }
+        PageExtentMap::init_map_file(map_fd);
+        close(map_fd);
+    }
 }
 
 /**
@@ -110,6 +232,32 @@ void DiskManager::destroy_file(const std::string &path) {
             throw FileNotFoundError(path);
         }
     unlink(path.c_str());
+    std::string map_path = path + PAGE_MAP_SUFFIX;
+    if (is_file(map_path)) {
+        unlink(map_path.c_str());
+    }
+}
+
+/**
+ * @description: 把文件from重命名为to，to已存在时被替换；from的页面映射文件一起重命名
+ * @note 已经打开的to的文件句柄仍然指向被替换的旧文件
+ */
+void DiskManager::rename_file(const std::string &from, const std::string &to) {
+    if (!is_file(from)) {
+        throw FileNotFoundError(from);
+    }
+    if (rename(from.c_str(), to.c_str()) < 0) {
+        throw UnixError();
+    }
+    std::string map_path = from + PAGE_MAP_SUFFIX;
+    if (is_file(map_path)) {
+        if (rename(map_path.c_str(), (to + PAGE_MAP_SUFFIX).c_str()) < 0) {
+            throw UnixError();
+        }
+    } else if (is_file(to + PAGE_MAP_SUFFIX)) {
+        // 新文件没有压缩，删除旧文件的映射文件，否则打开时会被当作压缩文件
+        unlink((to + PAGE_MAP_SUFFIX).c_str());
+    }
 }
 
 
@@ -124,6 +272,24 @@ int DiskManager::open_file(const std::string &path) {
         throw FileNotFoundError(path);
     }
     int fd = open(path.c_str(), O_RDWR);
+    std::string map_path = path + PAGE_MAP_SUFFIX;
+    if (fd >= 0 && is_file(map_path)) {
+        int map_fd = open(map_path.c_str(), O_RDWR);
+        if (map_fd < 0) {
+            throw UnixError();
+        }
+        auto extent_map = std::make_unique<PageExtentMap>();
+        extent_map->load(map_fd, fd);
+        extent_map->mark_open();
+        std::lock_guard<std::mutex> lock(extent_maps_latch_);
+        fd2extent_map_[fd] = std::move(extent_map);
+    }
+    if (fd < 0) {
+        throw UnixError();
+    }
+    std::lock_guard<std::mutex> lock(file_maps_latch_);
+    path2fd_[path] = fd;
+    fd2path_[fd] = path;
     return fd;
 }
 
@@ -132,6 +298,31 @@ int DiskManager::open_file(const std::string &path) {
  * @param {int} fd 打开的文件的文件句柄
  */
 void DiskManager::close_file(int fd) {
+    std::unique_ptr<PageExtentMap> extent_map;
+    {
+        std::lock_guard<std::mutex> lock(extent_maps_latch_);
+        auto it = fd2extent_map_.find(fd);
+        if (it != fd2extent_map_.end()) {
+            extent_map = std::move(it->second);
+            fd2extent_map_.erase(it);
+        }
+    }
+    if (extent_map != nullptr) {
+        extent_map->store(true);
+        close(extent_map->get_map_fd());
+    }
+    {
+        // 先从映射表中去掉再关闭，fd被其他线程重新打开的文件复用时不会误删它的映射
+        std::lock_guard<std::mutex> lock(file_maps_latch_);
+        auto pos = fd2path_.find(fd);
+        if (pos != fd2path_.end()) {
+            auto path_pos = path2fd_.find(pos->second);
+            if (path_pos != path2fd_.end() && path_pos->second == fd) {
+                path2fd_.erase(path_pos);
+            }
+            fd2path_.erase(pos);
+        }
+    }
     close(fd);
 }
 
@@ -153,10 +344,12 @@ int DiskManager::get_file_size(const std::string &file_name) {
  * @param {int} fd 文件句柄
  */
 std::string DiskManager::get_file_name(int fd) {
-    if (!fd2path_.count(fd)) {
+    std::lock_guard<std::mutex> lock(file_maps_latch_);
+    auto pos = fd2path_.find(fd);
+    if (pos == fd2path_.end()) {
         throw FileNotOpenError(fd);
     }
-    return fd2path_[fd];
+    return pos->second;
 }
 
 /**
@@ -165,10 +358,14 @@ std::string DiskManager::get_file_name(int fd) {
  * @param {string} &file_name 文件名
  */
 int DiskManager::get_file_fd(const std::string &file_name) {
-    if (!path2fd_.count(file_name)) {
-        return open_file(file_name);
+    {
+        std::lock_guard<std::mutex> lock(file_maps_latch_);
+        auto pos = path2fd_.find(file_name);
+        if (pos != path2fd_.end()) {
+            return pos->second;
+        }
     }
-    return path2fd_[file_name];
+    return open_file(file_name);
 }
 
 
@@ -17,11 +17,14 @@ See the Mulan PSL v2 for more details. */
 #include <atomic>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
 #include "common/config.h"
 #include "errors.h"  
+#include "storage/page_compression.h"
 
 /**
  * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
@@ -54,6 +57,8 @@ class DiskManager {
 
     void destroy_file(const std::string &path);
 
+    void rename_file(const std::string &from, const std::string &to);
+
     int open_file(const std::string &path);
 
     void close_file(int fd);
@@ -87,13 +92,35 @@ class DiskManager {
      */
     page_id_t get_fd2pageno(int fd) { return fd2pageno_[fd]; }
 
+    /**
+     * @description: 设置之后新建的文件是否启用页面压缩，已有文件是否压缩由其是否存在映射文件决定
+     * @param {bool} enable 是否启用
+     */
+    void set_page_compression(bool enable) { compress_new_files_ = enable; }
+
+    bool is_compressed_file(int fd);
+
     static constexpr int MAX_FD = 8192;
 
+    static constexpr const char *PAGE_MAP_SUFFIX = ".pmap";  // 压缩文件的页面-区段映射文件后缀
+
    private:
     // 文件打开列表，用于记录文件是否被打开
+    std::mutex file_maps_latch_;                    // 保护path2fd_和fd2path_，查询执行时会并发打开和关闭临时文件
     std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
     std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
 
+    PageExtentMap *get_extent_map(int fd);
+
+    void write_compressed_page(int fd, PageExtentMap *extent_map, page_id_t page_no, const char *offset,
+                               int num_bytes);
+
+    void read_compressed_page(int fd, PageExtentMap *extent_map, page_id_t page_no, char *offset, int num_bytes);
+
+    bool compress_new_files_ = false;                                          // 新建文件是否启用页面压缩
+    std::mutex extent_maps_latch_;                                             // 保护fd2extent_map_
+    std::unordered_map<int, std::unique_ptr<PageExtentMap>> fd2extent_map_;  // 已打开的压缩文件的映射表
+
     int log_fd_ = -1;                             // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
     std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
 };
\ No newline at end of file
@@ -10,6 +10,9 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <atomic>
+#include <shared_mutex>
+
 #include "common/config.h"
 
 /**
@@ -71,6 +74,15 @@ class Page {
 
     inline void set_page_lsn(lsn_t page_lsn) { memcpy(get_data() + OFFSET_LSN, &page_lsn, sizeof(lsn_t)); }
 
+    /** 页面读写锁，用于索引的latch crabbing；必须在unpin之前释放 */
+    inline void wlatch() { rwlatch_.lock(); }
+
+    inline void wunlatch() { rwlatch_.unlock(); }
+
+    inline void rlatch() { rwlatch_.lock_shared(); }
+
+    inline void runlatch() { rwlatch_.unlock_shared(); }
+
    private:
     void reset_memory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0
 
@@ -85,6 +97,9 @@ class Page {
     /** 脏页判断 */
     bool is_dirty_ = false;
 
-    /** The pin count of this page. */
-    int pin_count_ = 0;
+    /** The pin count of this page. 常驻索引结点不持有latch_增减，因此是原子变量 */
+    std::atomic<int> pin_count_{0};
+
+    /** 页面的读写锁 */
+    std::shared_mutex rwlatch_;
 };
\ No newline at end of file
@@ -0,0 +1,350 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/page_compression.h"
+
+#include <string.h>    // for memcpy
+#include <sys/stat.h>  // for fstat
+#include <unistd.h>    // for pread, pwrite
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "errors.h"
+
+namespace {
+
+inline uint32_t read32(const char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline int hash32(uint32_t v) { return static_cast<int>((v * 2654435761u) >> (32 - PageCompressor::HASH_LOG)); }
+
+/**
+ * @description: 写入一个长度字段超过15的部分，以255续接
+ * @return {bool} 输出空间不足时返回false
+ */
+inline bool write_length(char *&op, const char *op_end, int len) {
+    while (len >= 255) {
+        if (op >= op_end) return false;
+        *op++ = static_cast<char>(255);
+        len -= 255;
+    }
+    if (op >= op_end) return false;
+    *op++ = static_cast<char>(len);
+    return true;
+}
+
+inline bool read_length(const unsigned char *&ip, const unsigned char *ip_end, int &len) {
+    unsigned char b;
+    do {
+        if (ip >= ip_end) return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+/**
+ * @description: 输出一个序列：token + 字面量 (+ 偏移 + 匹配长度)
+ * @param {int} match_len 匹配长度，为0表示最后一个只有字面量的序列
+ */
+inline bool emit_sequence(char *&op, const char *op_end, const char *literal, int literal_len, int offset,
+                          int match_len) {
+    if (op >= op_end) return false;
+    char *token = op++;
+    int lit_code = literal_len >= 15 ? 15 : literal_len;
+    int match_code = 0;
+    if (literal_len >= 15 && !write_length(op, op_end, literal_len - 15)) return false;
+    if (op_end - op < literal_len) return false;
+    memcpy(op, literal, literal_len);
+    op += literal_len;
+    if (match_len > 0) {
+        if (op_end - op < 2) return false;
+        *op++ = static_cast<char>(offset & 0xff);
+        *op++ = static_cast<char>(offset >> 8);
+        int ml = match_len - PageCompressor::MIN_MATCH;
+        match_code = ml >= 15 ? 15 : ml;
+        if (ml >= 15 && !write_length(op, op_end, ml - 15)) return false;
+    }
+    *token = static_cast<char>((lit_code << 4) | match_code);
+    return true;
+}
+
+}  // namespace
+
+int PageCompressor::compress(const char *src, int src_len, char *dst, int dst_cap) {
+    uint16_t table[1 << HASH_LOG];  // 哈希值 -> 位置+1，0表示空
+    memset(table, 0, sizeof(table));
+
+    char *op = dst;
+    const char *op_end = dst + dst_cap;
+    int ip = 0;
+    int anchor = 0;
+    while (ip + MIN_MATCH <= src_len) {
+        uint32_t seq = read32(src + ip);
+        int h = hash32(seq);
+        int cand = static_cast<int>(table[h]) - 1;
+        table[h] = static_cast<uint16_t>(ip + 1);
+        if (cand < 0 || ip - cand > MAX_OFFSET || read32(src + cand) != seq) {
+            ip++;
+            continue;
+        }
+        int len = MIN_MATCH;
+        while (ip + len < src_len && src[cand + len] == src[ip + len]) {
+            len++;
+        }
+        if (!emit_sequence(op, op_end, src + anchor, ip - anchor, ip - cand, len)) {
+            return -1;
+        }
+        ip += len;
+        anchor = ip;
+    }
+    if (!emit_sequence(op, op_end, src + anchor, src_len - anchor, 0, 0)) {
+        return -1;
+    }
+    return static_cast<int>(op - dst);
+}
+
+int PageCompressor::decompress(const char *src, int src_len, char *dst, int dst_cap) {
+    const unsigned char *ip = reinterpret_cast<const unsigned char *>(src);
+    const unsigned char *ip_end = ip + src_len;
+    char *op = dst;
+    char *op_end = dst + dst_cap;
+    while (ip < ip_end) {
+        unsigned char token = *ip++;
+        int literal_len = token >> 4;
+        if (literal_len == 15 && !read_length(ip, ip_end, literal_len)) return -1;
+        if (ip_end - ip < literal_len || op_end - op < literal_len) return -1;
+        memcpy(op, ip, literal_len);
+        ip += literal_len;
+        op += literal_len;
+        if (ip == ip_end) {
+            break;  // 最后一个序列只有字面量
+        }
+
+        if (ip_end - ip < 2) return -1;
+        int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        int match_len = token & 15;
+        if (match_len == 15 && !read_length(ip, ip_end, match_len)) return -1;
+        match_len += MIN_MATCH;
+        if (offset == 0 || offset > op - dst || op_end - op < match_len) return -1;
+        // 匹配区间可能与输出重叠（如offset=1表示重复前一个字节），需要逐字节复制
+        const char *match = op - offset;
+        for (int i = 0; i < match_len; i++) {
+            op[i] = match[i];
+        }
+        op += match_len;
+    }
+    return static_cast<int>(op - dst);
+}
+
+uint16_t PageExtentHdr::compute_checksum() const {
+    uint32_t sum = magic ^ static_cast<uint32_t>(page_no) * 31u ^ generation * 131u ^ data_len * 8191u;
+    return static_cast<uint16_t>((sum >> 16) ^ (sum & 0xffff) ^ 0x5a5a);
+}
+
+/**
+ * @description: 查找页面对应的区段
+ * @return {bool} 页面从未被写入过时返回false
+ */
+bool PageExtentMap::get_extent(page_id_t page_no, PageExtent *extent) const {
+    auto it = extents_.find(page_no);
+    if (it == extents_.end()) {
+        return false;
+    }
+    *extent = it->second;
+    return true;
+}
+
+/**
+ * @description: 为页面分配一个容纳num_sectors个扇区的区段
+ * 若页面原区段大小相同则原地复用，否则释放原区段，再从空闲列表中首次适配，找不到时追加到文件末尾
+ */
+PageExtent PageExtentMap::allocate_extent(page_id_t page_no, int num_sectors) {
+    auto it = extents_.find(page_no);
+    if (it != extents_.end()) {
+        if (it->second.num_sectors == num_sectors) {
+            return it->second;
+        }
+        free_extent(it->second);
+        extents_.erase(it);
+    }
+
+    PageExtent extent{num_sectors_, num_sectors};
+    for (auto free_it = free_extents_.begin(); free_it != free_extents_.end(); ++free_it) {
+        if (free_it->second >= num_sectors) {
+            extent.sector_no = free_it->first;
+            int remain = free_it->second - num_sectors;
+            free_extents_.erase(free_it);
+            if (remain > 0) {
+                free_extents_[extent.sector_no + num_sectors] = remain;
+            }
+            break;
+        }
+    }
+    if (extent.sector_no == num_sectors_) {
+        num_sectors_ += num_sectors;
+    }
+    extents_[page_no] = extent;
+    return extent;
+}
+
+/**
+ * @description: 释放区段，与相邻空闲区段合并；位于文件末尾的空闲区段直接收缩掉
+ */
+void PageExtentMap::free_extent(const PageExtent &extent) {
+    int start = extent.sector_no;
+    int count = extent.num_sectors;
+    auto next = free_extents_.lower_bound(start);
+    if (next != free_extents_.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == start) {
+            start = prev->first;
+            count += prev->second;
+            free_extents_.erase(prev);
+        }
+    }
+    if (next != free_extents_.end() && start + count == next->first) {
+        count += next->second;
+        free_extents_.erase(next);
+    }
+    if (start + count == num_sectors_) {
+        num_sectors_ = start;
+    } else {
+        free_extents_[start] = count;
+    }
+}
+
+/**
+ * @description: 根据已分配区段计算出文件中的空闲区段
+ */
+void PageExtentMap::collect_free_extents() {
+    std::map<int, int> used;
+    for (auto &entry : extents_) {
+        used[entry.second.sector_no] = entry.second.num_sectors;
+    }
+    free_extents_.clear();
+    int cur = 0;
+    for (auto &entry : used) {
+        if (entry.first > cur) {
+            free_extents_[cur] = entry.first - cur;
+        }
+        cur = entry.first + entry.second;
+    }
+    num_sectors_ = cur;
+}
+
+void PageExtentMap::init_map_file(int map_fd) {
+    MapFileHdr hdr{MAP_MAGIC, 1, 0, 0, 0};
+    if (pwrite(map_fd, &hdr, sizeof(hdr), 0) != sizeof(hdr)) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 从映射文件中加载映射表；若映射文件未被完整写回（上次未正常关闭），则扫描数据文件重建
+ * @param {int} map_fd 映射文件的文件句柄
+ * @param {int} data_fd 数据文件的文件句柄
+ */
+void PageExtentMap::load(int map_fd, int data_fd) {
+    map_fd_ = map_fd;
+    extents_.clear();
+    MapFileHdr hdr;
+    if (pread(map_fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) || hdr.magic != MAP_MAGIC || !hdr.clean) {
+        rebuild(data_fd);
+        return;
+    }
+    std::vector<MapFileEntry> entries(hdr.num_extents);
+    ssize_t bytes = static_cast<ssize_t>(entries.size() * sizeof(MapFileEntry));
+    if (bytes > 0 && pread(map_fd, entries.data(), bytes, sizeof(hdr)) != bytes) {
+        rebuild(data_fd);
+        return;
+    }
+    for (auto &entry : entries) {
+        extents_[entry.page_no] = PageExtent{entry.sector_no, entry.num_sectors};
+    }
+    generation_ = hdr.generation;
+    collect_free_extents();
+}
+
+/**
+ * @description: 扫描数据文件中所有合法的区段头，每个页面取写入代数最大的区段
+ */
+void PageExtentMap::rebuild(int data_fd) {
+    extents_.clear();
+    generation_ = 0;
+    struct stat st;
+    if (fstat(data_fd, &st) != 0) {
+        throw UnixError();
+    }
+    int total_sectors = static_cast<int>(st.st_size / SECTOR_SIZE);
+    std::unordered_map<page_id_t, uint32_t> generations;
+    static constexpr int SCAN_SECTORS = 1024;
+    std::vector<char> buf(SCAN_SECTORS * SECTOR_SIZE);
+    for (int base = 0; base < total_sectors; base += SCAN_SECTORS) {
+        int n = std::min(SCAN_SECTORS, total_sectors - base);
+        if (pread(data_fd, buf.data(), n * SECTOR_SIZE, static_cast<off_t>(base) * SECTOR_SIZE) != n * SECTOR_SIZE) {
+            throw UnixError();
+        }
+        for (int i = 0; i < n; i++) {
+            PageExtentHdr hdr;
+            memcpy(&hdr, buf.data() + i * SECTOR_SIZE, sizeof(hdr));
+            if (!hdr.is_valid() || hdr.data_len > PAGE_SIZE) {
+                continue;
+            }
+            int num_sectors = (sizeof(PageExtentHdr) + hdr.data_len + SECTOR_SIZE - 1) / SECTOR_SIZE;
+            if (base + i + num_sectors > total_sectors) {
+                continue;
+            }
+            auto it = generations.find(hdr.page_no);
+            if (it != generations.end() && it->second >= hdr.generation) {
+                continue;
+            }
+            generations[hdr.page_no] = hdr.generation;
+            extents_[hdr.page_no] = PageExtent{base + i, num_sectors};
+            generation_ = std::max(generation_, hdr.generation);
+        }
+    }
+    collect_free_extents();
+}
+
+/**
+ * @description: 将映射表完整写回映射文件
+ * @param {bool} clean 是否标记为完整写回
+ */
+void PageExtentMap::store(bool clean) const {
+    std::vector<MapFileEntry> entries;
+    entries.reserve(extents_.size());
+    for (auto &entry : extents_) {
+        entries.push_back(MapFileEntry{entry.first, entry.second.sector_no, entry.second.num_sectors});
+    }
+    MapFileHdr hdr{MAP_MAGIC, clean ? 1 : 0, num_sectors_, generation_, static_cast<int>(entries.size())};
+    ssize_t bytes = static_cast<ssize_t>(entries.size() * sizeof(MapFileEntry));
+    if (ftruncate(map_fd_, 0) != 0 || pwrite(map_fd_, entries.data(), bytes, sizeof(hdr)) != bytes ||
+        pwrite(map_fd_, &hdr, sizeof(hdr), 0) != sizeof(hdr)) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 打开文件后把映射文件标记为未完整写回，若未正常关闭则下次打开时重建映射表
+ */
+void PageExtentMap::mark_open() const {
+    int clean = 0;
+    if (pwrite(map_fd_, &clean, sizeof(clean), offsetof(MapFileHdr, clean)) != sizeof(clean)) {
+        throw UnixError();
+    }
+}
@@ -0,0 +1,125 @@
+/* Copyright (c) 2023 Renmin University of China
+RMDB is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+        http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "common/config.h"
+
+/**
+ * @description: 页面压缩编解码器，LZ77族的字节级算法（格式与LZ4的block格式类似）
+ * 每个序列由 token(高4位为字面量长度, 低4位为匹配长度-4) + 字面量 + 2字节偏移 组成,
+ * 长度达到15时用若干255字节续接; 最后一个序列只有字面量
+ */
+class PageCompressor {
+   public:
+    static constexpr int MIN_MATCH = 4;
+    static constexpr int HASH_LOG = 10;
+    static constexpr int MAX_OFFSET = 65535;
+
+    /**
+     * @description: 压缩src中的src_len个字节到dst中
+     * @return {int} 压缩后的字节数；若压缩结果超过dst_cap则返回-1
+     */
+    static int compress(const char *src, int src_len, char *dst, int dst_cap);
+
+    /**
+     * @description: 解压src中的src_len个字节到dst中
+     * @return {int} 解压后的字节数；若数据损坏或超过dst_cap则返回-1
+     */
+    static int decompress(const char *src, int src_len, char *dst, int dst_cap);
+};
+
+/**
+ * @description: 压缩文件中每个页面在磁盘上所占的区段(extent)，以扇区为单位
+ */
+struct PageExtent {
+    int sector_no;    // 区段起始扇区号
+    int num_sectors;  // 区段占用的扇区个数
+};
+
+/**
+ * @description: 压缩区段头，位于每个区段起始处，用于在映射文件丢失或不完整时扫描重建映射
+ */
+struct PageExtentHdr {
+    uint32_t magic;
+    page_id_t page_no;
+    uint32_t generation;  // 写入代数，同一页面的多个区段中代数最大者有效
+    uint16_t data_len;    // 区段中有效数据的长度
+    uint16_t checksum;    // 对以上字段的校验
+
+    uint16_t compute_checksum() const;
+    bool is_valid() const { return magic == EXTENT_MAGIC && checksum == compute_checksum(); }
+
+    static constexpr uint32_t EXTENT_MAGIC = 0x52504358;
+};
+
+/**
+ * @description: 压缩文件的页面-区段映射表
+ * 页面压缩后按扇区粒度紧凑存放在数据文件中，映射表记录每个页面号对应的区段，
+ * 并维护已释放区段的空闲列表以便复用；映射表持久化在数据文件旁的映射文件中
+ */
+class PageExtentMap {
+   public:
+    static constexpr int SECTOR_SIZE = 256;
+    static constexpr int MAX_EXTENT_SECTORS = (sizeof(PageExtentHdr) + PAGE_SIZE + SECTOR_SIZE - 1) / SECTOR_SIZE;
+
+    std::mutex latch_;  // 保护映射表以及对该文件的读写
+
+    bool get_extent(page_id_t page_no, PageExtent *extent) const;
+
+    PageExtent allocate_extent(page_id_t page_no, int num_sectors);
+
+    uint32_t next_generation() { return ++generation_; }
+
+    void load(int map_fd, int data_fd);
+
+    void store(bool clean) const;
+
+    void mark_open() const;
+
+    int get_map_fd() const { return map_fd_; }
+
+    int get_num_sectors() const { return num_sectors_; }
+
+    static void init_map_file(int map_fd);
+
+   private:
+    void free_extent(const PageExtent &extent);
+
+    void rebuild(int data_fd);
+
+    void collect_free_extents();
+
+    struct MapFileHdr {
+        uint32_t magic;
+        int clean;  // 映射文件是否在关闭文件时完整写回；否则打开时需要扫描数据文件重建
+        int num_sectors;
+        uint32_t generation;
+        int num_extents;
+    };
+    struct MapFileEntry {
+        page_id_t page_no;
+        int sector_no;
+        int num_sectors;
+    };
+    static constexpr uint32_t MAP_MAGIC = 0x50504D50;
+
+    std::unordered_map<page_id_t, PageExtent> extents_;  // 页面号 -> 区段
+    std::map<int, int> free_extents_;                     // 空闲区段：起始扇区号 -> 扇区个数
+    int num_sectors_ = 0;                                 // 数据文件已使用的扇区个数
+    uint32_t generation_ = 0;                             // 当前写入代数
+    int map_fd_ = -1;                                     // 映射文件的文件句柄
+};
@@ -11,3 +11,6 @@ See the Mulan PSL v2 for more details. */
 
 #include "defs.h"
 #include <string>
+
+// 索引的类型：B+树支持等值和范围查找，可扩展哈希只支持等值查找
+enum IndexType { INDEX_BTREE = 0, INDEX_HASH };
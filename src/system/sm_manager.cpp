@@ -197,8 +197,92 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
  * @param {vector<string>&} col_names 索引包含的字段名称
  * @param {Context*} context
  */
-void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
-    
+void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                             IndexType type) {
+    TabMeta &tab = db_.get_table(tab_name);
+    if (tab.is_index(col_names)) {
+        throw IndexExistsError(tab_name, col_names);
+    }
+    IndexMeta index_meta = {.tab_name = tab_name, .col_tot_len = 0, .col_num = static_cast<int>(col_names.size())};
+    index_meta.type = type;
+    for (auto &col_name : col_names) {
+        auto col = tab.get_col(col_name);
+        index_meta.cols.push_back(*col);
+        index_meta.col_tot_len += col->len;
+    }
+    if (type == INDEX_HASH) {
+        create_hash_index(tab, index_meta, context);
+        return;
+    }
+    ix_manager_->create_index(tab_name, index_meta.cols);
+    auto ih = ix_manager_->open_index(tab_name, index_meta.cols);
+    try {
+        bulk_load_index(ih.get(), tab, index_meta, context);
+    } catch (...) {
+        // 已有的记录中有重复的key，不创建索引
+        ix_manager_->close_index(ih.get());
+        ix_manager_->destroy_index(tab_name, index_meta.cols);
+        throw;
+    }
+
+    for (auto &col_name : col_names) {
+        tab.get_col(col_name)->index = true;
+    }
+    tab.indexes.push_back(index_meta);
+    ihs_.emplace(ix_manager_->get_index_name(tab_name, index_meta.cols), std::move(ih));
+    flush_meta();
+}
+
+/**
+ * @description: 扫描表中已有的记录，外部排序之后自底向上批量构建索引，而不是逐条insert_entry
+ * 索引是唯一索引，记录中有重复的key时抛出IndexEntryExistsError
+ * @param {IxIndexHandle*} ih 刚创建的空索引
+ */
+void SmManager::bulk_load_index(IxIndexHandle* ih, const TabMeta& tab, const IndexMeta& index_meta, Context* context) {
+    auto fh = fhs_.at(tab.name).get();
+    IxBulkLoader loader(ih);
+    std::vector<char> key(index_meta.col_tot_len);
+    for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+        auto rec = fh->get_record(scan.rid(), context);
+        int offset = 0;
+        for (auto &col : index_meta.cols) {
+            memcpy(key.data() + offset, rec->data + col.offset, col.len);
+            offset += col.len;
+        }
+        loader.add(key.data(), scan.rid());
+    }
+    loader.finish();
+}
+
+/**
+ * @description: 创建哈希索引，扫描表中已有的记录逐条插入；哈希索引没有顺序，不需要批量构建
+ * 与B+树索引一样是唯一索引，记录中有重复的key时不创建索引，抛出IndexEntryExistsError
+ */
+void SmManager::create_hash_index(TabMeta& tab, const IndexMeta& index_meta, Context* context) {
+    ix_manager_->create_hash_index(tab.name, index_meta.cols);
+    auto ih = ix_manager_->open_hash_index(tab.name, index_meta.cols);
+    auto fh = fhs_.at(tab.name).get();
+    std::vector<char> key(index_meta.col_tot_len);
+    for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+        auto rec = fh->get_record(scan.rid(), context);
+        int offset = 0;
+        for (auto &col : index_meta.cols) {
+            memcpy(key.data() + offset, rec->data + col.offset, col.len);
+            offset += col.len;
+        }
+        if (ih->insert_entry(key.data(), scan.rid(), nullptr) == IX_NO_PAGE) {
+            ix_manager_->close_hash_index(ih.get());
+            ix_manager_->destroy_index(tab.name, index_meta.cols);
+            throw IndexEntryExistsError();
+        }
+    }
+
+    for (auto &col : index_meta.cols) {
+        tab.get_col(col.name)->index = true;
+    }
+    tab.indexes.push_back(index_meta);
+    hihs_.emplace(ix_manager_->get_index_name(tab.name, index_meta.cols), std::move(ih));
+    flush_meta();
 }
 
 /**
@@ -219,4 +303,60 @@ void SmManager::drop_index(const std::string& tab_name, const std::vector<std::s
  */
 void SmManager::drop_index(const std::string& tab_name, const std::vector<ColMeta>& cols, Context* context) {
     
-}
\ No newline at end of file
+}
+
+/**
+ * @description: 在线重建B+树索引（REINDEX），得到按叶子顺序连续存放、填充紧密的新索引，期间不阻塞写操作
+ * 1. 旧索引开始把之后的修改记入side log；
+ * 2. 扫描表，在临时文件中批量构建新索引；
+ * 3. 把side log中的修改分批重放到新索引，直到剩余的修改少于IX_REINDEX_FREEZE_ENTRIES；
+ * 4. 短暂阻塞旧索引上的写操作，重放剩余的修改，用新文件替换旧文件，再在ihs_的写锁下换入新索引
+ * @note 索引的元数据不变，TabMeta::indexes中的项不需要修改
+ * @param {string&} tab_name 表名称
+ * @param {vector<string>&} col_names 索引包含的字段名称
+ * @param {Context*} context
+ */
+void SmManager::reindex(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
+    TabMeta &tab = db_.get_table(tab_name);
+    const IndexMeta &index_meta = *tab.get_index_meta(col_names);
+    if (index_meta.type != INDEX_BTREE) {
+        throw RMDBError("REINDEX only supports B+ tree indexes");
+    }
+    std::string ix_name = ix_manager_->get_index_name(tab_name, index_meta.cols);
+    IxIndexHandle *old_ih = get_index_handle(ix_name);
+
+    old_ih->begin_rebuild();
+    auto new_ih = ix_manager_->create_rebuild_index(old_ih, index_meta.cols);
+    try {
+        bulk_load_index(new_ih.get(), tab, index_meta, context);
+        while (old_ih->replay_side_log(new_ih.get()) >= IX_REINDEX_FREEZE_ENTRIES) {
+        }
+    } catch (...) {
+        old_ih->abort_rebuild();
+        ix_manager_->discard_rebuild_index(new_ih.get());
+        throw;
+    }
+
+    auto freeze = old_ih->freeze_writes();
+    // 旧索引的change buffer与新索引共用日志文件，切换前合并并清空
+    old_ih->merge_all_changes(nullptr);
+    old_ih->replay_side_log(new_ih.get());
+    ix_manager_->close_index(new_ih.get());
+    new_ih.reset();
+    ix_manager_->install_rebuilt_index(ix_name);
+    auto ih = ix_manager_->open_index(tab_name, index_meta.cols);
+    old_ih->finish_rebuild(ih.get());
+
+    std::unique_lock<std::shared_mutex> lock(ihs_latch_);
+    auto &slot = ihs_.at(ix_name);
+    retired_ihs_.push_back(std::move(slot));
+    slot = std::move(ih);
+}
+
+/**
+ * @description: 获取索引文件ix_name的B+树索引，执行器每次使用索引前都通过它获取，以便看到REINDEX换入的新索引
+ */
+IxIndexHandle* SmManager::get_index_handle(const std::string& ix_name) {
+    std::shared_lock<std::shared_mutex> lock(ihs_latch_);
+    return ihs_.at(ix_name).get();
+}
@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <shared_mutex>
+
 #include "index/ix.h"
 #include "record/rm_file_handle.h"
 #include "sm_defs.h"
@@ -30,7 +32,10 @@ class SmManager {
     DbMeta db_;             // 当前打开的数据库的元数据
     std::unordered_map<std::string, std::unique_ptr<RmFileHandle>> fhs_;    // file name -> record file handle, 当前数据库中每张表的数据文件
     std::unordered_map<std::string, std::unique_ptr<IxIndexHandle>> ihs_;   // file name -> index file handle, 当前数据库中每个索引的文件
+    std::unordered_map<std::string, std::unique_ptr<IxHashIndexHandle>> hihs_;  // file name -> hash index file handle, 当前数据库中每个哈希索引的文件
    private:
+    std::shared_mutex ihs_latch_;   // REINDEX替换ihs_中的索引时持有写锁，get_index_handle持有读锁
+    std::vector<std::unique_ptr<IxIndexHandle>> retired_ihs_;   // 被REINDEX替换的旧索引，可能仍被已经开始的语句使用，把写操作转发给新索引
     DiskManager* disk_manager_;
     BufferPoolManager* buffer_pool_manager_;
     RmManager* rm_manager_;
@@ -48,6 +53,8 @@ class SmManager {
 
     BufferPoolManager* get_bpm() { return buffer_pool_manager_; }
 
+    DiskManager* get_disk_manager() { return disk_manager_; }
+
     RmManager* get_rm_manager() { return rm_manager_; }  
 
     IxManager* get_ix_manager() { return ix_manager_; }  
@@ -72,9 +79,19 @@ class SmManager {
 
     void drop_table(const std::string& tab_name, Context* context);
 
-    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                      IndexType type = INDEX_BTREE);
 
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
     
     void drop_index(const std::string& tab_name, const std::vector<ColMeta>& col_names, Context* context);
+
+    void reindex(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+
+    IxIndexHandle* get_index_handle(const std::string& ix_name);
+
+   private:
+    void create_hash_index(TabMeta& tab, const IndexMeta& index_meta, Context* context);
+
+    void bulk_load_index(IxIndexHandle* ih, const TabMeta& tab, const IndexMeta& index_meta, Context* context);
 };
\ No newline at end of file
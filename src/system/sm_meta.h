@@ -45,9 +45,10 @@ struct IndexMeta {
     int col_tot_len;                // 索引字段长度总和
     int col_num;                    // 索引字段数量
     std::vector<ColMeta> cols;      // 索引包含的字段
+    IndexType type = INDEX_BTREE;   // 索引的类型
 
     friend std::ostream &operator<<(std::ostream &os, const IndexMeta &index) {
-        os << index.tab_name << " " << index.col_tot_len << " " << index.col_num;
+        os << index.tab_name << " " << index.col_tot_len << " " << index.col_num << " " << static_cast<int>(index.type);
         for(auto& col: index.cols) {
             os << "\n" << col;
         }
@@ -55,7 +56,9 @@ struct IndexMeta {
     }
 
     friend std::istream &operator>>(std::istream &is, IndexMeta &index) {
-        is >> index.tab_name >> index.col_tot_len >> index.col_num;
+        int type;
+        is >> index.tab_name >> index.col_tot_len >> index.col_num >> type;
+        index.type = static_cast<IndexType>(type);
         for(int i = 0; i < index.col_num; ++i) {
             ColMeta col;
             is >> col;
@@ -76,6 +79,7 @@ struct TabMeta {
     TabMeta(const TabMeta &other) {
         name = other.name;
         for(auto col : other.cols) cols.push_back(col);
+        for(auto index : other.indexes) indexes.push_back(index);
     }
 
     /* 判断当前表中是否存在名为col_name的字段 */
@@ -0,0 +1,457 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <random>  // for std::default_random_engine
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "execution/executor_insert.h"
+#include "execution/executor_update.h"
+#include "storage/buffer_pool_manager.h"
+#include "system/sm.h"
+#include "record/rm.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeBulkLoadTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";                  // 测试文件名的前缀
+const std::vector<std::string> TEST_COL = {"col1"};
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME，并在其中创建表TEST_FILE_NAME(col1 int, col2 int) */
+class BPlusTreeBulkLoadTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<RmManager> rm_;
+    std::unique_ptr<SmManager> sm_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(200, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        rm_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_.get(), ix_manager_.get());
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_->create_db(TEST_DB_NAME);
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        std::vector<ColDef> coldef;
+        coldef.push_back({"col1", TYPE_INT, 4});
+        coldef.push_back({"col2", TYPE_INT, 4});
+        sm_->create_table(TEST_FILE_NAME, coldef, nullptr);
+    }
+
+    void TearDown() override {
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+    };
+
+    /**
+     * @brief 检查以now_page_no为根的子树：孩子的父结点指针正确，内部结点的key是对应孩子的下界，
+     * 孩子的high key等于下一个分隔key，右兄弟指针指向下一个孩子
+     * @return 子树的高度
+     */
+    int check_tree(const IxIndexHandle *ih, int now_page_no) {
+        IxNodeHandle *node = ih->fetch_node(now_page_no);
+        int height = 1;
+        if (!node->is_leaf_page()) {
+            for (int i = 0; i < node->get_size(); i++) {
+                IxNodeHandle *child = ih->fetch_node(node->value_at(i));
+                EXPECT_EQ(child->get_parent_page_no(), now_page_no);
+                if (i > 0) {
+                    EXPECT_LE(node->key_at(i), child->key_at(0));
+                }
+                if (i + 1 < node->get_size()) {
+                    EXPECT_LT(child->key_at(child->get_size() - 1), node->key_at(i + 1));
+                    EXPECT_TRUE(child->has_high_key());
+                    EXPECT_EQ(memcmp(child->get_high_key(), node->get_key(i + 1), ih->file_hdr_->col_tot_len_), 0);
+                    EXPECT_EQ(child->get_next_leaf(), node->value_at(i + 1));
+                }
+                buffer_pool_manager_->unpin_page(child->get_page_id(), false);
+                delete child;
+                height = check_tree(ih, node->value_at(i)) + 1;
+            }
+        }
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        return height;
+    }
+
+    /**
+     * @brief 检查叶子链表以及索引中的键值对与mock一致
+     */
+    void check_all(IxIndexHandle *ih, const std::map<int, Rid> &mock) {
+        check_tree(ih, ih->file_hdr_->root_page_);
+
+        IxScan scan(ih, ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get());
+        auto it = mock.begin();
+        while (!scan.is_end() && it != mock.end()) {
+            ASSERT_EQ(scan.rid(), it->second);
+            it++;
+            scan.next();
+        }
+        ASSERT_TRUE(scan.is_end());
+        ASSERT_EQ(it, mock.end());
+
+        std::vector<Rid> rids;
+        for (auto &entry : mock) {
+            rids.clear();
+            ASSERT_TRUE(ih->get_value((const char *)&entry.first, &rids, nullptr));
+            ASSERT_EQ(rids[0], entry.second);
+        }
+    }
+
+    /**
+     * @brief 沿叶子链表统计叶子结点的数量
+     */
+    int count_leaves(const IxIndexHandle *ih) {
+        int num_leaves = 0;
+        for (page_id_t page_no = ih->file_hdr_->first_leaf_; page_no != IX_LEAF_HEADER_PAGE;) {
+            IxNodeHandle *leaf = ih->fetch_node(page_no);
+            page_no = leaf->get_next_leaf();
+            ih->unpin_node(leaf, false);
+            delete leaf;
+            num_leaves++;
+        }
+        return num_leaves;
+    }
+};
+
+/**
+ * @brief 在已有数据的表上创建索引，索引通过批量构建得到，之后仍可正常插入和删除
+ */
+TEST_F(BPlusTreeBulkLoadTests, CreateIndexOnExistingTable) {
+    const int scale = 20000;
+    std::vector<int> keys;
+    for (int key = 1; key <= scale; key++) {
+        keys.push_back(key);
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    auto fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+    std::map<int, Rid> mock;
+    char buf[8];
+    for (int key : keys) {
+        memcpy(buf, &key, sizeof(int));
+        memcpy(buf + 4, &key, sizeof(int));
+        Rid rid = fh->insert_record(buf, nullptr);
+        mock[key] = rid;
+    }
+
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    auto &tab = sm_->db_.get_table(TEST_FILE_NAME);
+    ASSERT_TRUE(tab.is_index(TEST_COL));
+    IxIndexHandle *ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL)).get();
+
+    // 叶子结点按填充因子装满，且连续存放在根结点之前
+    int fill = static_cast<int>(ih->file_hdr_->btree_order_ * IX_BULK_LOAD_FILL_FACTOR);
+    int num_leaves = (scale + fill - 1) / fill;
+    EXPECT_EQ(ih->file_hdr_->first_leaf_, IX_INIT_ROOT_PAGE);
+    EXPECT_EQ(ih->file_hdr_->last_leaf_, IX_INIT_ROOT_PAGE + num_leaves - 1);
+    EXPECT_EQ(ih->file_hdr_->root_page_, ih->file_hdr_->num_pages_ - 1);
+    check_all(ih, mock);
+
+    // 批量构建之后继续插入和删除
+    for (int key = scale + 1; key <= scale + 2000; key++) {
+        Rid rid = {.page_no = key, .slot_no = key};
+        ASSERT_NE(ih->insert_entry((const char *)&key, rid, nullptr), IX_NO_PAGE);
+        mock[key] = rid;
+    }
+    for (int key = 1; key <= scale; key += 3) {
+        ASSERT_TRUE(ih->delete_entry((const char *)&key, nullptr));
+        mock.erase(key);
+    }
+    check_all(ih, mock);
+}
+
+/**
+ * @brief 在空表上创建索引得到空的B+树，之后可以正常插入
+ */
+TEST_F(BPlusTreeBulkLoadTests, CreateIndexOnEmptyTable) {
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    ASSERT_TRUE(sm_->db_.get_table(TEST_FILE_NAME).is_index(TEST_COL));
+    IxIndexHandle *ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL)).get();
+    EXPECT_EQ(ih->leaf_begin(), ih->leaf_end());
+
+    std::map<int, Rid> mock;
+    for (int key = 1; key <= 1000; key++) {
+        Rid rid = {.page_no = key, .slot_no = key};
+        ASSERT_NE(ih->insert_entry((const char *)&key, rid, nullptr), IX_NO_PAGE);
+        mock[key] = rid;
+    }
+    check_all(ih, mock);
+}
+
+/**
+ * @brief 表中有重复的key时拒绝创建B+树索引和哈希索引，不留下索引文件，去掉重复的记录之后可以创建
+ */
+TEST_F(BPlusTreeBulkLoadTests, CreateIndexOnDuplicateKeys) {
+    auto fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+    std::vector<Rid> rids;
+    char buf[8];
+    for (int key : {2, 3, 3, 9}) {
+        memcpy(buf, &key, sizeof(int));
+        memcpy(buf + 4, &key, sizeof(int));
+        rids.push_back(fh->insert_record(buf, nullptr));
+    }
+
+    std::string ix_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+    EXPECT_THROW(sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr), IndexEntryExistsError);
+    EXPECT_FALSE(sm_->db_.get_table(TEST_FILE_NAME).is_index(TEST_COL));
+    EXPECT_EQ(sm_->ihs_.count(ix_name), 0u);
+    EXPECT_FALSE(disk_manager_->is_file(ix_name));
+    EXPECT_THROW(sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr, INDEX_HASH), IndexEntryExistsError);
+    EXPECT_FALSE(sm_->db_.get_table(TEST_FILE_NAME).is_index(TEST_COL));
+    EXPECT_FALSE(disk_manager_->is_file(ix_name));
+
+    fh->delete_record(rids[2], nullptr);
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    check_all(sm_->ihs_.at(ix_name).get(), {{2, rids[0]}, {3, rids[1]}, {9, rids[3]}});
+}
+
+/**
+ * @brief IxManager设置启用Bloom过滤器之后，通过SmManager在已有的表上创建的索引维护Bloom过滤器，
+ * 包含批量构建时插入的所有key；关闭该设置之后新建的索引不再维护
+ */
+TEST_F(BPlusTreeBulkLoadTests, CreateIndexWithBloomFilter) {
+    auto fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+    const int scale = 2000;
+    char buf[8];
+    for (int i = 0; i < scale; i++) {
+        int key = 2 * i;
+        memcpy(buf, &key, sizeof(int));
+        memcpy(buf + 4, &i, sizeof(int));
+        fh->insert_record(buf, nullptr);
+    }
+
+    ix_manager_->set_bloom_filter(true);
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    IxIndexHandle *ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL)).get();
+    ASSERT_NE(ih->bloom_, nullptr);
+    EXPECT_EQ(ih->bloom_->get_num_keys(), static_cast<size_t>(scale));
+    int num_excluded = 0;
+    for (int i = 0; i < scale; i++) {
+        int key = 2 * i;
+        EXPECT_TRUE(ih->may_contain(reinterpret_cast<const char *>(&key)));
+        key = 2 * i + 1;
+        num_excluded += !ih->may_contain(reinterpret_cast<const char *>(&key));
+    }
+    EXPECT_GT(num_excluded, scale * 95 / 100);
+
+    ix_manager_->set_bloom_filter(false);
+    sm_->create_index(TEST_FILE_NAME, {"col2"}, nullptr);
+    EXPECT_EQ(sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, {"col2"}))->bloom_, nullptr);
+}
+
+/**
+ * @brief IxManager设置启用change buffer之后，通过SmManager创建的索引暂存执行器插入和更新带来的修改：
+ * 唯一性检查叠加暂存的修改，不会把它们立即合并，重复的key（无论在B+树中还是暂存的修改中）仍被拒绝；
+ * 全部合并之后索引与表中的记录一致
+ */
+TEST_F(BPlusTreeBulkLoadTests, CreateIndexWithChangeBuffer) {
+    auto fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+    std::map<int, Rid> mock;
+    char buf[8];
+    for (int i = 0; i < 1000; i++) {
+        int key = 2 * i;
+        memcpy(buf, &key, sizeof(int));
+        memcpy(buf + 4, &i, sizeof(int));
+        mock[key] = fh->insert_record(buf, nullptr);
+    }
+    ix_manager_->set_change_buffer(true);
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    IxIndexHandle *ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL)).get();
+    ASSERT_NE(ih->change_buffer_, nullptr);
+
+    Transaction txn(0);
+    Context context(nullptr, nullptr, &txn);
+    auto insert = [&](int col1, int col2) {
+        std::vector<Value> values(2);
+        values[0].set_int(col1);
+        values[1].set_int(col2);
+        InsertExecutor executor(sm_.get(), TEST_FILE_NAME, values, &context);
+        executor.Next();
+        return executor.rid();
+    };
+    for (int i = 0; i < 100; i++) {
+        mock[2 * i + 1] = insert(2 * i + 1, i);
+    }
+    EXPECT_EQ(ih->change_buffer_->size(), 100u);
+    EXPECT_THROW(insert(1, 0), IndexEntryExistsError);
+    EXPECT_THROW(insert(2, 0), IndexEntryExistsError);
+    EXPECT_EQ(ih->change_buffer_->size(), 100u);
+
+    SetClause set_col1;
+    set_col1.lhs = {.tab_name = TEST_FILE_NAME, .col_name = "col1"};
+    set_col1.rhs.set_int(3);
+    EXPECT_THROW(UpdateExecutor(sm_.get(), TEST_FILE_NAME, {set_col1}, {}, {mock[4]}, &context).Next(),
+                 IndexEntryExistsError);
+    set_col1.rhs.set_int(5001);
+    UpdateExecutor(sm_.get(), TEST_FILE_NAME, {set_col1}, {}, {mock[4]}, &context).Next();
+    mock[5001] = mock[4];
+    mock.erase(4);
+    EXPECT_EQ(ih->change_buffer_->size(), 102u);
+    // 暂存了删除的key可以再次插入
+    mock[4] = insert(4, 0);
+    EXPECT_EQ(ih->change_buffer_->size(), 102u);
+
+    ih->merge_all_changes(nullptr);
+    EXPECT_TRUE(ih->change_buffer_->empty());
+    check_all(ih, mock);
+}
+
+/**
+ * @brief 排序缓冲区放不下所有键值对时写出多个归并段；重复的key无论在同一个归并段中还是不同归并段中都会被发现
+ */
+TEST_F(BPlusTreeBulkLoadTests, ExternalSortTest) {
+    std::vector<ColMeta> cols = {{TEST_FILE_NAME, "col1", TYPE_INT, 4, 0, false}};
+    ix_manager_->create_index(TEST_FILE_NAME, cols);
+    auto ih = ix_manager_->open_index(TEST_FILE_NAME, cols);
+    ih->file_hdr_->btree_order_ = 16;
+
+    const int scale = 9500;
+    std::vector<int> keys;
+    for (int key = 0; key < scale; key++) {
+        keys.push_back(key);
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+    const size_t sort_buffer_size = 1000 * (sizeof(int) + sizeof(Rid));
+
+    // 重复的key分别位于同一个归并段和不同的归并段
+    for (size_t dup_pos : {keys.size() - 10, keys.size() / 2}) {
+        IxBulkLoader loader(ih.get(), 0.75, sort_buffer_size);
+        for (size_t i = 0; i < keys.size(); i++) {
+            loader.add((const char *)&keys[i], Rid{.page_no = keys[i], .slot_no = static_cast<int>(i)});
+        }
+        loader.add((const char *)&keys[dup_pos], Rid{.page_no = -1, .slot_no = -1});
+        EXPECT_THROW(loader.finish(), IndexEntryExistsError);
+    }
+    EXPECT_EQ(ih->file_hdr_->num_pages_, IX_INIT_NUM_PAGES);
+
+    std::map<int, Rid> mock;
+    {
+        IxBulkLoader loader(ih.get(), 0.75, sort_buffer_size);
+        for (size_t i = 0; i < keys.size(); i++) {
+            Rid rid = {.page_no = keys[i], .slot_no = static_cast<int>(i)};
+            loader.add((const char *)&keys[i], rid);
+            mock.emplace(keys[i], rid);
+        }
+        loader.finish();
+        EXPECT_GT(loader.get_num_runs(), 1);
+        EXPECT_EQ(loader.get_num_entries(), static_cast<size_t>(scale));
+    }
+    EXPECT_EQ(check_tree(ih.get(), ih->file_hdr_->root_page_), 4);
+    check_all(ih.get(), mock);
+    ix_manager_->close_index(ih.get());
+
+    // 重新打开之后数据不变，并且可以继续分配新页面
+    ih = ix_manager_->open_index(TEST_FILE_NAME, cols);
+    ih->file_hdr_->btree_order_ = 16;
+    check_all(ih.get(), mock);
+    for (int key = scale; key < scale + 500; key++) {
+        Rid rid = {.page_no = key, .slot_no = key};
+        ASSERT_NE(ih->insert_entry((const char *)&key, rid, nullptr), IX_NO_PAGE);
+        mock[key] = rid;
+    }
+    check_all(ih.get(), mock);
+    ix_manager_->close_index(ih.get());
+}
+
+/**
+ * @brief 大量插入和删除之后在线重建索引：重建期间另一个线程持续修改索引，修改被side log捕获并重放，
+ * 重建后的索引叶子更少，内容与表和并发修改一致；仍持有旧索引的写者被转发到新索引
+ */
+TEST_F(BPlusTreeBulkLoadTests, ReindexUnderConcurrentWrites) {
+    // 插入记录并创建索引之后再删除三分之二的记录，叶子结点填充率很低
+    const int scale = 20000;
+    std::vector<int> keys;
+    for (int key = 1; key <= scale; key++) {
+        keys.push_back(key);
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+    auto fh = sm_->fhs_.at(TEST_FILE_NAME).get();
+    std::map<int, Rid> mock;
+    char buf[8];
+    for (int key : keys) {
+        memcpy(buf, &key, sizeof(int));
+        memcpy(buf + 4, &key, sizeof(int));
+        Rid rid = fh->insert_record(buf, nullptr);
+        mock[key] = rid;
+    }
+    sm_->create_index(TEST_FILE_NAME, TEST_COL, nullptr);
+    std::string ix_name = ix_manager_->get_index_name(TEST_FILE_NAME, TEST_COL);
+    IxIndexHandle *old_ih = sm_->get_index_handle(ix_name);
+    for (int key : keys) {
+        if (key % 3 != 0) {
+            fh->delete_record(mock[key], nullptr);
+            ASSERT_TRUE(old_ih->delete_entry((const char *)&key, nullptr));
+            mock.erase(key);
+        }
+    }
+
+    // 并发的写者每次通过get_index_handle获取索引，插入新的key并删除一部分已有的key
+    std::map<int, Rid> inserted;
+    std::vector<int> deleted;
+    std::thread writer([&] {
+        for (int i = 1; i <= 5000; i++) {
+            int key = scale + i;
+            Rid rid = {.page_no = key, .slot_no = key};
+            sm_->get_index_handle(ix_name)->insert_entry((const char *)&key, rid, nullptr);
+            inserted[key] = rid;
+            if (i % 5 == 0) {
+                int victim = 3 * i;
+                sm_->get_index_handle(ix_name)->delete_entry((const char *)&victim, nullptr);
+                deleted.push_back(victim);
+            }
+        }
+    });
+    sm_->reindex(TEST_FILE_NAME, TEST_COL, nullptr);
+    writer.join();
+    for (auto &entry : inserted) {
+        mock.insert(entry);
+    }
+    for (int key : deleted) {
+        mock.erase(key);
+    }
+
+    IxIndexHandle *ih = sm_->get_index_handle(ix_name);
+    ASSERT_NE(ih, old_ih);
+    EXPECT_LT(count_leaves(ih), count_leaves(old_ih));  // 旧索引保持切换时的内容
+    check_all(ih, mock);
+
+    // 通过旧索引的写操作转发到新索引
+    int key = scale * 2;
+    Rid rid = {.page_no = key, .slot_no = key};
+    ASSERT_NE(old_ih->insert_entry((const char *)&key, rid, nullptr), IX_NO_PAGE);
+    mock[key] = rid;
+    key = 3;
+    ASSERT_TRUE(old_ih->delete_entry((const char *)&key, nullptr));
+    mock.erase(key);
+    check_all(ih, mock);
+
+    // 重建结果保存在原来的索引文件中
+    auto &slot = sm_->ihs_.at(ix_name);
+    ix_manager_->close_index(slot.get());
+    slot = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
+    check_all(slot.get(), mock);
+}
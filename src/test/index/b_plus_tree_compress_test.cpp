@@ -0,0 +1,845 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <random>  // for std::default_random_engine
+#include <thread>
+#include <tuple>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "BPlusTreeCompressTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";                  // 测试文件名的前缀
+const int TEST_KEY_LEN = 32;                                   // 索引字段为char(32)
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME，并在其中创建以char(32)字段为key的索引 */
+class BPlusTreeCompressTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxIndexHandle> ih_;
+    std::vector<ColMeta> cols_ = {{TEST_FILE_NAME, "col1", TYPE_STRING, TEST_KEY_LEN, 0, false}};
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(200, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        if (ix_manager_->exists(TEST_FILE_NAME, cols_)) {
+            ix_manager_->destroy_index(TEST_FILE_NAME, cols_);
+        }
+        ix_manager_->create_index(TEST_FILE_NAME, cols_);
+        ih_ = ix_manager_->open_index(TEST_FILE_NAME, cols_);
+    }
+
+    void TearDown() override {
+        ix_manager_->close_index(ih_.get());
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+    };
+
+    /** 生成有很长公共前缀的key，不足TEST_KEY_LEN的部分补0，与char字段的存放方式一致 */
+    static std::string make_key(int i) {
+        char buf[TEST_KEY_LEN + 1];
+        snprintf(buf, sizeof(buf), "customer@example.com/%08d", i);
+        std::string key(buf);
+        key.resize(TEST_KEY_LEN, '\0');
+        return key;
+    }
+
+    /**
+     * @brief 检查以now_page_no为根的子树：孩子的父结点指针正确，子树中的key都位于父结点的两个分隔key之间，
+     * 孩子的high key等于其右边的分隔key，右兄弟指针指向下一个孩子
+     * @param (lo, hi) 子树中key的范围[lo, hi)，为空表示没有限制
+     * @return 子树中叶子结点的数量
+     */
+    int check_tree(int now_page_no, const std::string &lo, const std::string &hi) {
+        IxNodeHandle *node = ih_->fetch_node(now_page_no);
+        int num_leaves = 0;
+        std::string key(TEST_KEY_LEN, '\0');
+        if (node->is_leaf_page()) {
+            num_leaves = 1;
+            for (int i = 0; i < node->get_size(); i++) {
+                node->get_full_key(i, &key[0]);
+                EXPECT_TRUE(lo.empty() || key >= lo);
+                EXPECT_TRUE(hi.empty() || key < hi);
+            }
+        } else {
+            for (int i = 0; i < node->get_size(); i++) {
+                std::string child_lo = lo;
+                std::string child_hi = hi;
+                if (i > 0) {
+                    node->get_full_key(i, &key[0]);
+                    child_lo = key;
+                }
+                if (i + 1 < node->get_size()) {
+                    node->get_full_key(i + 1, &key[0]);
+                    child_hi = key;
+                }
+
+                IxNodeHandle *child = ih_->fetch_node(node->value_at(i));
+                EXPECT_EQ(child->get_parent_page_no(), now_page_no);
+                EXPECT_FALSE(child->is_deleted());
+                EXPECT_EQ(child->has_high_key(), !child_hi.empty());
+                if (child->has_high_key()) {
+                    EXPECT_EQ(std::string(child->get_high_key(), TEST_KEY_LEN), child_hi);
+                }
+                if (i + 1 < node->get_size()) {
+                    EXPECT_EQ(child->get_next_leaf(), node->value_at(i + 1));
+                }
+                buffer_pool_manager_->unpin_page(child->get_page_id(), false);
+                delete child;
+
+                num_leaves += check_tree(node->value_at(i), child_lo, child_hi);
+            }
+        }
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        delete node;
+        return num_leaves;
+    }
+
+    /**
+     * @brief 检查树的结构、叶子链表以及索引中的键值对与mock一致
+     * @return 叶子结点的数量
+     */
+    int check_all(const std::map<std::string, Rid> &mock) {
+        int num_leaves = check_tree(ih_->file_hdr_->root_page_, "", "");
+
+        IxScan scan(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), buffer_pool_manager_.get());
+        auto it = mock.begin();
+        while (!scan.is_end() && it != mock.end()) {
+            EXPECT_EQ(scan.rid(), it->second);
+            it++;
+            scan.next();
+        }
+        EXPECT_TRUE(scan.is_end());
+        EXPECT_EQ(it, mock.end());
+
+        std::vector<Rid> rids;
+        for (auto &entry : mock) {
+            rids.clear();
+            EXPECT_TRUE(ih_->get_value(entry.first.data(), &rids, nullptr));
+            EXPECT_EQ(rids[0], entry.second);
+        }
+        return num_leaves;
+    }
+};
+
+/**
+ * @brief 字符串key会被压缩：结点内共享公共前缀，内部结点存放截断后的分隔key，一个结点能容纳的键值对多于不压缩时
+ */
+TEST_F(BPlusTreeCompressTests, InsertDeleteTest) {
+    ASSERT_TRUE(ih_->file_hdr_->key_compress_);
+
+    const int scale = 20000;
+    std::vector<int> keys;
+    for (int i = 0; i < scale; i++) {
+        keys.push_back(i);
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    std::map<std::string, Rid> mock;
+    for (int i : keys) {
+        std::string key = make_key(i);
+        Rid rid = {.page_no = i, .slot_no = i};
+        ASSERT_NE(ih_->insert_entry(key.data(), rid, nullptr), IX_NO_PAGE);
+        mock[key] = rid;
+    }
+    // 重复插入不改变索引
+    ASSERT_EQ(ih_->insert_entry(make_key(0).data(), Rid{-1, -1}, nullptr), IX_NO_PAGE);
+
+    int num_leaves = check_all(mock);
+    int uncompressed_order = (PAGE_SIZE - sizeof(IxPageHdr)) / (TEST_KEY_LEN + sizeof(Rid)) - 1;
+    EXPECT_GT(scale / num_leaves, uncompressed_order);
+
+    // 根结点之下的内部结点只存放截断后的分隔key
+    IxNodeHandle *root = ih_->fetch_node(ih_->file_hdr_->root_page_);
+    ASSERT_FALSE(root->is_leaf_page());
+    EXPECT_LT(root->get_prefix_len() + root->get_key_len(), TEST_KEY_LEN);
+    buffer_pool_manager_->unpin_page(root->get_page_id(), false);
+    delete root;
+
+    // 插入前缀完全不同的key，使结点的公共前缀变短
+    for (int i = 0; i < 500; i++) {
+        std::string key = make_key(i * 37);
+        key[0] = 'a' + i % 26;
+        Rid rid = {.page_no = scale + i, .slot_no = i};
+        if (ih_->insert_entry(key.data(), rid, nullptr) != IX_NO_PAGE) {
+            mock[key] = rid;
+        }
+    }
+    check_all(mock);
+
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (int j = 0; j < scale * 9 / 10; j++) {
+        std::string key = make_key(keys[j]);
+        ASSERT_TRUE(ih_->delete_entry(key.data(), nullptr));
+        mock.erase(key);
+    }
+    ASSERT_FALSE(ih_->delete_entry(make_key(keys[0]).data(), nullptr));
+    check_all(mock);
+}
+
+/**
+ * @brief 批量构建压缩的索引：按压缩后占用的字节数装满结点，之后仍可正常插入和删除
+ */
+TEST_F(BPlusTreeCompressTests, BulkLoadTest) {
+    const int scale = 20000;
+    std::map<std::string, Rid> mock;
+    {
+        IxBulkLoader loader(ih_.get());
+        for (int i = scale - 1; i >= 0; i--) {
+            std::string key = make_key(i);
+            Rid rid = {.page_no = i, .slot_no = i};
+            loader.add(key.data(), rid);
+            mock[key] = rid;
+        }
+        loader.finish();
+    }
+    int num_leaves = check_all(mock);
+    int uncompressed_order = (PAGE_SIZE - sizeof(IxPageHdr)) / (TEST_KEY_LEN + sizeof(Rid)) - 1;
+    EXPECT_GT(scale / num_leaves, uncompressed_order);
+
+    for (int i = scale; i < scale + 2000; i++) {
+        std::string key = make_key(i);
+        Rid rid = {.page_no = i, .slot_no = i};
+        ASSERT_NE(ih_->insert_entry(key.data(), rid, nullptr), IX_NO_PAGE);
+        mock[key] = rid;
+    }
+    for (int i = 0; i < scale; i += 3) {
+        std::string key = make_key(i);
+        ASSERT_TRUE(ih_->delete_entry(key.data(), nullptr));
+        mock.erase(key);
+    }
+    check_all(mock);
+}
+
+/**
+ * @brief 多列key编码为规范化的key之后按字节比较，顺序与逐字段比较原始值一致，包括负数和浮点数
+ */
+TEST_F(BPlusTreeCompressTests, NormalizedKeyTest) {
+    std::vector<ColMeta> cols = {{TEST_FILE_NAME, "col2", TYPE_INT, 4, 0, false},
+                                 {TEST_FILE_NAME, "col3", TYPE_FLOAT, 4, 4, false},
+                                 {TEST_FILE_NAME, "col4", TYPE_STRING, 8, 8, false}};
+    ix_manager_->create_index(TEST_FILE_NAME, cols);
+    auto ih = ix_manager_->open_index(TEST_FILE_NAME, cols);
+    const IxFileHdr *file_hdr = ih->file_hdr_;
+    ASSERT_EQ(file_hdr->col_tot_len_, 16);
+
+    using Key = std::tuple<int, float, std::string>;
+    auto to_raw = [](const Key &key) {
+        std::string raw(16, '\0');
+        memcpy(&raw[0], &std::get<0>(key), sizeof(int));
+        memcpy(&raw[4], &std::get<1>(key), sizeof(float));
+        memcpy(&raw[8], std::get<2>(key).data(), std::get<2>(key).size());
+        return raw;
+    };
+
+    std::default_random_engine rng;
+    std::map<Key, Rid> mock;
+    for (int i = 0; i < 5000; i++) {
+        Key key{static_cast<int>(rng() % 200) - 100, static_cast<float>(static_cast<int>(rng() % 2000) - 1000) / 8,
+                std::string(1 + rng() % 7, 'a' + rng() % 3)};
+        std::string raw = to_raw(key);
+        // 规范化的key可以还原为原始值
+        char norm[16], decoded[16];
+        file_hdr->encode_key(raw.data(), norm);
+        ASSERT_EQ(memcmp(file_hdr->decode_key(norm, decoded), raw.data(), 16), 0);
+
+        Rid rid = {.page_no = i, .slot_no = i};
+        bool inserted = ih->insert_entry(raw.data(), rid, nullptr) != IX_NO_PAGE;
+        ASSERT_EQ(inserted, mock.count(key) == 0);
+        mock.emplace(key, rid);
+    }
+
+    IxScan scan(ih.get(), ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get());
+    for (auto &entry : mock) {
+        ASSERT_FALSE(scan.is_end());
+        EXPECT_EQ(scan.rid(), entry.second);
+        scan.next();
+    }
+    EXPECT_TRUE(scan.is_end());
+
+    // 范围查找：第一个字段>=0的第一个键值对
+    Key zero{0, -1e9f, ""};
+    Iid iid = ih->lower_bound(to_raw(zero).data());
+    EXPECT_EQ(ih->get_rid(iid), mock.lower_bound(zero)->second);
+    ix_manager_->close_index(ih.get());
+}
+
+/**
+ * @brief 两列INT的key在打开索引时选择按uint64比较，插入、查找、删除的结果与逐字段比较原始值一致
+ */
+TEST_F(BPlusTreeCompressTests, TwoIntKeyTest) {
+    std::vector<ColMeta> cols = {{TEST_FILE_NAME, "col2", TYPE_INT, 4, 0, false},
+                                 {TEST_FILE_NAME, "col3", TYPE_INT, 4, 4, false}};
+    ix_manager_->create_index(TEST_FILE_NAME, cols);
+    auto ih = ix_manager_->open_index(TEST_FILE_NAME, cols);
+    ASSERT_FALSE(ih->file_hdr_->key_compress_);
+    ASSERT_EQ(ih->file_hdr_->key_search_, IX_SEARCH_UINT64);
+
+    std::default_random_engine rng;
+    std::map<std::pair<int, int>, Rid> mock;
+    int raw[2];
+    for (int i = 0; i < 20000; i++) {
+        raw[0] = static_cast<int>(rng() % 100) - 50;
+        raw[1] = static_cast<int>(rng());
+        Rid rid = {.page_no = i, .slot_no = i};
+        bool inserted = ih->insert_entry(reinterpret_cast<const char *>(raw), rid, nullptr) != IX_NO_PAGE;
+        ASSERT_EQ(inserted, mock.emplace(std::make_pair(raw[0], raw[1]), rid).second);
+    }
+
+    int num_deleted = 0;
+    for (auto it = mock.begin(); it != mock.end(); num_deleted++) {
+        raw[0] = it->first.first;
+        raw[1] = it->first.second;
+        std::vector<Rid> rids;
+        ASSERT_TRUE(ih->get_value(reinterpret_cast<const char *>(raw), &rids, nullptr));
+        ASSERT_EQ(rids[0], it->second);
+        if (num_deleted % 2 == 0) {
+            ASSERT_TRUE(ih->delete_entry(reinterpret_cast<const char *>(raw), nullptr));
+            it = mock.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    IxScan scan(ih.get(), ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get());
+    for (auto &entry : mock) {
+        ASSERT_FALSE(scan.is_end());
+        EXPECT_EQ(scan.rid(), entry.second);
+        scan.next();
+    }
+    EXPECT_TRUE(scan.is_end());
+    ix_manager_->close_index(ih.get());
+}
+
+/**
+ * @brief 批量查找：key无序、有重复、部分不存在，结果与逐个查找一致
+ */
+TEST_F(BPlusTreeCompressTests, BatchLookupTest) {
+    const int scale = 20000;
+    for (int i = 0; i < scale; i += 2) {
+        ASSERT_NE(ih_->insert_entry(make_key(i).data(), Rid{i, i}, nullptr), IX_NO_PAGE);
+    }
+
+    std::vector<Rid> result;
+    EXPECT_EQ(ih_->get_values({}, &result, nullptr), 0u);
+    EXPECT_TRUE(result.empty());
+
+    std::default_random_engine rng;
+    for (int batch_size : {1, 10, 1000, 30000}) {
+        std::vector<std::string> keys;
+        for (int j = 0; j < batch_size; j++) {
+            keys.push_back(make_key(static_cast<int>(rng() % (scale + 100))));
+        }
+        std::vector<const char *> key_ptrs;
+        for (auto &key : keys) {
+            key_ptrs.push_back(key.data());
+        }
+        size_t num_found = ih_->get_values(key_ptrs, &result, nullptr);
+        ASSERT_EQ(result.size(), keys.size());
+        size_t expected_found = 0;
+        for (size_t j = 0; j < keys.size(); j++) {
+            std::vector<Rid> rids;
+            if (ih_->get_value(keys[j].data(), &rids, nullptr)) {
+                expected_found++;
+                EXPECT_EQ(result[j], rids[0]);
+            } else {
+                EXPECT_EQ(result[j], (Rid{IX_NO_PAGE, -1}));
+            }
+        }
+        EXPECT_EQ(num_found, expected_found);
+    }
+}
+
+/**
+ * @brief 查找不阻塞在结构修改上：写线程反复插入和删除奇数key，引起分裂、合并和重分配，
+ * 同时读线程查找始终存在的偶数key，每次都能找到；结束后树的结构正确
+ */
+TEST_F(BPlusTreeCompressTests, ConcurrentLookupTest) {
+    const int scale = 8000;
+    std::map<std::string, Rid> mock;
+    for (int i = 0; i < scale; i += 2) {
+        std::string key = make_key(i);
+        Rid rid = {.page_no = i, .slot_no = i};
+        ASSERT_NE(ih_->insert_entry(key.data(), rid, nullptr), IX_NO_PAGE);
+        mock[key] = rid;
+    }
+
+    const int num_writers = 2;
+    const int num_readers = 2;
+    std::atomic<int> writers_left{num_writers};
+    std::atomic<int> lost{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_writers; t++) {
+        threads.emplace_back([&, t] {
+            for (int round = 0; round < 3; round++) {
+                for (int i = 1 + 2 * t; i < scale; i += 2 * num_writers) {
+                    ih_->insert_entry(make_key(i).data(), Rid{i, i}, nullptr);
+                }
+                for (int i = 1 + 2 * t; i < scale; i += 2 * num_writers) {
+                    ih_->delete_entry(make_key(i).data(), nullptr);
+                }
+            }
+            writers_left--;
+        });
+    }
+    for (int t = 0; t < num_readers; t++) {
+        threads.emplace_back([&, t] {
+            std::default_random_engine rng(t);
+            std::vector<Rid> rids;
+            while (writers_left > 0) {
+                int i = static_cast<int>(rng() % (scale / 2)) * 2;
+                rids.clear();
+                if (!ih_->get_value(make_key(i).data(), &rids, nullptr) || rids[0] != Rid{i, i}) {
+                    lost++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(lost, 0);
+    check_all(mock);
+}
+
+/**
+ * @brief Bloom过滤器：插入的key都可能存在，不存在的key大多被排除；插入超过容量时重建，
+ * 关闭时保存、打开时读入，批量构建后也可以使用
+ */
+TEST_F(BPlusTreeCompressTests, BloomFilterTest) {
+    std::vector<ColMeta> cols = {{TEST_FILE_NAME, "col2", TYPE_INT, 4, 0, false}};
+    ix_manager_->create_index(TEST_FILE_NAME, cols, true);
+    auto ih = ix_manager_->open_index(TEST_FILE_NAME, cols);
+    ASSERT_NE(ih->bloom_, nullptr);
+    size_t init_capacity = ih->bloom_->get_capacity();
+
+    const int scale = 20000;
+    for (int i = 0; i < scale; i++) {
+        int key = 2 * i;
+        ASSERT_NE(ih->insert_entry(reinterpret_cast<const char *>(&key), Rid{i, i}, nullptr), IX_NO_PAGE);
+    }
+    EXPECT_GT(ih->bloom_->get_capacity(), init_capacity);
+    EXPECT_FALSE(ih->bloom_->is_overloaded());
+
+    auto count_absent = [&](IxIndexHandle *ih) {
+        int num_excluded = 0;
+        std::vector<Rid> rids;
+        for (int i = 0; i < scale; i++) {
+            int key = 2 * i;
+            EXPECT_TRUE(ih->may_contain(reinterpret_cast<const char *>(&key)));
+            rids.clear();
+            EXPECT_TRUE(ih->get_value(reinterpret_cast<const char *>(&key), &rids, nullptr));
+            key = 2 * i + 1;
+            num_excluded += !ih->may_contain(reinterpret_cast<const char *>(&key));
+            EXPECT_FALSE(ih->get_value(reinterpret_cast<const char *>(&key), &rids, nullptr));
+        }
+        return num_excluded;
+    };
+    // 每个key占10位时误判率约为1%
+    EXPECT_GT(count_absent(ih.get()), scale * 95 / 100);
+
+    std::string bloom_name = IxManager::get_bloom_name(ix_manager_->get_index_name(TEST_FILE_NAME, cols));
+    size_t capacity = ih->bloom_->get_capacity();
+    ix_manager_->close_index(ih.get());
+    EXPECT_TRUE(disk_manager_->is_file(bloom_name));
+    ih = ix_manager_->open_index(TEST_FILE_NAME, cols);
+    EXPECT_FALSE(disk_manager_->is_file(bloom_name));
+    ASSERT_NE(ih->bloom_, nullptr);
+    EXPECT_EQ(ih->bloom_->get_capacity(), capacity);
+    EXPECT_EQ(ih->bloom_->get_num_keys(), static_cast<size_t>(scale));
+    EXPECT_GT(count_absent(ih.get()), scale * 95 / 100);
+    ix_manager_->close_index(ih.get());
+    ix_manager_->destroy_index(TEST_FILE_NAME, cols);
+    EXPECT_FALSE(disk_manager_->is_file(bloom_name));
+
+    ix_manager_->create_index(TEST_FILE_NAME, cols, true);
+    ih = ix_manager_->open_index(TEST_FILE_NAME, cols);
+    {
+        IxBulkLoader loader(ih.get());
+        for (int i = 0; i < scale; i++) {
+            int key = 2 * i;
+            loader.add(reinterpret_cast<const char *>(&key), Rid{i, i});
+        }
+        loader.finish();
+    }
+    EXPECT_EQ(ih->bloom_->get_num_keys(), static_cast<size_t>(scale));
+    EXPECT_GT(count_absent(ih.get()), scale * 95 / 100);
+    ix_manager_->close_index(ih.get());
+}
+
+/**
+ * @brief change buffer：暂存的插入和删除在读到相应的key时合并，结果与直接修改B+树一致；
+ * 暂存的修改过多时全部合并；没有正常关闭时，重新打开后重放日志恢复未合并的修改
+ */
+TEST_F(BPlusTreeCompressTests, ChangeBufferTest) {
+    std::vector<ColMeta> cols = {{TEST_FILE_NAME, "col2", TYPE_INT, 4, 0, false}};
+    ix_manager_->create_index(TEST_FILE_NAME, cols, false, true);
+    auto ih = ix_manager_->open_index(TEST_FILE_NAME, cols);
+    ASSERT_NE(ih->change_buffer_, nullptr);
+    auto raw = [](const int &key) { return reinterpret_cast<const char *>(&key); };
+
+    std::map<int, Rid> mock;
+    std::default_random_engine rng;
+    for (int i = 0; i < 3000; i++) {
+        int key = static_cast<int>(rng() % 2000) - 1000;
+        if (rng() % 3 == 0) {
+            ih->defer_delete(raw(key), nullptr);
+            mock.erase(key);
+        } else {
+            ih->defer_insert(raw(key), Rid{i, i}, nullptr);
+            mock.emplace(key, Rid{i, i});
+        }
+    }
+    EXPECT_GT(ih->change_buffer_->size(), 0u);
+    EXPECT_EQ(ih->file_hdr_->root_page_, IX_INIT_ROOT_PAGE);
+
+    // 查找时合并对应key上的修改
+    for (int key = -1000; key < 1000; key += 7) {
+        std::vector<Rid> rids;
+        bool found = ih->get_value(raw(key), &rids, nullptr);
+        ASSERT_EQ(found, mock.count(key) == 1);
+        if (found) {
+            EXPECT_EQ(rids[0], mock[key]);
+        }
+    }
+    // 扫描之前合并区间内的修改
+    int lower = -500, upper = 500;
+    ih->merge_changes(raw(lower), raw(upper), nullptr);
+    {
+        // IxScan不能比它所在的索引存活得更久
+        IxScan scan(ih.get(), ih->lower_bound(raw(lower)), ih->upper_bound(raw(upper)), buffer_pool_manager_.get());
+        for (auto it = mock.lower_bound(lower); it != mock.upper_bound(upper); it++) {
+            ASSERT_FALSE(scan.is_end());
+            EXPECT_EQ(scan.rid(), it->second);
+            scan.next();
+        }
+        EXPECT_TRUE(scan.is_end());
+    }
+
+    // 暂存的key达到上限时全部合并
+    for (int key = 0; key < static_cast<int>(IX_CHANGE_BUFFER_MAX_ENTRIES) * 2; key++) {
+        int k = key + 10000;
+        ih->defer_insert(raw(k), Rid{k, k}, nullptr);
+        mock[k] = Rid{k, k};
+    }
+    EXPECT_LT(ih->change_buffer_->size(), IX_CHANGE_BUFFER_MAX_ENTRIES);
+
+    // 模拟崩溃：不合并也不关闭，直接用日志重建change buffer
+    size_t num_pending = ih->change_buffer_->size();
+    std::string log_name = IxManager::get_change_log_name(ix_manager_->get_index_name(TEST_FILE_NAME, cols));
+    IxChangeBuffer replayed(log_name, ih->file_hdr_->col_tot_len_);
+    EXPECT_EQ(replayed.size(), num_pending);
+
+    ix_manager_->close_index(ih.get());
+    EXPECT_FALSE(disk_manager_->is_file(log_name));
+    ih = ix_manager_->open_index(TEST_FILE_NAME, cols);
+    EXPECT_TRUE(ih->change_buffer_->empty());
+    IxScan full(ih.get(), ih->leaf_begin(), ih->leaf_end(), buffer_pool_manager_.get());
+    for (auto &entry : mock) {
+        ASSERT_FALSE(full.is_end());
+        EXPECT_EQ(full.rid(), entry.second);
+        full.next();
+    }
+    EXPECT_TRUE(full.is_end());
+    ix_manager_->close_index(ih.get());
+}
+
+/**
+ * @brief 反复查找的叶子结点建立自适应哈希项；插入、删除、分裂和合并之后，哈希项作废或被版本号校验拒绝，查找结果不变
+ */
+TEST_F(BPlusTreeCompressTests, AdaptiveHashTest) {
+    const int scale = 6000;
+    std::map<std::string, Rid> mock;
+    for (int i = 0; i < scale; i += 2) {
+        ASSERT_NE(ih_->insert_entry(make_key(i).data(), Rid{i, i}, nullptr), IX_NO_PAGE);
+        mock[make_key(i)] = {i, i};
+    }
+    auto check_all = [&]() {
+        for (int i = 0; i < scale; i++) {
+            std::vector<Rid> rids;
+            auto it = mock.find(make_key(i));
+            ASSERT_EQ(ih_->get_value(make_key(i).data(), &rids, nullptr), it != mock.end());
+            if (it != mock.end()) {
+                EXPECT_EQ(rids[0], it->second);
+            }
+        }
+    };
+
+    // 热点key所在的叶子建立哈希项，之后的查找、lower_bound和upper_bound由哈希项直接定位
+    std::vector<Rid> rids;
+    for (int round = 0; round < IX_AHI_HOT_THRESHOLD; round++) {
+        ASSERT_TRUE(ih_->get_value(make_key(1000).data(), &rids, nullptr));
+    }
+    EXPECT_GT(ih_->adaptive_hash_.size(), 0u);
+    char key_buf[IX_MAX_COL_LEN];
+    int slot_no;
+    IxNodeHandle *leaf = ih_->find_hashed_key(ih_->file_hdr_->encode_key(make_key(1000).data(), key_buf), &slot_no);
+    ASSERT_NE(leaf, nullptr);
+    EXPECT_EQ(*leaf->get_rid(slot_no), (Rid{1000, 1000}));
+    leaf->page->runlatch();
+    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+    delete leaf;
+    EXPECT_EQ(ih_->get_rid(ih_->lower_bound(make_key(1000).data())), (Rid{1000, 1000}));
+    EXPECT_EQ(ih_->get_rid(ih_->upper_bound(make_key(1000).data())), (Rid{1002, 1002}));
+    check_all();
+
+    // 在热点叶子中插入使键值对移动并引起分裂，旧的哈希项被版本号校验拒绝或被作废
+    for (int i = 1001; i < 1200; i += 2) {
+        ASSERT_NE(ih_->insert_entry(make_key(i).data(), Rid{i, -i}, nullptr), IX_NO_PAGE);
+        mock[make_key(i)] = {i, -i};
+        for (int round = 0; round < 4; round++) {
+            ASSERT_TRUE(ih_->get_value(make_key(i - 1).data(), &rids, nullptr));
+        }
+    }
+    check_all();
+
+    // 删除热点区域的key引起合并和重分配
+    for (int i = 900; i < 1300; i++) {
+        for (int round = 0; round < 2; round++) {
+            ih_->get_value(make_key(i + 1).data(), &rids, nullptr);
+        }
+        if (mock.erase(make_key(i)) > 0) {
+            ASSERT_TRUE(ih_->delete_entry(make_key(i).data(), nullptr));
+        }
+    }
+    check_all();
+}
+
+/**
+ * @brief 根结点和根结点的内部孩子常驻缓冲池，fetch_node直接返回同一页面；根结点改变或结点被删除后，
+ * 不再是上层结点的页面不再常驻。常驻页面只持有一个常驻pin，其他页面没有pin，说明fetch_node的pin都已配对释放
+ */
+TEST_F(BPlusTreeCompressTests, PinnedUpperNodesTest) {
+    auto check_pins = [&]() {
+        page_id_t root_page_no = ih_->get_root_page_no();
+        for (int i = 0; i < ih_->num_pinned_; i++) {
+            IxNodeHandle node(ih_->file_hdr_, ih_->pinned_pages_[i]);
+            EXPECT_FALSE(node.is_leaf_page());
+            EXPECT_FALSE(node.is_deleted());
+            EXPECT_TRUE(node.get_page_no() == root_page_no || node.get_parent_page_no() == root_page_no);
+        }
+        for (size_t i = 0; i < buffer_pool_manager_->pool_size_; i++) {
+            Page *page = &buffer_pool_manager_->pages_[i];
+            if (page->get_page_id().fd == ih_->fd_ && page->get_page_id().page_no != INVALID_PAGE_ID) {
+                int expected = ih_->find_pinned_page(page->get_page_id().page_no) == page ? 1 : 0;
+                EXPECT_EQ(page->pin_count_.load(), expected) << "page " << page->get_page_id().page_no;
+            }
+        }
+    };
+
+    const int scale = 20000;
+    std::map<std::string, Rid> mock;
+    EXPECT_EQ(ih_->num_pinned_, 0);  // 只有一个叶子根结点时没有常驻结点
+    for (int i = 0; i < scale; i++) {
+        ASSERT_NE(ih_->insert_entry(make_key(i).data(), Rid{i, i}, nullptr), IX_NO_PAGE);
+        mock[make_key(i)] = {i, i};
+    }
+    page_id_t root_page_no = ih_->file_hdr_->root_page_;
+    Page *root_page = ih_->find_pinned_page(root_page_no);
+    ASSERT_NE(root_page, nullptr);
+    IxNodeHandle *root = ih_->fetch_node(root_page_no);
+    EXPECT_EQ(root->page, root_page);
+    EXPECT_FALSE(root->is_leaf_page());
+    EXPECT_EQ(root_page->pin_count_.load(), 2);
+    // fetch_node的pin可以直接交给缓冲池释放
+    buffer_pool_manager_->unpin_page(root->get_page_id(), false);
+    delete root;
+    EXPECT_LE(ih_->num_pinned_, IX_PINNED_NODES);
+    check_all(mock);
+    check_pins();
+
+    // 删除大部分key使树变矮，根结点改变，旧的根结点和被合并的结点不再常驻
+    for (int i = 0; i < scale; i++) {
+        if (i % 50 != 0) {
+            ASSERT_TRUE(ih_->delete_entry(make_key(i).data(), nullptr));
+            mock.erase(make_key(i));
+        }
+    }
+    check_all(mock);
+    check_pins();
+    if (ih_->file_hdr_->root_page_ != root_page_no) {
+        EXPECT_EQ(ih_->find_pinned_page(root_page_no), nullptr);
+        IxNodeHandle *new_root = ih_->fetch_node(ih_->file_hdr_->root_page_);
+        EXPECT_EQ(ih_->find_pinned_page(new_root->get_page_no()) != nullptr, !new_root->is_leaf_page());
+        ih_->unpin_node(new_root, false);
+        delete new_root;
+    }
+
+    // 再次长高，空出的位置留给新的上层结点
+    for (int i = 0; i < scale; i++) {
+        if (i % 50 != 0) {
+            ASSERT_NE(ih_->insert_entry(make_key(i).data(), Rid{i, i}, nullptr), IX_NO_PAGE);
+            mock[make_key(i)] = {i, i};
+        }
+    }
+    check_all(mock);
+    check_pins();
+    EXPECT_NE(ih_->find_pinned_page(ih_->get_root_page_no()), nullptr);
+}
+
+/**
+ * @brief 合并删除的结点在删除时仍在进行的操作结束后进入空闲页面链表，之后的插入重用这些页面，文件不再增长；
+ * 关闭索引时空闲页面链表随文件头保存，重新打开后继续重用
+ */
+TEST_F(BPlusTreeCompressTests, PageRecyclingTest) {
+    const int scale = 20000;
+    std::map<std::string, Rid> mock;
+    auto fill = [&](int round) {
+        for (int i = 0; i < scale; i++) {
+            if (mock.count(make_key(i)) == 0) {
+                ASSERT_NE(ih_->insert_entry(make_key(i).data(), Rid{i, round}, nullptr), IX_NO_PAGE);
+                mock[make_key(i)] = {i, round};
+            }
+        }
+    };
+    auto drain = [&]() {
+        for (int i = 0; i < scale; i++) {
+            if (i % 100 != 0) {
+                ASSERT_TRUE(ih_->delete_entry(make_key(i).data(), nullptr));
+                mock.erase(make_key(i));
+            }
+        }
+    };
+
+    fill(0);
+    drain();
+    EXPECT_EQ(ih_->min_active_epoch(), ih_->op_epoch_.load() + 1);
+    EXPECT_TRUE(ih_->pending_free_.empty());
+    EXPECT_NE(ih_->file_hdr_->first_free_page_no_, IX_NO_PAGE);
+    check_all(mock);
+
+    // 在剩余的key之间插入时按中间拆分，结点比顺序追加时多；此后反复删除和插入，页面全部来自空闲页面链表
+    fill(1);
+    int num_pages = ih_->file_hdr_->num_pages_;
+    drain();
+    for (int round = 2; round <= 4; round++) {
+        fill(round);
+        check_all(mock);
+        EXPECT_LE(ih_->file_hdr_->num_pages_, num_pages + 2);
+        drain();
+        check_all(mock);
+    }
+
+    // 重新打开索引后空闲页面链表仍然有效
+    page_id_t first_free = ih_->file_hdr_->first_free_page_no_;
+    ix_manager_->close_index(ih_.get());
+    ih_ = ix_manager_->open_index(TEST_FILE_NAME, cols_);
+    EXPECT_EQ(ih_->file_hdr_->first_free_page_no_, first_free);
+    fill(5);
+    check_all(mock);
+    EXPECT_LE(ih_->file_hdr_->num_pages_, num_pages + 2);
+}
+
+/**
+ * @brief 被删除的结点只等待删除时仍在进行的操作：删除之后才开始的长时间扫描不推迟它们的回收，
+ * 扫描期间删除的结点在扫描结束后回收
+ */
+TEST_F(BPlusTreeCompressTests, PageRecyclingWithLongScanTest) {
+    const int scale = 20000;
+    std::map<std::string, Rid> mock;
+    for (int i = 0; i < scale; i++) {
+        ASSERT_NE(ih_->insert_entry(make_key(i).data(), Rid{i, i}, nullptr), IX_NO_PAGE);
+        mock[make_key(i)] = {i, i};
+    }
+    auto drain = [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            if (i % 100 != 0) {
+                ASSERT_TRUE(ih_->delete_entry(make_key(i).data(), nullptr));
+                mock.erase(make_key(i));
+            }
+        }
+    };
+
+    // 删除时仍在进行的操作结束之前，被删除的结点不能回收
+    uint64_t op_epoch = ih_->enter_op();
+    drain(0, 2000);
+    size_t num_pending = ih_->pending_free_.size();
+    ASSERT_GT(num_pending, 0u);
+    ASSERT_LT(num_pending, static_cast<size_t>(IX_OP_EPOCHS));
+    EXPECT_EQ(ih_->file_hdr_->first_free_page_no_, IX_NO_PAGE);
+
+    // 删除之后开始的扫描仍然存活时，上述操作结束即可回收
+    auto scan = std::make_unique<IxScan>(ih_.get(), ih_->leaf_begin(), ih_->leaf_end(), buffer_pool_manager_.get());
+    ih_->exit_op(op_epoch);
+    EXPECT_TRUE(ih_->pending_free_.empty());
+    EXPECT_NE(ih_->file_hdr_->first_free_page_no_, IX_NO_PAGE);
+
+    // 扫描期间删除的结点等扫描结束后回收
+    drain(2000, 4000);
+    EXPECT_FALSE(ih_->pending_free_.empty());
+    scan.reset();
+    EXPECT_TRUE(ih_->pending_free_.empty());
+    EXPECT_EQ(ih_->min_active_epoch(), ih_->op_epoch_.load() + 1);
+    check_all(mock);
+}
+
+/**
+ * @brief 空闲页面被重用为新结点后版本号大于重用之前，指向该页面的过期哈希项被版本号校验拒绝，查找结果不变
+ */
+TEST_F(BPlusTreeCompressTests, AdaptiveHashPageReuseTest) {
+    const int scale = 20000;
+    std::map<std::string, Rid> mock;
+    for (int i = 0; i < scale; i++) {
+        ASSERT_NE(ih_->insert_entry(make_key(i).data(), Rid{i, 0}, nullptr), IX_NO_PAGE);
+        mock[make_key(i)] = {i, 0};
+    }
+    for (int i = 0; i < scale; i++) {
+        if (i % 100 != 0) {
+            ASSERT_TRUE(ih_->delete_entry(make_key(i).data(), nullptr));
+            mock.erase(make_key(i));
+        }
+    }
+    page_id_t page_no = ih_->file_hdr_->first_free_page_no_;
+    ASSERT_NE(page_no, IX_NO_PAGE);
+    IxNodeHandle *node = ih_->fetch_node(page_no);
+    uint32_t old_version = node->page_hdr->version;
+    ih_->unpin_node(node, false);
+    delete node;
+
+    // 重新插入，空闲页面链表中的第一个页面最先被重用
+    for (int i = 0; i < scale; i++) {
+        if (mock.count(make_key(i)) == 0) {
+            ASSERT_NE(ih_->insert_entry(make_key(i).data(), Rid{i, 1}, nullptr), IX_NO_PAGE);
+            mock[make_key(i)] = {i, 1};
+        }
+    }
+    node = ih_->fetch_node(page_no);
+    EXPECT_FALSE(node->is_deleted());
+    EXPECT_GT(node->page_hdr->version, old_version);
+    ih_->unpin_node(node, false);
+    delete node;
+
+    // 重用之前建立、之后才被查到的哈希项：指向该页面的slot 0，版本号是重用之前的
+    char key_buf[IX_MAX_COL_LEN];
+    const char *key = ih_->file_hdr_->encode_key(make_key(1).data(), key_buf);
+    ih_->adaptive_hash_.build(page_no, old_version, key, ih_->file_hdr_->col_tot_len_, 1);
+    int slot_no;
+    EXPECT_EQ(ih_->find_hashed_key(key, &slot_no), nullptr);
+    std::vector<Rid> rids;
+    ASSERT_TRUE(ih_->get_value(make_key(1).data(), &rids, nullptr));
+    EXPECT_EQ(rids[0], (Rid{1, 1}));
+    check_all(mock);
+}
@@ -103,7 +103,7 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
                 << "max_size=" << leaf->get_max_size() << ",min_size=" << leaf->get_min_size() << "</TD></TR>\n";
             out << "<TR>";
             for (int i = 0; i < leaf->get_size(); i++) {
-                out << "<TD>" << *reinterpret_cast<int*>(leaf->get_key(i)) << "</TD>\n";
+                out << "<TD>" << leaf->key_at(i) << "</TD>\n";
             }
             out << "</TR>";
             // Print table end
@@ -240,12 +240,15 @@ class BPlusTreeConcurrentTest : public ::testing::Test {
             int child_first_key = child->key_at(0);
             int child_last_key = child->key_at(child->get_size() - 1);
             if (i != 0) {
-                // 除了第0个key之外，node的第i个key与其第i个孩子的第0个key的值相同
-                ASSERT_EQ(node_key, child_first_key);
+                // 除了第0个key之外，node的第i个key是其第i个孩子的下界（B-link树中分隔key不随孩子的第一个key改变）
+                ASSERT_LE(node_key, child_first_key);
             }
             if (i + 1 < node->get_size()) {
-                // 满足制约大小关系
+                // 满足制约大小关系，孩子的high key等于下一个分隔key，右兄弟指针指向下一个孩子
                 ASSERT_LT(child_last_key, node->key_at(i + 1));  // child_last_key < node->KeyAt(i + 1)
+                ASSERT_TRUE(child->has_high_key());
+                ASSERT_EQ(memcmp(child->get_high_key(), node->get_key(i + 1), ih->file_hdr_->col_tot_len_), 0);
+                ASSERT_EQ(child->get_next_leaf(), node->value_at(i + 1));
             }
 
             buffer_pool_manager_->unpin_page(child->get_page_id(), false);
@@ -101,7 +101,7 @@ class BPlusTreeTests : public ::testing::Test {
                 << "max_size=" << leaf->get_max_size() << ",min_size=" << leaf->get_min_size() << "</TD></TR>\n";
             out << "<TR>";
             for (int i = 0; i < leaf->get_size(); i++) {
-                out << "<TD>" << *reinterpret_cast<int*>(leaf->get_key(i)) << "</TD>\n";
+                out << "<TD>" << leaf->key_at(i) << "</TD>\n";
             }
             out << "</TR>";
             // Print table end
@@ -238,12 +238,15 @@ class BPlusTreeTests : public ::testing::Test {
             int child_first_key = child->key_at(0);
             int child_last_key = child->key_at(child->get_size() - 1);
             if (i != 0) {
-                // 除了第0个key之外，node的第i个key与其第i个孩子的第0个key的值相同
-                ASSERT_EQ(node_key, child_first_key);
+                // 除了第0个key之外，node的第i个key是其第i个孩子的下界（B-link树中分隔key不随孩子的第一个key改变）
+                ASSERT_LE(node_key, child_first_key);
             }
             if (i + 1 < node->get_size()) {
-                // 满足制约大小关系
+                // 满足制约大小关系，孩子的high key等于下一个分隔key，右兄弟指针指向下一个孩子
                 ASSERT_LT(child_last_key, node->key_at(i + 1));  // child_last_key < node->KeyAt(i + 1)
+                ASSERT_TRUE(child->has_high_key());
+                ASSERT_EQ(memcmp(child->get_high_key(), node->get_key(i + 1), ih->file_hdr_->col_tot_len_), 0);
+                ASSERT_EQ(child->get_next_leaf(), node->value_at(i + 1));
             }
 
             buffer_pool_manager_->unpin_page(child->get_page_id(), false);
@@ -412,4 +415,39 @@ TEST_F(BPlusTreeTests, LargeScaleTest) {
         scan.next();
     }
     EXPECT_EQ(current_key, keys.size() + 1);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 按递增顺序插入时，最右结点拆分后左边保留IX_APPEND_SPLIT_FILL%的键值对，叶子数量约为从中间拆分时的一半；
+ * 追加直接从缓存的最右叶子结点开始，之后插入较小的key仍然正确
+ */
+TEST_F(BPlusTreeTests, AppendSplitTest) {
+    const int scale = 20000;
+    std::multimap<int, Rid> mock;
+    for (int key = 0; key < 2 * scale; key += 2) {
+        Rid rid = {.page_no = key, .slot_no = key};
+        ASSERT_NE(ih_->insert_entry((const char *)&key, rid, txn_.get()), IX_NO_PAGE);
+        mock.emplace(key, rid);
+    }
+    EXPECT_EQ(ih_->append_leaf_.load(), ih_->file_hdr_->last_leaf_);
+    check_all(ih_.get(), mock);
+
+    int num_leaves = 0;
+    for (page_id_t leaf_no = ih_->file_hdr_->first_leaf_; leaf_no != IX_LEAF_HEADER_PAGE; num_leaves++) {
+        IxNodeHandle *leaf = ih_->fetch_node(leaf_no);
+        leaf_no = leaf->get_next_leaf();
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
+        delete leaf;
+    }
+    int max_leaves = scale / (ih_->file_hdr_->btree_order_ * IX_APPEND_SPLIT_FILL / 100) + 1;
+    EXPECT_LE(num_leaves, max_leaves);
+
+    // 不是追加的插入清除缓存的叶子结点，并从中间拆分
+    for (int key = 1; key < 2 * scale - 100; key += 14) {
+        Rid rid = {.page_no = key, .slot_no = key};
+        ASSERT_NE(ih_->insert_entry((const char *)&key, rid, txn_.get()), IX_NO_PAGE);
+        mock.emplace(key, rid);
+    }
+    EXPECT_EQ(ih_->append_leaf_.load(), IX_NO_PAGE);
+    check_all(ih_.get(), mock);
+}
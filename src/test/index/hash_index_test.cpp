@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <map>
+#include <random>  // for std::default_random_engine
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#define private public
+#include "index/ix.h"
+#undef private  // for use private variables in "ix.h"
+
+#include "storage/buffer_pool_manager.h"
+
+const std::string TEST_DB_NAME = "HashIndexTest_db";  // 以数据库名作为根目录
+const std::string TEST_FILE_NAME = "table1";          // 测试文件名的前缀
+
+/** 对于每个测试点，先创建和进入目录TEST_DB_NAME，并在其中创建以(int, char(8))为key的哈希索引 */
+class HashIndexTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<IxHashIndexHandle> ih_;
+    std::vector<ColMeta> cols_ = {{TEST_FILE_NAME, "col1", TYPE_INT, 4, 0, false},
+                                  {TEST_FILE_NAME, "col2", TYPE_STRING, 8, 4, false}};
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(200, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        ix_manager_->create_hash_index(TEST_FILE_NAME, cols_);
+        ih_ = ix_manager_->open_hash_index(TEST_FILE_NAME, cols_);
+    }
+
+    void TearDown() override {
+        ix_manager_->close_hash_index(ih_.get());
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+    };
+
+    static std::string make_key(int i) {
+        std::string key(12, '\0');
+        memcpy(&key[0], &i, sizeof(int));
+        char suffix[16];  // 足以容纳任意int
+        int len = snprintf(suffix, sizeof(suffix), "k%d", i % 1000000);
+        memcpy(&key[4], suffix, std::min(len, 8));
+        return key;
+    }
+
+    void check_all(const std::map<std::string, Rid> &mock) {
+        std::vector<Rid> rids;
+        for (auto &entry : mock) {
+            rids.clear();
+            ASSERT_TRUE(ih_->get_value(entry.first.data(), &rids, nullptr));
+            ASSERT_EQ(rids.size(), 1u);
+            EXPECT_EQ(rids[0], entry.second);
+        }
+    }
+};
+
+/**
+ * @brief 随机插入、查找和删除，结果与std::map一致；重复的key不能插入
+ */
+TEST_F(HashIndexTests, InsertDeleteTest) {
+    std::default_random_engine rng;
+    std::map<std::string, Rid> mock;
+    for (int i = 0; i < 50000; i++) {
+        std::string key = make_key(static_cast<int>(rng() % 40000));
+        Rid rid = {.page_no = i, .slot_no = i};
+        bool inserted = ih_->insert_entry(key.data(), rid, nullptr) != IX_NO_PAGE;
+        ASSERT_EQ(inserted, mock.emplace(key, rid).second);
+    }
+    EXPECT_GT(ih_->get_global_depth(), 0);
+    check_all(mock);
+
+    int num_deleted = 0;
+    for (auto it = mock.begin(); it != mock.end(); num_deleted++) {
+        if (num_deleted % 3 == 0) {
+            ASSERT_TRUE(ih_->delete_entry(it->first.data(), nullptr));
+            ASSERT_FALSE(ih_->delete_entry(it->first.data(), nullptr));
+            std::vector<Rid> rids;
+            ASSERT_FALSE(ih_->get_value(it->first.data(), &rids, nullptr));
+            it = mock.erase(it);
+        } else {
+            it++;
+        }
+    }
+    check_all(mock);
+
+    // 删除后空出的位置可以重新插入
+    for (int i = 40000; i < 45000; i++) {
+        std::string key = make_key(i);
+        Rid rid = {.page_no = i, .slot_no = -i};
+        ASSERT_NE(ih_->insert_entry(key.data(), rid, nullptr), IX_NO_PAGE);
+        mock[key] = rid;
+    }
+    check_all(mock);
+}
+
+/**
+ * @brief 桶很小时频繁分裂，目录扩展到多个目录页；关闭后重新打开，目录和桶都能恢复
+ */
+TEST_F(HashIndexTests, DirectoryGrowthAndReopenTest) {
+    ih_->file_hdr_.bucket_capacity_ = 4;
+    std::map<std::string, Rid> mock;
+    for (int i = 0; i < 20000; i++) {
+        std::string key = make_key(i * 7919);
+        Rid rid = {.page_no = i, .slot_no = i};
+        ASSERT_NE(ih_->insert_entry(key.data(), rid, nullptr), IX_NO_PAGE);
+        mock[key] = rid;
+    }
+    EXPECT_GT(1 << ih_->get_global_depth(), IX_HASH_DIR_ENTRIES_PER_PAGE);
+    EXPECT_GT(ih_->file_hdr_.dir_pages_.size(), 1u);
+    check_all(mock);
+
+    ix_manager_->close_hash_index(ih_.get());
+    ih_ = ix_manager_->open_hash_index(TEST_FILE_NAME, cols_);
+    EXPECT_EQ(ih_->file_hdr_.bucket_capacity_, 4);
+    check_all(mock);
+    for (auto &entry : mock) {
+        ASSERT_EQ(ih_->insert_entry(entry.first.data(), Rid{-1, -1}, nullptr), IX_NO_PAGE);
+    }
+}
+
+/**
+ * @brief 多个线程并发插入不同的key，插入引起的桶分裂和目录加倍不丢失键值对
+ */
+TEST_F(HashIndexTests, ConcurrentInsertTest) {
+    ih_->file_hdr_.bucket_capacity_ = 16;
+    const int num_threads = 4;
+    const int per_thread = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = t; i < num_threads * per_thread; i += num_threads) {
+                std::string key = make_key(i);
+                Rid rid = {.page_no = i, .slot_no = i};
+                ASSERT_NE(ih_->insert_entry(key.data(), rid, nullptr), IX_NO_PAGE);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    std::map<std::string, Rid> mock;
+    for (int i = 0; i < num_threads * per_thread; i++) {
+        mock[make_key(i)] = {.page_no = i, .slot_no = i};
+    }
+    check_all(mock);
+}
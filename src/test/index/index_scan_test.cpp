@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <random>  // for std::default_random_engine
+#include <set>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_delete.h"
+#include "execution/executor_index_scan.h"
+#include "execution/executor_insert.h"
+#include "execution/executor_update.h"
+#include "index/ix.h"
+#include "record/rm.h"
+#include "storage/buffer_pool_manager.h"
+#include "system/sm.h"
+
+const std::string TEST_DB_NAME = "IndexScanTest_db";  // 以数据库名作为根目录
+const std::string TEST_TAB_NAME = "table1";           // 测试表名
+const std::vector<std::string> TEST_INDEX_COLS = {"a", "b"};
+
+/** 对于每个测试点，先创建和进入数据库TEST_DB_NAME，并创建表TEST_TAB_NAME(a int, b int, c float)及索引(a, b) */
+class IndexScanTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<RmManager> rm_;
+    std::unique_ptr<SmManager> sm_;
+
+    std::vector<std::tuple<int, int, float>> rows_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(200, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        rm_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_.get(), ix_manager_.get());
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_->create_db(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        std::vector<ColDef> coldef = {{"a", TYPE_INT, 4}, {"b", TYPE_INT, 4}, {"c", TYPE_FLOAT, 4}};
+        sm_->create_table(TEST_TAB_NAME, coldef, nullptr);
+
+        // a取值较少，使等值前缀之后仍有大量重复；(a, b)唯一
+        std::default_random_engine rng;
+        auto fh = sm_->fhs_.at(TEST_TAB_NAME).get();
+        std::set<std::pair<int, int>> seen;
+        char buf[12];
+        while (rows_.size() < 5000) {
+            int a = static_cast<int>(rng() % 20) - 10;
+            int b = static_cast<int>(rng() % 2000) - 1000;
+            float c = static_cast<float>(rng() % 100) / 4;
+            if (!seen.emplace(a, b).second) {
+                continue;
+            }
+            memcpy(buf, &a, 4);
+            memcpy(buf + 4, &b, 4);
+            memcpy(buf + 8, &c, 4);
+            fh->insert_record(buf, nullptr);
+            rows_.emplace_back(a, b, c);
+        }
+        sm_->create_index(TEST_TAB_NAME, TEST_INDEX_COLS, nullptr);
+    }
+
+    void TearDown() override {
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    };
+
+    static Condition make_cond(const std::string &col_name, CompOp op, int val) {
+        Condition cond;
+        cond.lhs_col = {.tab_name = TEST_TAB_NAME, .col_name = col_name};
+        cond.op = op;
+        cond.is_rhs_val = true;
+        cond.rhs_val.set_int(val);
+        cond.rhs_val.init_raw(sizeof(int));
+        return cond;
+    }
+
+    static bool eval(int lhs, CompOp op, int rhs) {
+        switch (op) {
+            case OP_EQ: return lhs == rhs;
+            case OP_NE: return lhs != rhs;
+            case OP_LT: return lhs < rhs;
+            case OP_GT: return lhs > rhs;
+            case OP_LE: return lhs <= rhs;
+            case OP_GE: return lhs >= rhs;
+        }
+        return false;
+    }
+
+    /** 用索引扫描得到满足conds的(a, b)，与逐行过滤的结果比较，二者都应按(a, b)有序（reverse时为降序） */
+    void check_scan(const std::vector<Condition> &conds, bool index_only = false, bool reverse = false) {
+        std::vector<std::pair<int, int>> expected;
+        for (auto &[a, b, c] : rows_) {
+            bool ok = true;
+            for (auto &cond : conds) {
+                int lhs = cond.lhs_col.col_name == "a" ? a : b;
+                ok = ok && eval(lhs, cond.op, cond.rhs_val.int_val);
+            }
+            if (ok) {
+                expected.emplace_back(a, b);
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        if (reverse) {
+            std::reverse(expected.begin(), expected.end());
+        }
+
+        std::vector<std::pair<int, int>> actual;
+        IndexScanExecutor executor(sm_.get(), TEST_TAB_NAME, conds, TEST_INDEX_COLS, nullptr, index_only, reverse);
+        EXPECT_EQ(executor.tupleLen(), index_only ? 8u : 12u);
+        for (executor.beginTuple(); !executor.is_end(); executor.nextTuple()) {
+            auto rec = executor.Next();
+            actual.emplace_back(*reinterpret_cast<int *>(rec->data), *reinterpret_cast<int *>(rec->data + 4));
+        }
+        EXPECT_EQ(actual, expected);
+    }
+};
+
+/**
+ * @brief 等值前缀加一个范围字段：条件的顺序任意，区间的开闭和空区间都能正确处理
+ */
+TEST_F(IndexScanTests, PrefixAndRange) {
+    check_scan({make_cond("a", OP_EQ, 3)});
+    check_scan({make_cond("b", OP_LT, 100), make_cond("a", OP_EQ, -4)});
+    check_scan({make_cond("a", OP_EQ, 0), make_cond("b", OP_GE, -500), make_cond("b", OP_LE, 500)});
+    check_scan({make_cond("a", OP_EQ, 0), make_cond("b", OP_GT, -500), make_cond("b", OP_LT, 500)});
+    check_scan({make_cond("a", OP_GT, 5)});
+    check_scan({make_cond("a", OP_LE, -8)});
+    check_scan({make_cond("a", OP_GE, -2), make_cond("a", OP_LT, 2), make_cond("b", OP_EQ, 7)});
+    // 空区间
+    check_scan({make_cond("a", OP_GT, 3), make_cond("a", OP_LT, 3)});
+    check_scan({make_cond("a", OP_EQ, 1), make_cond("b", OP_GT, 10), make_cond("b", OP_LE, 10)});
+    check_scan({make_cond("a", OP_EQ, 100)});
+    // 不能转换为区间的条件在扫描时过滤
+    check_scan({make_cond("a", OP_EQ, 2), make_cond("b", OP_NE, 0)});
+}
+
+/**
+ * @brief 随机的条件组合与逐行过滤的结果一致
+ */
+TEST_F(IndexScanTests, RandomConditions) {
+    std::default_random_engine rng(2023);
+    const CompOp ops[] = {OP_EQ, OP_NE, OP_LT, OP_GT, OP_LE, OP_GE};
+    for (int round = 0; round < 200; round++) {
+        std::vector<Condition> conds;
+        int num_conds = 1 + rng() % 3;
+        for (int i = 0; i < num_conds; i++) {
+            bool on_a = rng() % 2;
+            int val = on_a ? static_cast<int>(rng() % 24) - 12 : static_cast<int>(rng() % 2200) - 1100;
+            conds.push_back(make_cond(on_a ? "a" : "b", ops[rng() % 6], val));
+        }
+        check_scan(conds);
+    }
+}
+
+/**
+ * @brief 索引覆盖查询所需的字段时只扫描索引，元组由key构造，只包含索引字段
+ */
+TEST_F(IndexScanTests, IndexOnly) {
+    check_scan({make_cond("a", OP_EQ, 3)}, true);
+    check_scan({make_cond("a", OP_GE, -2), make_cond("a", OP_LT, 2), make_cond("b", OP_NE, 7)}, true);
+    check_scan({make_cond("a", OP_GT, 3), make_cond("a", OP_LT, 3)}, true);
+
+    // 删除表中的记录而保留索引，index-only扫描不读取表中的记录，结果不变
+    std::vector<Condition> conds = {make_cond("a", OP_EQ, -5), make_cond("b", OP_GT, 0)};
+    IndexScanExecutor executor(sm_.get(), TEST_TAB_NAME, conds, TEST_INDEX_COLS, nullptr, true);
+    ASSERT_EQ(executor.cols().size(), 2u);
+    EXPECT_EQ(executor.cols()[1].offset, 4);
+    auto fh = sm_->fhs_.at(TEST_TAB_NAME).get();
+    for (executor.beginTuple(); !executor.is_end(); executor.nextTuple()) {
+        fh->delete_record(executor.rid(), nullptr);
+    }
+    check_scan(conds, true);
+}
+
+/**
+ * @brief 反向扫描沿prev_leaf按key降序返回同样的结果，区间跨越多个叶子或为空时都正确
+ */
+TEST_F(IndexScanTests, ReverseScan) {
+    check_scan({}, false, true);
+    check_scan({make_cond("a", OP_EQ, 3)}, false, true);
+    check_scan({make_cond("a", OP_GE, -2), make_cond("a", OP_LT, 2), make_cond("b", OP_NE, 7)}, true, true);
+    check_scan({make_cond("a", OP_EQ, 0), make_cond("b", OP_GT, -500), make_cond("b", OP_LE, 500)}, false, true);
+    check_scan({make_cond("a", OP_GT, 3), make_cond("a", OP_LT, 3)}, false, true);
+    check_scan({make_cond("a", OP_EQ, 100)}, true, true);
+
+    std::default_random_engine rng(2024);
+    const CompOp ops[] = {OP_EQ, OP_NE, OP_LT, OP_GT, OP_LE, OP_GE};
+    for (int round = 0; round < 50; round++) {
+        std::vector<Condition> conds;
+        for (int i = 0; i < 2; i++) {
+            bool on_a = rng() % 2;
+            int val = on_a ? static_cast<int>(rng() % 24) - 12 : static_cast<int>(rng() % 2200) - 1100;
+            conds.push_back(make_cond(on_a ? "a" : "b", ops[rng() % 6], val));
+        }
+        check_scan(conds, round % 2, true);
+    }
+}
+
+/**
+ * @brief DeleteExecutor删除记录的同时删除各个索引中的键值对，之后的索引扫描不再返回这些记录
+ */
+TEST_F(IndexScanTests, DeleteExecutor) {
+    std::vector<Condition> conds = {make_cond("a", OP_EQ, 3), make_cond("b", OP_LT, 0)};
+    std::vector<Rid> rids;
+    IndexScanExecutor scan(sm_.get(), TEST_TAB_NAME, conds, TEST_INDEX_COLS, nullptr);
+    for (scan.beginTuple(); !scan.is_end(); scan.nextTuple()) {
+        rids.push_back(scan.rid());
+    }
+    ASSERT_FALSE(rids.empty());
+
+    Transaction txn(0);
+    Context context(nullptr, nullptr, &txn);
+    DeleteExecutor executor(sm_.get(), TEST_TAB_NAME, conds, rids, &context);
+    executor.Next();
+    rows_.erase(std::remove_if(rows_.begin(), rows_.end(),
+                               [](auto &row) { return std::get<0>(row) == 3 && std::get<1>(row) < 0; }),
+                rows_.end());
+    check_scan({make_cond("a", OP_EQ, 3)});
+    check_scan({make_cond("a", OP_GE, 2), make_cond("a", OP_LE, 4)}, true);
+    auto fh = sm_->fhs_.at(TEST_TAB_NAME).get();
+    for (auto &rid : rids) {
+        EXPECT_FALSE(fh->is_record(rid));
+    }
+}
+
+/**
+ * @brief UpdateExecutor原地更新记录：只更新非索引字段时索引不变，索引字段变化时索引中的key随之改变
+ */
+TEST_F(IndexScanTests, UpdateExecutor) {
+    auto fh = sm_->fhs_.at(TEST_TAB_NAME).get();
+    Transaction txn(0);
+    Context context(nullptr, nullptr, &txn);
+    std::vector<Condition> conds = {make_cond("a", OP_EQ, -7)};
+    std::vector<Rid> rids;
+    IndexScanExecutor scan(sm_.get(), TEST_TAB_NAME, conds, TEST_INDEX_COLS, nullptr);
+    for (scan.beginTuple(); !scan.is_end(); scan.nextTuple()) {
+        rids.push_back(scan.rid());
+    }
+    ASSERT_FALSE(rids.empty());
+
+    // 只更新c，记录仍在原来的位置，索引扫描得到同样的rid
+    SetClause set_c;
+    set_c.lhs = {.tab_name = TEST_TAB_NAME, .col_name = "c"};
+    set_c.rhs.set_float(99.5f);
+    UpdateExecutor(sm_.get(), TEST_TAB_NAME, {set_c}, conds, rids, &context).Next();
+    std::vector<Rid> after;
+    IndexScanExecutor rescan(sm_.get(), TEST_TAB_NAME, conds, TEST_INDEX_COLS, nullptr);
+    for (rescan.beginTuple(); !rescan.is_end(); rescan.nextTuple()) {
+        after.push_back(rescan.rid());
+        EXPECT_EQ(*reinterpret_cast<float *>(rescan.Next()->data + 8), 99.5f);
+    }
+    EXPECT_EQ(after, rids);
+
+    // 把a = -7的记录移到a = 50，原key从索引中删除，新key指向同一条记录
+    SetClause set_a;
+    set_a.lhs = {.tab_name = TEST_TAB_NAME, .col_name = "a"};
+    set_a.rhs.set_int(50);
+    UpdateExecutor(sm_.get(), TEST_TAB_NAME, {set_a}, conds, rids, &context).Next();
+    for (auto &[a, b, c] : rows_) {
+        if (a == -7) {
+            a = 50;
+        }
+    }
+    check_scan({make_cond("a", OP_EQ, -7)});
+    check_scan({make_cond("a", OP_GE, 40)}, true);
+    for (auto &rid : rids) {
+        EXPECT_EQ(*reinterpret_cast<int *>(fh->get_record(rid, nullptr)->data), 50);
+    }
+}
+
+/**
+ * @brief 插入或更新之后索引中会出现重复的key时报错，记录和索引都保持不变
+ */
+TEST_F(IndexScanTests, DuplicateKeyRejected) {
+    auto fh = sm_->fhs_.at(TEST_TAB_NAME).get();
+    Transaction txn(0);
+    Context context(nullptr, nullptr, &txn);
+    std::vector<Condition> conds = {make_cond("a", OP_EQ, 4)};
+    std::vector<Rid> rids;
+    std::vector<int> bs;
+    IndexScanExecutor scan(sm_.get(), TEST_TAB_NAME, conds, TEST_INDEX_COLS, nullptr);
+    for (scan.beginTuple(); !scan.is_end(); scan.nextTuple()) {
+        rids.push_back(scan.rid());
+        bs.push_back(*reinterpret_cast<int *>(scan.Next()->data + 4));
+    }
+    ASSERT_GE(rids.size(), 2u);
+    auto set_clause = [](const std::string &col_name, int val) {
+        SetClause set;
+        set.lhs = {.tab_name = TEST_TAB_NAME, .col_name = col_name};
+        set.rhs.set_int(val);
+        return set;
+    };
+
+    // 第二条记录的b改为第一条记录的b；两条记录改为同一个b
+    EXPECT_THROW(UpdateExecutor(sm_.get(), TEST_TAB_NAME, {set_clause("b", bs[0])}, conds, {rids[1]}, &context).Next(),
+                 IndexEntryExistsError);
+    EXPECT_THROW(UpdateExecutor(sm_.get(), TEST_TAB_NAME, {set_clause("b", 5000)}, conds, {rids[0], rids[1]}, &context)
+                     .Next(),
+                 IndexEntryExistsError);
+    EXPECT_EQ(*reinterpret_cast<int *>(fh->get_record(rids[1], nullptr)->data + 4), bs[1]);
+
+    // 插入已存在的(a, b)
+    std::vector<Value> values(3);
+    values[0].set_int(4);
+    values[1].set_int(bs[0]);
+    values[2].set_float(1.0f);
+    EXPECT_THROW(InsertExecutor(sm_.get(), TEST_TAB_NAME, values, &context).Next(), IndexEntryExistsError);
+    int num_records = 0;
+    for (RmScan rm_scan(fh); !rm_scan.is_end(); rm_scan.next()) {
+        num_records++;
+    }
+    EXPECT_EQ(num_records, static_cast<int>(rows_.size()));
+    check_scan({make_cond("a", OP_EQ, 4)});
+    check_scan({make_cond("a", OP_GE, -10)}, true);
+}
+
+/**
+ * @brief 哈希索引只用于所有字段都是等值条件的查询，其余条件在扫描时过滤
+ */
+TEST_F(IndexScanTests, HashIndex) {
+    const std::vector<std::string> hash_cols = {"b", "a"};
+    sm_->create_index(TEST_TAB_NAME, hash_cols, nullptr, INDEX_HASH);
+    ASSERT_EQ(sm_->db_.get_table(TEST_TAB_NAME).get_index_meta(hash_cols)->type, INDEX_HASH);
+
+    for (int i = 0; i < 200; i += 7) {
+        auto &[a, b, c] = rows_[i];
+        for (bool index_only : {false, true}) {
+            std::vector<Condition> conds = {make_cond("a", OP_EQ, a), make_cond("b", OP_EQ, b)};
+            IndexScanExecutor executor(sm_.get(), TEST_TAB_NAME, conds, hash_cols, nullptr, index_only);
+            executor.beginTuple();
+            ASSERT_FALSE(executor.is_end());
+            auto rec = executor.Next();
+            int col_a = index_only ? 4 : 0;
+            int col_b = index_only ? 0 : 4;
+            EXPECT_EQ(*reinterpret_cast<int *>(rec->data + col_a), a);
+            EXPECT_EQ(*reinterpret_cast<int *>(rec->data + col_b), b);
+            executor.nextTuple();
+            EXPECT_TRUE(executor.is_end());
+
+            // 其余条件不满足时没有结果
+            conds.push_back(make_cond("a", OP_NE, a));
+            IndexScanExecutor filtered(sm_.get(), TEST_TAB_NAME, conds, hash_cols, nullptr, index_only);
+            filtered.beginTuple();
+            EXPECT_TRUE(filtered.is_end());
+        }
+    }
+    // 不存在的key
+    std::vector<Condition> conds = {make_cond("a", OP_EQ, 100), make_cond("b", OP_EQ, 0)};
+    IndexScanExecutor executor(sm_.get(), TEST_TAB_NAME, conds, hash_cols, nullptr);
+    executor.beginTuple();
+    EXPECT_TRUE(executor.is_end());
+}
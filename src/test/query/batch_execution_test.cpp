@@ -0,0 +1,511 @@
+#include <algorithm>
+#include <random>  // for std::default_random_engine
+
+#include "gtest/gtest.h"
+
+#include "execution/execution_sort.h"
+#include "execution/executor_hash_join.h"
+#include "execution/executor_index_scan.h"
+#include "execution/executor_merge_join.h"
+#include "execution/executor_nestedloop_join.h"
+#include "execution/executor_projection.h"
+#include "execution/executor_seq_scan.h"
+#include "index/ix.h"
+#include "record/rm.h"
+#include "storage/buffer_pool_manager.h"
+#include "system/sm.h"
+
+const std::string TEST_DB_NAME = "BatchExecutionTest_db";  // 以数据库名作为根目录
+const std::string TEST_TAB1 = "t1";                         // t1(a int, b int, c char(8))
+const std::string TEST_TAB2 = "t2";                         // t2(a int, d float)
+
+/** 对于每个测试点，先创建和进入数据库TEST_DB_NAME，并向t1插入跨越多批的记录、向t2插入少量记录 */
+class BatchExecutionTests : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<RmManager> rm_;
+    std::unique_ptr<SmManager> sm_;
+
+    std::vector<std::tuple<int, int, std::string>> rows1_;
+    std::vector<std::pair<int, float>> rows2_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(200, disk_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        rm_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_.get(), ix_manager_.get());
+
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            std::string cmd = "rm -rf " + TEST_DB_NAME;
+            if (system(cmd.c_str()) < 0) {
+                throw UnixError();
+            }
+        }
+        sm_->create_db(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+        sm_->create_table(TEST_TAB1, {{"a", TYPE_INT, 4}, {"b", TYPE_INT, 4}, {"c", TYPE_STRING, 8}}, nullptr);
+        sm_->create_table(TEST_TAB2, {{"a", TYPE_INT, 4}, {"d", TYPE_FLOAT, 4}}, nullptr);
+
+        std::default_random_engine rng;
+        auto fh1 = sm_->fhs_.at(TEST_TAB1).get();
+        char buf1[16];
+        for (int i = 0; i < 5000; i++) {
+            int a = static_cast<int>(rng() % 200);
+            int b = i * 7919 % 100000 - 50000;  // b各不相同，可以在b上建索引
+            std::string c = "s" + std::to_string(rng() % 1000);
+            memcpy(buf1, &a, 4);
+            memcpy(buf1 + 4, &b, 4);
+            memset(buf1 + 8, 0, 8);
+            memcpy(buf1 + 8, c.data(), c.size());
+            fh1->insert_record(buf1, nullptr);
+            rows1_.emplace_back(a, b, c);
+        }
+        auto fh2 = sm_->fhs_.at(TEST_TAB2).get();
+        char buf2[8];
+        for (int i = 0; i < 40; i++) {
+            int a = i * 3;
+            float d = static_cast<float>(i) / 2;
+            memcpy(buf2, &a, 4);
+            memcpy(buf2 + 4, &d, 4);
+            fh2->insert_record(buf2, nullptr);
+            rows2_.emplace_back(a, d);
+        }
+    }
+
+    void TearDown() override {
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    };
+
+    static Condition make_cond(const std::string &tab_name, const std::string &col_name, CompOp op, int val) {
+        Condition cond;
+        cond.lhs_col = {.tab_name = tab_name, .col_name = col_name};
+        cond.op = op;
+        cond.is_rhs_val = true;
+        cond.rhs_val.set_int(val);
+        cond.rhs_val.init_raw(sizeof(int));
+        return cond;
+    }
+
+    static Condition make_join_cond(const TabCol &lhs, CompOp op, const TabCol &rhs) {
+        Condition cond;
+        cond.lhs_col = lhs;
+        cond.op = op;
+        cond.is_rhs_val = false;
+        cond.rhs_col = rhs;
+        return cond;
+    }
+
+    /** 按批取出executor的全部结果，每条记录按cols中的偏移拼接 */
+    static std::vector<std::string> collect_batches(AbstractExecutor &executor) {
+        std::vector<std::string> recs;
+        std::vector<char> buf(executor.tupleLen());
+        RecordBatch batch;
+        executor.beginBatch();
+        while (executor.nextBatch(batch)) {
+            EXPECT_GT(batch.num_selected(), 0);
+            EXPECT_LE(batch.num_rows, batch.capacity);
+            for (int row : batch.sel) {
+                batch.gather_row(row, executor.cols(), buf.data());
+                recs.emplace_back(buf.data(), buf.size());
+            }
+        }
+        return recs;
+    }
+
+    /** 通过元组接口取出executor的全部结果 */
+    static std::vector<std::string> collect_tuples(AbstractExecutor &executor) {
+        std::vector<std::string> recs;
+        for (executor.beginTuple(); !executor.is_end(); executor.nextTuple()) {
+            auto rec = executor.Next();
+            recs.emplace_back(rec->data, executor.tupleLen());
+        }
+        return recs;
+    }
+
+    static int int_at(const std::string &rec, int offset) {
+        int val;
+        memcpy(&val, rec.data() + offset, sizeof(int));
+        return val;
+    }
+};
+
+/**
+ * @brief 顺序扫描按批过滤的结果与逐行求值一致，元组接口得到同样的结果，记录号指向原记录
+ */
+TEST_F(BatchExecutionTests, SeqScanFilter) {
+    std::vector<Condition> conds = {make_cond(TEST_TAB1, "a", OP_LT, 50), make_cond(TEST_TAB1, "b", OP_GE, 0)};
+    std::vector<std::pair<int, int>> expected;
+    for (auto &[a, b, c] : rows1_) {
+        if (a < 50 && b >= 0) {
+            expected.emplace_back(a, b);
+        }
+    }
+
+    SeqScanExecutor scan(sm_.get(), TEST_TAB1, conds, nullptr);
+    auto recs = collect_batches(scan);
+    std::vector<std::pair<int, int>> actual;
+    for (auto &rec : recs) {
+        actual.emplace_back(int_at(rec, 0), int_at(rec, 4));
+    }
+    EXPECT_EQ(actual, expected);
+    EXPECT_EQ(collect_tuples(scan), recs);
+
+    auto fh = sm_->fhs_.at(TEST_TAB1).get();
+    for (scan.beginTuple(); !scan.is_end(); scan.nextTuple()) {
+        EXPECT_EQ(std::string(fh->get_record(scan.rid(), nullptr)->data, scan.tupleLen()),
+                  std::string(scan.Next()->data, scan.tupleLen()));
+    }
+
+    // 没有满足条件的记录
+    SeqScanExecutor empty(sm_.get(), TEST_TAB1, {make_cond(TEST_TAB1, "a", OP_GT, 1000)}, nullptr);
+    EXPECT_TRUE(collect_batches(empty).empty());
+    empty.beginTuple();
+    EXPECT_TRUE(empty.is_end());
+}
+
+/**
+ * @brief 投影只保留所选的列，列的顺序可以与表中不同
+ */
+TEST_F(BatchExecutionTests, Projection) {
+    auto scan = std::make_unique<SeqScanExecutor>(sm_.get(), TEST_TAB1,
+                                                  std::vector<Condition>{make_cond(TEST_TAB1, "a", OP_EQ, 7)}, nullptr);
+    ProjectionExecutor proj(std::move(scan), {{TEST_TAB1, "c"}, {TEST_TAB1, "b"}});
+    ASSERT_EQ(proj.tupleLen(), 12u);
+
+    std::vector<std::string> expected;
+    for (auto &[a, b, c] : rows1_) {
+        if (a == 7) {
+            std::string rec(12, '\0');
+            memcpy(rec.data(), c.data(), c.size());
+            memcpy(rec.data() + 8, &b, 4);
+            expected.push_back(rec);
+        }
+    }
+    EXPECT_EQ(collect_batches(proj), expected);
+    EXPECT_EQ(collect_tuples(proj), expected);
+}
+
+/**
+ * @brief 块嵌套循环连接的结果与逐对求值一致，包括两侧都带扫描条件、连接条件左侧在右表的情况
+ */
+TEST_F(BatchExecutionTests, NestedLoopJoin) {
+    for (bool swap_sides : {false, true}) {
+        auto left = std::make_unique<SeqScanExecutor>(
+            sm_.get(), TEST_TAB1, std::vector<Condition>{make_cond(TEST_TAB1, "b", OP_LT, 0)}, nullptr);
+        auto right = std::make_unique<SeqScanExecutor>(sm_.get(), TEST_TAB2, std::vector<Condition>{}, nullptr);
+        TabCol col1 = {TEST_TAB1, "a"};
+        TabCol col2 = {TEST_TAB2, "a"};
+        std::vector<Condition> conds = {swap_sides ? make_join_cond(col2, OP_EQ, col1) : make_join_cond(col1, OP_EQ, col2)};
+        NestedLoopJoinExecutor join(std::move(left), std::move(right), conds);
+        ASSERT_EQ(join.tupleLen(), 24u);
+
+        std::vector<std::tuple<int, int, int>> expected;
+        for (auto &[a, b, c] : rows1_) {
+            if (b >= 0) {
+                continue;
+            }
+            for (auto &[a2, d] : rows2_) {
+                if (a == a2) {
+                    expected.emplace_back(a, b, a2);
+                }
+            }
+        }
+        auto recs = collect_batches(join);
+        std::vector<std::tuple<int, int, int>> actual;
+        for (auto &rec : recs) {
+            actual.emplace_back(int_at(rec, 0), int_at(rec, 4), int_at(rec, 16));
+        }
+        EXPECT_EQ(actual, expected);
+        EXPECT_EQ(collect_tuples(join), recs);
+    }
+
+    // 无连接条件时为笛卡尔积，输出超过一批
+    auto left = std::make_unique<SeqScanExecutor>(sm_.get(), TEST_TAB1,
+                                                  std::vector<Condition>{make_cond(TEST_TAB1, "a", OP_LT, 20)}, nullptr);
+    auto right = std::make_unique<SeqScanExecutor>(sm_.get(), TEST_TAB2, std::vector<Condition>{}, nullptr);
+    NestedLoopJoinExecutor join(std::move(left), std::move(right), {});
+    size_t num_left = std::count_if(rows1_.begin(), rows1_.end(), [](auto &row) { return std::get<0>(row) < 20; });
+    EXPECT_EQ(collect_batches(join).size(), num_left * rows2_.size());
+}
+
+/**
+ * @brief 排序按键稳定排序，升序和降序都正确；排序的输入可以来自索引扫描
+ */
+TEST_F(BatchExecutionTests, Sort) {
+    for (bool is_desc : {false, true}) {
+        auto scan = std::make_unique<SeqScanExecutor>(
+            sm_.get(), TEST_TAB1, std::vector<Condition>{make_cond(TEST_TAB1, "a", OP_GE, 100)}, nullptr);
+        SortExecutor sort(std::move(scan), {TEST_TAB1, "a"}, is_desc);
+
+        std::vector<std::pair<int, int>> expected;
+        for (auto &[a, b, c] : rows1_) {
+            if (a >= 100) {
+                expected.emplace_back(a, b);
+            }
+        }
+        std::stable_sort(expected.begin(), expected.end(), [is_desc](auto &x, auto &y) {
+            return is_desc ? x.first > y.first : x.first < y.first;
+        });
+        auto recs = collect_batches(sort);
+        std::vector<std::pair<int, int>> actual;
+        for (auto &rec : recs) {
+            actual.emplace_back(int_at(rec, 0), int_at(rec, 4));
+        }
+        EXPECT_EQ(actual, expected);
+        EXPECT_EQ(collect_tuples(sort), recs);
+    }
+
+    sm_->create_index(TEST_TAB1, {"b"}, nullptr);
+    std::vector<Condition> conds = {make_cond(TEST_TAB1, "b", OP_GT, -20000), make_cond(TEST_TAB1, "a", OP_NE, 3)};
+    auto index_scan = std::make_unique<IndexScanExecutor>(sm_.get(), TEST_TAB1, conds, std::vector<std::string>{"b"}, nullptr);
+    SeqScanExecutor seq_scan(sm_.get(), TEST_TAB1, conds, nullptr);
+    auto seq_recs = collect_batches(seq_scan);
+    EXPECT_EQ(collect_tuples(*index_scan), collect_batches(*index_scan));
+    SortExecutor sort(std::move(index_scan), {TEST_TAB1, "c"}, false);
+    auto recs = collect_batches(sort);
+    ASSERT_EQ(recs.size(), seq_recs.size());
+    for (size_t i = 1; i < recs.size(); i++) {
+        EXPECT_LE(memcmp(recs[i - 1].data() + 8, recs[i].data() + 8, 8), 0);
+    }
+    std::sort(recs.begin(), recs.end());
+    std::sort(seq_recs.begin(), seq_recs.end());
+    EXPECT_EQ(recs, seq_recs);
+}
+
+/**
+ * @brief 哈希连接与嵌套循环连接的结果相同（不计顺序）：build侧为左边或右边、两边都有重复的key、
+ * 还有不作为key的其余连接条件，以及一侧为空的情况
+ */
+TEST_F(BatchExecutionTests, HashJoin) {
+    auto make_scan = [&](const std::string &tab_name, std::vector<Condition> conds) {
+        return std::make_unique<SeqScanExecutor>(sm_.get(), tab_name, std::move(conds), nullptr);
+    };
+    auto check_join = [&](const std::string &left_tab, std::vector<Condition> left_conds, const std::string &right_tab,
+                          std::vector<Condition> right_conds, const std::vector<Condition> &join_conds) {
+        HashJoinExecutor hash_join(sm_.get(), make_scan(left_tab, left_conds), make_scan(right_tab, right_conds), join_conds);
+        NestedLoopJoinExecutor nested_loop(make_scan(left_tab, left_conds), make_scan(right_tab, right_conds), join_conds);
+        EXPECT_EQ(hash_join.tupleLen(), nested_loop.tupleLen());
+        auto actual = collect_batches(hash_join);
+        auto expected = collect_batches(nested_loop);
+        std::sort(actual.begin(), actual.end());
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(actual, expected);
+        auto tuples = collect_tuples(hash_join);
+        std::sort(tuples.begin(), tuples.end());
+        EXPECT_EQ(tuples, expected);
+        return expected.size();
+    };
+
+    TabCol t1_a = {TEST_TAB1, "a"};
+    TabCol t2_a = {TEST_TAB2, "a"};
+    // t2较小，build侧为右边或左边；条件的左侧可以是任一个表
+    EXPECT_GT(check_join(TEST_TAB1, {}, TEST_TAB2, {}, {make_join_cond(t1_a, OP_EQ, t2_a)}), 0u);
+    EXPECT_GT(check_join(TEST_TAB2, {}, TEST_TAB1, {}, {make_join_cond(t1_a, OP_EQ, t2_a)}), 0u);
+    // 两边的key都有大量重复，输出跨越多批
+    const std::string alias_tab = "t3";
+    sm_->create_table(alias_tab, {{"a", TYPE_INT, 4}, {"b", TYPE_INT, 4}, {"c", TYPE_STRING, 8}}, nullptr);
+    auto fh3 = sm_->fhs_.at(alias_tab).get();
+    char buf[16];
+    for (auto &[a, b, c] : rows1_) {
+        if (a % 4 == 0) {
+            memcpy(buf, &a, 4);
+            memcpy(buf + 4, &b, 4);
+            memset(buf + 8, 0, 8);
+            memcpy(buf + 8, c.data(), c.size());
+            fh3->insert_record(buf, nullptr);
+        }
+    }
+    TabCol t3_a = {alias_tab, "a"};
+    EXPECT_GT(check_join(TEST_TAB1, {make_cond(TEST_TAB1, "b", OP_LT, 20000)}, alias_tab, {},
+                         {make_join_cond(t1_a, OP_EQ, t3_a)}),
+              static_cast<size_t>(BATCH_SIZE));
+    // 多个key，以及不作为key的条件
+    EXPECT_GT(check_join(TEST_TAB1, {}, alias_tab, {},
+                         {make_join_cond(t3_a, OP_EQ, t1_a), make_join_cond({TEST_TAB1, "c"}, OP_EQ, {alias_tab, "c"}),
+                          make_join_cond({TEST_TAB1, "b"}, OP_LT, {alias_tab, "b"})}),
+              0u);
+    // 一侧为空
+    EXPECT_EQ(check_join(TEST_TAB1, {make_cond(TEST_TAB1, "a", OP_GT, 1000)}, TEST_TAB2, {},
+                         {make_join_cond(t1_a, OP_EQ, t2_a)}),
+              0u);
+    EXPECT_EQ(check_join(TEST_TAB1, {}, TEST_TAB2, {make_cond(TEST_TAB2, "a", OP_LT, 0)},
+                         {make_join_cond(t1_a, OP_EQ, t2_a)}),
+              0u);
+
+    // 没有可以作为key的等值条件
+    EXPECT_THROW(HashJoinExecutor(sm_.get(), make_scan(TEST_TAB1, {}), make_scan(TEST_TAB2, {}),
+                                            {make_join_cond(t1_a, OP_LT, t2_a)}),
+                 InternalError);
+}
+
+/**
+ * @brief 内存预算很小时两边都分区写到临时文件，结果与嵌套循环连接相同；
+ * 大量重复的key使分区一直达到最深一层，此时build侧分段连接；结束后临时文件都被删除，遗留的临时文件启动时被清理
+ */
+TEST_F(BatchExecutionTests, HashJoinSpill) {
+    auto make_scan = [&](const std::string &tab_name) {
+        return std::make_unique<SeqScanExecutor>(sm_.get(), tab_name, std::vector<Condition>{}, nullptr);
+    };
+    auto check_join = [&](const std::string &left_tab, const std::string &right_tab, const std::vector<Condition> &conds,
+                          size_t memory_budget) {
+        auto hash_join = std::make_unique<HashJoinExecutor>(sm_.get(), make_scan(left_tab), make_scan(right_tab), conds,
+                                                            memory_budget);
+        NestedLoopJoinExecutor nested_loop(make_scan(left_tab), make_scan(right_tab), conds);
+        auto actual = collect_batches(*hash_join);
+        auto expected = collect_batches(nested_loop);
+        std::sort(actual.begin(), actual.end());
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(actual, expected);
+        int spill_level = hash_join->spill_level();
+        hash_join.reset();
+        EXPECT_NE(system("ls spill_*.tmp > /dev/null 2>&1"), 0);
+        return spill_level;
+    };
+
+    // t3为t1的一份拷贝，t4和t5中的a都相同
+    sm_->create_table("t3", {{"a", TYPE_INT, 4}, {"b", TYPE_INT, 4}, {"c", TYPE_STRING, 8}}, nullptr);
+    sm_->create_table("t4", {{"a", TYPE_INT, 4}, {"e", TYPE_INT, 4}}, nullptr);
+    sm_->create_table("t5", {{"a", TYPE_INT, 4}, {"f", TYPE_INT, 4}}, nullptr);
+    auto fh3 = sm_->fhs_.at("t3").get();
+    auto fh4 = sm_->fhs_.at("t4").get();
+    auto fh5 = sm_->fhs_.at("t5").get();
+    char buf[16];
+    for (auto &[a, b, c] : rows1_) {
+        memcpy(buf, &a, 4);
+        memcpy(buf + 4, &b, 4);
+        memset(buf + 8, 0, 8);
+        memcpy(buf + 8, c.data(), c.size());
+        fh3->insert_record(buf, nullptr);
+    }
+    for (int i = 0; i < 300; i++) {
+        int a = 1;
+        memcpy(buf, &a, 4);
+        memcpy(buf + 4, &i, 4);
+        fh4->insert_record(buf, nullptr);
+        fh5->insert_record(buf, nullptr);
+    }
+
+    TabCol t1_a = {TEST_TAB1, "a"};
+    TabCol t3_a = {"t3", "a"};
+    std::vector<Condition> conds = {make_join_cond(t1_a, OP_EQ, t3_a)};
+    EXPECT_EQ(check_join(TEST_TAB1, "t3", conds, HASH_JOIN_MEMORY_BUDGET), -1);
+    EXPECT_GE(check_join(TEST_TAB1, "t3", conds, 64 << 10), 0);
+    // 预算小于一个分区时再分区
+    EXPECT_GE(check_join(TEST_TAB1, "t3", {make_join_cond(t1_a, OP_EQ, t3_a), make_join_cond({TEST_TAB1, "b"}, OP_EQ, {"t3", "b"})},
+                         4 << 10),
+              1);
+    // 重复的key无法通过再分区变小
+    EXPECT_EQ(check_join("t4", "t5", {make_join_cond({"t4", "a"}, OP_EQ, {"t5", "a"})}, 2 << 10),
+              HashJoinExecutor::MAX_SPILL_LEVEL);
+
+    // 启动时删除之前的进程遗留的临时文件，其余文件不受影响
+    disk_manager_->create_file("spill_1_0.tmp");
+    disk_manager_->create_file("spill_1_0.tmp" + std::string(DiskManager::PAGE_MAP_SUFFIX));
+    disk_manager_->create_file("spill_note");
+    SpillFile::remove_leftover_files(disk_manager_.get());
+    EXPECT_FALSE(disk_manager_->is_file("spill_1_0.tmp"));
+    EXPECT_FALSE(disk_manager_->is_file("spill_1_0.tmp" + std::string(DiskManager::PAGE_MAP_SUFFIX)));
+    EXPECT_TRUE(disk_manager_->is_file("spill_note"));
+    disk_manager_->destroy_file("spill_note");
+}
+
+/**
+ * @brief 内存预算很小时排序写出多个有序段再归并，结果与只在内存中排序相同，包括相同key的稳定顺序
+ */
+TEST_F(BatchExecutionTests, ExternalSort) {
+    for (bool is_desc : {false, true}) {
+        auto make_sort = [&](SmManager *sm_manager, size_t memory_budget) {
+            auto scan = std::make_unique<SeqScanExecutor>(sm_.get(), TEST_TAB1, std::vector<Condition>{}, nullptr);
+            return std::make_unique<SortExecutor>(std::move(scan), TabCol{TEST_TAB1, "a"}, is_desc, sm_manager,
+                                                  memory_budget);
+        };
+        auto in_memory = make_sort(nullptr, 1 << 10);
+        auto external = make_sort(sm_.get(), 16 << 10);
+        auto expected = collect_batches(*in_memory);
+        EXPECT_EQ(in_memory->num_runs(), 0u);
+        EXPECT_EQ(collect_batches(*external), expected);
+        EXPECT_GT(external->num_runs(), 1u);
+        EXPECT_EQ(collect_tuples(*external), expected);
+        external.reset();
+        EXPECT_NE(system("ls spill_*.tmp > /dev/null 2>&1"), 0);
+    }
+}
+
+/**
+ * @brief 归并连接的结果与嵌套循环连接相同，两边都有重复的key；输入无序时先排序，
+ * 两边都是按连接列有序的索引扫描时不需要排序，输出按key有序
+ */
+TEST_F(BatchExecutionTests, MergeJoin) {
+    sm_->create_table("t3", {{"a", TYPE_INT, 4}, {"b", TYPE_INT, 4}, {"c", TYPE_STRING, 8}}, nullptr);
+    auto fh3 = sm_->fhs_.at("t3").get();
+    char buf[16];
+    for (auto &[a, b, c] : rows1_) {
+        if (b % 3 == 0) {
+            int a3 = a + 100;
+            memcpy(buf, &a3, 4);
+            memcpy(buf + 4, &b, 4);
+            memset(buf + 8, 0, 8);
+            memcpy(buf + 8, c.data(), c.size());
+            fh3->insert_record(buf, nullptr);
+        }
+    }
+    auto make_scan = [&](const std::string &tab_name) {
+        return std::make_unique<SeqScanExecutor>(sm_.get(), tab_name, std::vector<Condition>{}, nullptr);
+    };
+    auto check_join = [&](std::unique_ptr<AbstractExecutor> left, std::unique_ptr<AbstractExecutor> right, bool sorted,
+                          const std::vector<Condition> &conds, const std::string &left_tab, const std::string &right_tab) {
+        MergeJoinExecutor merge_join(sm_.get(), std::move(left), std::move(right), conds, sorted, sorted);
+        NestedLoopJoinExecutor nested_loop(make_scan(left_tab), make_scan(right_tab), conds);
+        auto actual = collect_batches(merge_join);
+        for (size_t i = 1; i < actual.size(); i++) {
+            EXPECT_LE(int_at(actual[i - 1], 0), int_at(actual[i], 0));
+        }
+        auto expected = collect_batches(nested_loop);
+        std::sort(actual.begin(), actual.end());
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(actual, expected);
+        return expected.size();
+    };
+
+    // t1.a与t3.a都有大量重复，部分key只在一边出现
+    TabCol t1_a = {TEST_TAB1, "a"};
+    TabCol t3_a = {"t3", "a"};
+    EXPECT_GT(check_join(make_scan(TEST_TAB1), make_scan("t3"), false, {make_join_cond(t3_a, OP_EQ, t1_a)}, TEST_TAB1, "t3"),
+              static_cast<size_t>(BATCH_SIZE));
+    EXPECT_GT(check_join(make_scan("t3"), make_scan(TEST_TAB1), false,
+                         {make_join_cond(t3_a, OP_EQ, t1_a), make_join_cond({"t3", "b"}, OP_GT, {TEST_TAB1, "b"})}, "t3",
+                         TEST_TAB1),
+              0u);
+    EXPECT_EQ(check_join(make_scan(TEST_TAB1), make_scan(TEST_TAB2), false,
+                         {make_join_cond(t1_a, OP_EQ, {TEST_TAB2, "a"}), make_join_cond(t1_a, OP_LT, {TEST_TAB2, "a"})},
+                         TEST_TAB1, TEST_TAB2),
+              0u);
+
+    // 两边都按b有序的索引扫描
+    sm_->create_index(TEST_TAB1, {"b"}, nullptr);
+    sm_->create_index("t3", {"b"}, nullptr);
+    auto make_index_scan = [&](const std::string &tab_name) {
+        return std::make_unique<IndexScanExecutor>(sm_.get(), tab_name, std::vector<Condition>{}, std::vector<std::string>{"b"},
+                                                   nullptr, true);
+    };
+    MergeJoinExecutor merge_join(sm_.get(), make_index_scan(TEST_TAB1), make_index_scan("t3"),
+                                 {make_join_cond({TEST_TAB1, "b"}, OP_EQ, {"t3", "b"})});
+    auto recs = collect_batches(merge_join);
+    EXPECT_EQ(recs.size(), std::count_if(rows1_.begin(), rows1_.end(), [](auto &row) { return std::get<1>(row) % 3 == 0; }));
+    for (size_t i = 0; i < recs.size(); i++) {
+        EXPECT_EQ(int_at(recs[i], 0), int_at(recs[i], 4));
+        EXPECT_EQ(int_at(recs[i], 0) % 3, 0);
+        if (i > 0) {
+            EXPECT_LT(int_at(recs[i - 1], 0), int_at(recs[i], 0));
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#include "storage/page_compression.h"
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk_manager.h"
+
+const std::string TEST_DB_NAME = "PageCompressionTest_db";  // 以TEST_DB_NAME作为存放测试文件的根目录名
+
+class PageCompressionTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        if (!disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->create_dir(TEST_DB_NAME);
+        }
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        assert(disk_manager_->is_dir(TEST_DB_NAME));
+    };
+
+    /**
+     * @brief 生成一个类似定长记录页面的数据：若干条记录后面跟着大量未使用的0字节
+     */
+    void record_page(char *buf, int seed) {
+        memset(buf, 0, PAGE_SIZE);
+        int num_records = seed % 40;
+        for (int i = 0; i < num_records; i++) {
+            char *record = buf + 64 + i * 64;
+            int key = seed * 100 + i;
+            memcpy(record, &key, sizeof(int));
+            snprintf(record + 4, 20, "name_%d", key);
+        }
+    }
+
+    void rand_buf(char *buf, int size) {
+        for (int i = 0; i < size; i++) {
+            buf[i] = rand() & 0xff;
+        }
+    }
+};
+
+/**
+ * @brief 测试编解码器：压缩后能还原，且可压缩的页面确实变小
+ */
+TEST_F(PageCompressionTest, CodecRoundTrip) {
+    std::vector<char> page(PAGE_SIZE);
+    std::vector<char> comp(PAGE_SIZE * 2);
+    std::vector<char> out(PAGE_SIZE);
+    for (int seed = 0; seed < 200; seed++) {
+        if (seed % 10 == 9) {
+            rand_buf(page.data(), PAGE_SIZE);
+        } else {
+            record_page(page.data(), seed);
+        }
+        int comp_len = PageCompressor::compress(page.data(), PAGE_SIZE, comp.data(), comp.size());
+        ASSERT_GT(comp_len, 0);
+        if (seed % 10 != 9) {
+            EXPECT_LT(comp_len, PAGE_SIZE / 2);
+        }
+        int out_len = PageCompressor::decompress(comp.data(), comp_len, out.data(), PAGE_SIZE);
+        ASSERT_EQ(out_len, PAGE_SIZE);
+        EXPECT_EQ(memcmp(page.data(), out.data(), PAGE_SIZE), 0);
+    }
+    // 输出空间不足时压缩失败
+    rand_buf(page.data(), PAGE_SIZE);
+    EXPECT_EQ(PageCompressor::compress(page.data(), PAGE_SIZE, comp.data(), PAGE_SIZE - 1), -1);
+}
+
+/**
+ * @brief 测试压缩文件的页面读写：覆盖写、部分写、未写页面、重新打开以及映射文件不完整时的重建
+ */
+TEST_F(PageCompressionTest, CompressedFileOperation) {
+    const std::string filename = "CompressedPageTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->set_page_compression(true);
+    disk_manager_->create_file(filename);
+    disk_manager_->set_page_compression(false);
+    int fd = disk_manager_->open_file(filename);
+    EXPECT_TRUE(disk_manager_->is_compressed_file(fd));
+
+    const int num_pages = 256;
+    std::vector<std::vector<char>> mock(num_pages, std::vector<char>(PAGE_SIZE));
+    char buf[PAGE_SIZE];
+    for (int round = 0; round < 4; round++) {
+        for (int page_no = 0; page_no < num_pages; page_no++) {
+            auto &data = mock[page_no];
+            if ((page_no + round) % 7 == 0) {
+                rand_buf(data.data(), PAGE_SIZE);
+            } else {
+                record_page(data.data(), page_no * 3 + round);
+            }
+            disk_manager_->write_page(fd, page_no, data.data(), PAGE_SIZE);
+        }
+        // 只写页面头部
+        int partial = round * 10 + 3;
+        memset(mock[partial].data(), 'x', 100);
+        disk_manager_->write_page(fd, partial, mock[partial].data(), 100);
+        for (int page_no = 0; page_no < num_pages; page_no++) {
+            disk_manager_->read_page(fd, page_no, buf, PAGE_SIZE);
+            ASSERT_EQ(memcmp(buf, mock[page_no].data(), PAGE_SIZE), 0);
+        }
+    }
+    // 从未写入的页面读出全0
+    memset(buf, 1, PAGE_SIZE);
+    disk_manager_->read_page(fd, num_pages + 10, buf, PAGE_SIZE);
+    for (int i = 0; i < PAGE_SIZE; i++) {
+        ASSERT_EQ(buf[i], 0);
+    }
+    disk_manager_->close_file(fd);
+    // 大部分页面是可压缩的，文件应明显小于未压缩时的大小
+    EXPECT_LT(disk_manager_->get_file_size(filename), num_pages * PAGE_SIZE / 2);
+
+    // 重新打开后数据不变
+    fd = disk_manager_->open_file(filename);
+    for (int page_no = 0; page_no < num_pages; page_no++) {
+        disk_manager_->read_page(fd, page_no, buf, 64);
+        ASSERT_EQ(memcmp(buf, mock[page_no].data(), 64), 0);
+    }
+    disk_manager_->close_file(fd);
+
+    // 模拟未正常关闭：映射文件被标记为不完整，打开时扫描数据文件重建映射
+    int map_fd = open((filename + DiskManager::PAGE_MAP_SUFFIX).c_str(), O_RDWR);
+    ASSERT_GE(map_fd, 0);
+    ASSERT_EQ(ftruncate(map_fd, 0), 0);
+    close(map_fd);
+    fd = disk_manager_->open_file(filename);
+    for (int page_no = 0; page_no < num_pages; page_no++) {
+        disk_manager_->read_page(fd, page_no, buf, PAGE_SIZE);
+        ASSERT_EQ(memcmp(buf, mock[page_no].data(), PAGE_SIZE), 0);
+    }
+    disk_manager_->close_file(fd);
+
+    disk_manager_->destroy_file(filename);
+    EXPECT_FALSE(disk_manager_->is_file(filename));
+    EXPECT_FALSE(disk_manager_->is_file(filename + DiskManager::PAGE_MAP_SUFFIX));
+}